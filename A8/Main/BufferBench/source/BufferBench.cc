@@ -0,0 +1,284 @@
+
+#ifndef BUFFER_BENCH_C
+#define BUFFER_BENCH_C
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include "MyDB_BufferManager.h"
+#include "MyDB_PageHandle.h"
+#include "MyDB_Table.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+// the parameters for the contention benchmark
+#define BENCH_PAGE_SIZE 4096
+#define BENCH_BUFFER_PAGES 1024
+#define BENCH_TABLE_PAGES 2048
+#define BENCH_OPS_PER_THREAD 100000
+
+// the parameters for the replacement policy benchmark
+#define BENCH_HOT_PAGES 600
+#define BENCH_SCANS 10
+
+// the parameters for the page handle benchmark
+#define BENCH_HANDLE_OPS 1000000
+
+// the parameters for the write-back benchmark
+#define BENCH_UPDATES 200000
+
+// the parameters for the direct I/O benchmark; the scan table and the spill are both
+// bigger than the buffer, and the pages are big enough for O_DIRECT to pay off
+#define BENCH_DIRECT_PAGE_SIZE 65536
+#define BENCH_DIRECT_BUFFER_PAGES 256
+#define BENCH_DIRECT_TABLE_PAGES 1024
+#define BENCH_DIRECT_SCANS 4
+#define BENCH_SPILL_PAGES 1024
+
+// this is what each of the worker threads gets
+struct BenchArg {
+	MyDB_BufferManager *myMgr;
+	MyDB_TablePtr myTable;
+	unsigned int seed;
+	long checksum;
+
+	// for the page handle benchmark, true if the worker gets handles rather than copying one
+	bool getting;
+};
+
+// each worker repeatedly grabs a random page from the table and reads a byte; the
+// access pattern is skewed so that roughly half of the accesses hit the buffer
+void benchWorker (void *arg) {
+
+	BenchArg *myArg = (BenchArg *) arg;
+	unsigned int seed = myArg->seed;
+	long checksum = 0;
+
+	for (int i = 0; i < BENCH_OPS_PER_THREAD; i++) {
+
+		// half of the time go to a hot set of pages, half of the time go anywhere
+		long whichPage = rand_r (&seed) % BENCH_TABLE_PAGES;
+		if (rand_r (&seed) % 2 == 0)
+			whichPage = whichPage % (BENCH_BUFFER_PAGES / 2);
+
+		MyDB_PageHandle myPage = myArg->myMgr->getPage (myArg->myTable, whichPage);
+		checksum += ((char *) myPage->getBytes ())[whichPage % BENCH_PAGE_SIZE];
+	}
+
+	myArg->checksum = checksum;
+}
+
+// each worker either copies and destroys a handle over and over, or gets and destroys
+// a handle over and over; the page used is given by seed
+void handleWorker (void *arg) {
+
+	BenchArg *myArg = (BenchArg *) arg;
+	long whichPage = myArg->seed;
+	MyDB_PageHandle myPage = myArg->myMgr->getPage (myArg->myTable, whichPage);
+	myPage->getBytes ();
+	long checksum = 0;
+
+	if (!myArg->getting) {
+		for (int i = 0; i < BENCH_HANDLE_OPS; i++) {
+			MyDB_PageHandle copy = myPage;
+			checksum += (copy == nullptr);
+		}
+	} else {
+		for (int i = 0; i < BENCH_HANDLE_OPS; i++) {
+			MyDB_PageHandle another = myArg->myMgr->getPage (myArg->myTable, whichPage);
+			checksum += (another == nullptr);
+		}
+	}
+
+	myArg->checksum = checksum;
+}
+
+// writes out a table with the given number of pages
+void writeTable (MyDB_TablePtr myTable, int numPages, size_t pageSize = BENCH_PAGE_SIZE) {
+	MyDB_BufferManager myMgr (pageSize, BENCH_BUFFER_PAGES, "tempFile");
+	for (int i = 0; i < numPages; i++) {
+		MyDB_PageHandle myPage = myMgr.getPage (myTable, i);
+		char *bytes = (char *) myPage->getBytes ();
+		for (size_t j = 0; j < pageSize; j++) {
+			bytes[j] = (char) (i + j);
+		}
+		myPage->wroteBytes ();
+	}
+}
+
+// scans a table over and over with a buffer that is too small to hold it, and then
+// writes out a sorted run's worth of anonymous pages and reads them back in, the way
+// that an external sort spills; returns the MB/sec for the scans and for the spill
+pair <double, double> directWorkload (MyDB_TablePtr scanMe, bool directIO, long &checksum) {
+
+	MyDB_BufferManager myMgr (BENCH_DIRECT_PAGE_SIZE, BENCH_DIRECT_BUFFER_PAGES, "tempFile", 0,
+		ClockReplacement, PositionalIO, directIO);
+	double mb = BENCH_DIRECT_PAGE_SIZE / (1024.0 * 1024.0);
+
+	auto begin = chrono::high_resolution_clock::now ();
+	MyDB_ScanRingPtr ring = myMgr.getScanRing (BENCH_DIRECT_TABLE_PAGES);
+	for (int scan = 0; scan < BENCH_DIRECT_SCANS; scan++) {
+		for (int i = 0; i < BENCH_DIRECT_TABLE_PAGES; i++) {
+			MyDB_PageHandle myPage = myMgr.getPage (scanMe, i, ring);
+			checksum += ((char *) myPage->getBytes ())[i];
+		}
+	}
+	auto middle = chrono::high_resolution_clock::now ();
+
+	vector <MyDB_PageHandle> spilled;
+	for (int i = 0; i < BENCH_SPILL_PAGES; i++) {
+		spilled.push_back (myMgr.getPage ());
+		char *bytes = (char *) spilled.back ()->getBytes ();
+		memset (bytes, i, BENCH_DIRECT_PAGE_SIZE);
+		spilled.back ()->wroteBytes ();
+	}
+	for (int i = 0; i < BENCH_SPILL_PAGES; i++)
+		checksum += ((char *) spilled[i]->getBytes ())[i];
+	auto end = chrono::high_resolution_clock::now ();
+
+	double scanSecs = chrono::duration_cast <chrono::microseconds> (middle - begin).count () / 1000000.0;
+	double spillSecs = chrono::duration_cast <chrono::microseconds> (end - middle).count () / 1000000.0;
+	return make_pair (BENCH_DIRECT_SCANS * BENCH_DIRECT_TABLE_PAGES * mb / scanSecs, 2 * BENCH_SPILL_PAGES * mb / spillSecs);
+}
+
+int main () {
+
+	// write out the tables that we are going to read
+	MyDB_TablePtr myTable = make_shared <MyDB_Table> ("benchTable", "benchTable.bin");
+	MyDB_TablePtr hotTable = make_shared <MyDB_Table> ("hotTable", "hotTable.bin");
+	writeTable (myTable, BENCH_TABLE_PAGES);
+	writeTable (hotTable, BENCH_HOT_PAGES);
+
+	cout << "threads\tshards\tops/sec\n";
+	for (int numThreads = 1; numThreads <= 32; numThreads *= 2) {
+
+		// compare a single latch with a sharded page table
+		for (size_t numShards : {(size_t) 1, (size_t) 0}) {
+
+			MyDB_BufferManager myMgr (BENCH_PAGE_SIZE, BENCH_BUFFER_PAGES, "tempFile", numShards);
+
+			vector <BenchArg> args (numThreads);
+			vector <void *> argPtrs;
+			for (int i = 0; i < numThreads; i++) {
+				args[i].myMgr = &myMgr;
+				args[i].myTable = myTable;
+				args[i].seed = i + 1;
+				argPtrs.push_back (&args[i]);
+			}
+
+			auto begin = chrono::high_resolution_clock::now ();
+			myMgr.executeThreads (benchWorker, argPtrs);
+			auto end = chrono::high_resolution_clock::now ();
+
+			double secs = chrono::duration_cast <chrono::microseconds> (end - begin).count () / 1000000.0;
+			cout << numThreads << "\t" << myMgr.getNumShards () << "\t"
+				<< (long) (numThreads * (double) BENCH_OPS_PER_THREAD / secs) << "\n";
+		}
+	}
+
+	// now see how well each replacement policy protects a hot table from a big scan;
+	// one random hot page is accessed for every two pages scanned
+	cout << "\npolicy\thits\tmisses\thit rate\n";
+	vector <pair <string, MyDB_ReplacementType>> policies = {make_pair ("CLOCK", ClockReplacement),
+		make_pair ("LRU", LRUReplacement), make_pair ("LRU-2", LRUKReplacement),
+		make_pair ("2Q", TwoQReplacement), make_pair ("ARC", ARCReplacement)};
+	for (auto &policy : policies) {
+
+		MyDB_BufferManager myMgr (BENCH_PAGE_SIZE, BENCH_BUFFER_PAGES, "tempFile", 0, policy.second);
+		unsigned int seed = 1;
+		long checksum = 0;
+		for (int scan = 0; scan < BENCH_SCANS; scan++) {
+			for (int i = 0; i < BENCH_TABLE_PAGES; i++) {
+				MyDB_PageHandle myPage = myMgr.getPage (myTable, i);
+				checksum += ((char *) myPage->getBytes ())[0];
+				if (i % 2 == 0) {
+					myPage = myMgr.getPage (hotTable, rand_r (&seed) % BENCH_HOT_PAGES);
+					checksum += ((char *) myPage->getBytes ())[0];
+				}
+			}
+		}
+
+		long hits = myMgr.getHits ();
+		long misses = myMgr.getMisses ();
+		cout << policy.first << "\t" << hits << "\t" << misses << "\t" << hits / (double) (hits + misses) << "\n";
+	}
+
+	// see how fast page handles can be copied and destroyed, and gotten and destroyed, when
+	// all of the threads are using the same page and when each has its own page
+	cout << "\nthreads\tcopy shared\tcopy private\tget shared\tget private (ops/sec)\n";
+	for (int numThreads = 1; numThreads <= 8; numThreads *= 2) {
+
+		cout << numThreads;
+		for (bool getting : {false, true}) {
+			for (bool shared : {true, false}) {
+
+				MyDB_BufferManager myMgr (BENCH_PAGE_SIZE, BENCH_BUFFER_PAGES, "tempFile");
+				vector <BenchArg> args (numThreads);
+				vector <void *> argPtrs;
+				for (int i = 0; i < numThreads; i++) {
+					args[i].myMgr = &myMgr;
+					args[i].myTable = myTable;
+					args[i].seed = shared ? 0 : i;
+					args[i].getting = getting;
+					argPtrs.push_back (&args[i]);
+				}
+
+				auto begin = chrono::high_resolution_clock::now ();
+				myMgr.executeThreads (handleWorker, argPtrs);
+				auto end = chrono::high_resolution_clock::now ();
+
+				double secs = chrono::duration_cast <chrono::microseconds> (end - begin).count () / 1000000.0;
+				cout << "\t" << (long) (numThreads * (double) BENCH_HANDLE_OPS / secs);
+			}
+		}
+		cout << "\n";
+	}
+
+	// compare buffered and direct I/O for big scans and for sort spills; the direct
+	// I/O numbers do not depend on what is in the kernel's page cache, while the
+	// buffered ones can be served out of it
+	MyDB_TablePtr directTable = make_shared <MyDB_Table> ("directTable", "directTable.bin");
+	writeTable (directTable, BENCH_DIRECT_TABLE_PAGES, BENCH_DIRECT_PAGE_SIZE);
+	cout << "\nI/O\tscan MB/sec\tspill MB/sec\n";
+	for (bool directIO : {false, true}) {
+		long checksum = 0;
+		pair <double, double> res = directWorkload (directTable, directIO, checksum);
+		cout << (directIO ? "direct" : "buffered") << "\t" << res.first << "\t" << res.second << "\n";
+	}
+
+	// last, see how long it takes to do a bunch of random page updates with and without
+	// the background writer (this is last because once the writer thread has been
+	// started, the process is multi-threaded from then on)
+	cout << "\nwriter\tupdate secs\tflush secs\n";
+	for (bool useWriter : {false, true}) {
+
+		MyDB_BufferManager myMgr (BENCH_PAGE_SIZE, BENCH_BUFFER_PAGES, "tempFile");
+		if (useWriter)
+			myMgr.startWriter ();
+
+		unsigned int seed = 1;
+		auto begin = chrono::high_resolution_clock::now ();
+		for (int i = 0; i < BENCH_UPDATES; i++) {
+			MyDB_PageHandle myPage = myMgr.getPage (myTable, rand_r (&seed) % BENCH_TABLE_PAGES);
+			((char *) myPage->getBytes ())[i % BENCH_PAGE_SIZE]++;
+			myPage->wroteBytes ();
+		}
+		auto middle = chrono::high_resolution_clock::now ();
+		myMgr.flushAll ();
+		auto end = chrono::high_resolution_clock::now ();
+
+		cout << (useWriter ? "on" : "off") << "\t"
+			<< chrono::duration_cast <chrono::microseconds> (middle - begin).count () / 1000000.0 << "\t"
+			<< chrono::duration_cast <chrono::microseconds> (end - middle).count () / 1000000.0 << "\n";
+	}
+
+	unlink ("benchTable.bin");
+	unlink ("hotTable.bin");
+	unlink ("directTable.bin");
+}
+
+#endif
+
@@ -0,0 +1,73 @@
+
+#ifndef ARC_POLICY_H
+#define ARC_POLICY_H
+
+#include <list>
+#include "MyDB_ReplacementPolicy.h"
+#include <unordered_map>
+
+using namespace std;
+
+// this is ARC (adaptive replacement cache).  The buffered pages are split into T1
+// (pages referenced once since they were read in) and T2 (pages referenced more than
+// once), each managed as LRU.  Keys of pages evicted from T1 and T2 are kept in the
+// ghost lists B1 and B2.  A miss that hits in B1 means T1 was too small, and a miss
+// that hits in B2 means T2 was too small, so the target size of T1 is adjusted; the
+// victim comes from T1 when it is over its target, and from T2 otherwise
+class MyDB_ARCPolicy : public MyDB_ReplacementPolicy {
+
+public:
+
+	// capacity is the (approximate) number of pages held by the shard
+	MyDB_ARCPolicy (size_t capacity);
+
+	void admit (MyDB_PagePtr admitMe);
+	void reference (MyDB_PagePtr referenceMe);
+	void pin (MyDB_PagePtr pinMe);
+	void unpin (MyDB_PagePtr unpinMe);
+	MyDB_PagePtr victim (function <bool (MyDB_PagePtr &)> canEvict);
+	void evict (MyDB_PagePtr evictMe);
+	void forget (MyDB_PagePtr forgetMe);
+
+private:
+
+	// what we know about each buffered page
+	struct Entry {
+		bool inT2;
+		bool pinned;
+		list <MyDB_PagePtr> :: iterator pos;
+	};
+
+	// a ghost list, along with an index into it
+	struct GhostList {
+		list <MyDB_PageKey> keys;
+		unordered_map <MyDB_PageKey, list <MyDB_PageKey> :: iterator, MyDB_PageKeyHash> where;
+	};
+
+	// the buffered pages; the LRU page is at the front of each list
+	list <MyDB_PagePtr> t1;
+	list <MyDB_PagePtr> t2;
+	unordered_map <MyDB_Page *, Entry> buffered;
+
+	// the ghost lists
+	GhostList b1;
+	GhostList b2;
+
+	// the number of pages in the shard, and the target size of T1
+	size_t capacity;
+	double target;
+
+	// finds the first unpinned, evictable page in the list
+	MyDB_PagePtr scan (list <MyDB_PagePtr> &scanMe, function <bool (MyDB_PagePtr &)> &canEvict);
+
+	// adds a key to the MRU end of a ghost list, and removes a key from a ghost list
+	void addGhost (GhostList &toMe, MyDB_PageKey addMe);
+	bool removeGhost (GhostList &fromMe, MyDB_PageKey removeMe);
+
+	// trims the ghost lists so that T1 + B1 holds at most capacity pages, and all
+	// four lists together hold at most twice the capacity
+	void trimGhosts ();
+};
+
+#endif
+
@@ -13,20 +13,46 @@
 #ifndef BUFFER_MGR_H
 #define BUFFER_MGR_H
 
-#include "CheckLRU.h"
 #include "Lock.h"
 #include <map>
 #include <memory>
+#include "MyDB_BufferShard.h"
+#include "MyDB_BufferStats.h"
+#include "MyDB_FrameTable.h"
+#include "MyDB_IOBackend.h"
+#include "MyDB_MappedTable.h"
 #include "MyDB_Page.h"
 #include "MyDB_PageHandle.h"
+#include "MyDB_PinSlot.h"
+#include "MyDB_ReplacementPolicy.h"
+#include "MyDB_ScanRing.h"
+#include "MyDB_TempSpace.h"
 #include "MyDB_Table.h"
-#include "PageCompare.h"
 #include <queue>
 #include "TableCompare.h"
 #include <set>
 
 using namespace std;
 
+// the largest number of threads that can be using a buffer manager at once
+#define MAX_PIN_SLOTS 1024
+
+// the largest number of different tables that a buffer manager can have pages of
+#define MAX_TABLES 4096
+
+// what the buffer manager keeps for each table that it has had pages of
+struct MyDB_TableInfo {
+
+	// the table (the first table object with the name that the buffer manager saw)
+	MyDB_TablePtr table;
+
+	// the file descriptor for the table's file
+	int fd;
+
+	// the statistics for the table; each of the table's pages points at them
+	MyDB_StatCounters stats;
+};
+
 class MyDB_BufferManager;
 typedef shared_ptr <MyDB_BufferManager> MyDB_BufferManagerPtr;
 
@@ -41,10 +67,10 @@ public:
 	// is invoked with args[0], the second with args[1], and so on.  Note that the
 	// threads created are pthreads, so any synchronization should be implemented
 	// using pthreads synchroniztion primitives.  Also note that the buffer manager
-	// is thread safe with respect to these threads.  That is, the various threads
-	// created can all access pages from the buffer manager simultaneously without
-	// worry.  When all of the threads have exited from start_routine, then the
-	// call to executeThreads returns.
+	// is thread safe with respect to these threads (or any other threads, however they
+	// are created).  That is, the various threads created can all access pages from
+	// the buffer manager simultaneously without worry.  When all of the threads have
+	// exited from start_routine, then the call to executeThreads returns.
 	void executeThreads (void (*start_routine) (void *), vector <void *> args);
 
 	// returns an object that locks the buffer manager... the buffer manager stays
@@ -58,6 +84,25 @@ public:
 	// to that already-buffered page should be returned
 	MyDB_PageHandle getPage (MyDB_TablePtr whichTable, long i);
 
+	// like getPage (whichTable, i), except that the page is being read as part of a
+	// sequential scan that uses the given ring (which may be a nullptr, in which case
+	// this is the same as the regular getPage)
+	MyDB_PageHandle getPage (MyDB_TablePtr whichTable, long i, MyDB_ScanRingPtr ring);
+
+	// gets a ring for a sequential scan over the given number of pages... if the scan
+	// is big enough that it would push a lot of other pages out of the buffer, then
+	// the scan is given a small ring of pages to recycle; otherwise a nullptr is returned
+	MyDB_ScanRingPtr getScanRing (size_t numPagesToScan);
+
+	// tells the buffer manager that the page is going to be accessed soon, so that the
+	// read of the page can be started in the background; this is just a hint, and it
+	// does nothing if the page is already buffered
+	void prefetch (MyDB_PageHandle prefetchMe);
+
+	// like prefetch (prefetchMe), but for a whole batch of pages, which are handed to
+	// the I/O backend together
+	void prefetch (vector <MyDB_PageHandle> &prefetchUs);
+
 	// gets a temporary page that will no longer exist (1) after the buffer manager
 	// has been destroyed, or (2) there are no more references to it anywhere in the
 	// program.  Typically such a temporary page will be used as buffer memory.
@@ -69,72 +114,305 @@ public:
 	// between this method and getPage (whicTable, i) is that the page will be 
 	// pinned in RAM; it cannot be written out to the file... note that in Chris'
 	// implementation, a request for a pinned page that is made when the buffer
-	// is ENTIRELY full of pinned pages will return a nullptr
+	// is ENTIRELY full of pinned pages will return a nullptr (after waiting a few seconds
+	// for another thread to unpin something), which is counted as a pin failure
 	MyDB_PageHandle getPinnedPage (MyDB_TablePtr whichTable, long i);
 
+	// maps the given table read-only, so that its pages are served straight out of the
+	// mapping rather than being copied into the buffer (see MyDB_MappedTable); any of
+	// its pages that are dirty in the buffer are written out first.  If the table is
+	// already mapped, the existing mapping is used, with the new access pattern.  The
+	// mapping lasts as long as the buffer manager, and only covers the pages that the
+	// table had when it was first mapped
+	MyDB_MappedTable *mapTable (MyDB_TablePtr whichTable, MyDB_AccessPattern pattern);
+
+	// gets the i^th page of a mapped table; the handle acts just like the handle to a
+	// buffered page, except that the page is always there, and cannot be written
+	MyDB_PageHandle getMappedPage (MyDB_MappedTable *whichTable, long i);
+
 	// gets a temporary page, like getPage (), except that this one is pinned
 	MyDB_PageHandle getPinnedPage ();
 
 	// un-pins the specified page
 	void unpin (MyDB_PagePtr unpinMe);
 
-	// creates an LRU buffer manager... params are as follows:
+	// creates a buffer manager... params are as follows:
 	// 1) the size of each page is pageSize 
 	// 2) the number of pages managed by the buffer manager is numPages;
-	// 3) temporary pages are written to the file tempFile
-	MyDB_BufferManager (size_t pageSize, size_t numPages, string tempFile);
+	// 3) temporary pages are written to files whose names start with tempFile; each
+	//    thread that makes temporary pages gets its own file
+	// 4) the page table is split into numShards independently-latched shards;
+	//    if this is zero, a shard count is picked based upon numPages
+	// 5) pages are evicted using the given replacement policy (CLOCK by default)
+	// 6) page I/O is done using the given backend (pread/pwrite by default)
+	// 7) if directIO is true, the table and temp files are opened with O_DIRECT, so
+	//    that the pages are only cached in the buffer pool and not also in the kernel's
+	//    page cache.  The page size must be a multiple of DIRECT_IO_ALIGNMENT (the frames
+	//    of the pool always are aligned); if it is not, or if the file system does not
+	//    support O_DIRECT, normal I/O is used.  The kernel does no read-ahead in this
+	//    mode, so prefetch () does nothing
+	MyDB_BufferManager (size_t pageSize, size_t numPages, string tempFile, size_t numShards = 0,
+		MyDB_ReplacementType replacement = ClockReplacement, MyDB_IOType ioType = PositionalIO,
+		bool directIO = false);
 	
 	// when the buffer manager is destroyed, all of the dirty pages need to be
 	// written back to disk, and any temporary files need to be deleted
 	~MyDB_BufferManager ();
 
+	// starts up a background thread that writes out dirty pages before they reach the
+	// point where they are evicted, so that a thread that needs RAM for a page can
+	// usually take a clean page rather than having to wait for a write.  The writer
+	// tries to keep the numToKeepClean pages at the cold end of each shard's replacement
+	// order clean; if this is zero, it is a quarter of the pages in a shard.  Should
+	// be called right after the buffer manager is created, and only once
+	void startWriter (size_t numToKeepClean = 0);
+
+	// turns compression of temp pages on or off.  While it is on, each temp page that is
+	// written out is compressed with MyDB_PageCompressor, and only the compressed bytes
+	// (rounded up to DIRECT_IO_ALIGNMENT) are written, and read back in; a page that does
+	// not shrink by at least that much is written out whole.  Each page remembers how
+	// it was written, so this can be changed at any time
+	void setCompressTempPages (bool compress);
+
+	// writes out all of the dirty pages that belong to tables (a checkpoint); the pages
+	// stay buffered.  Returns once all of the writes are done
+	void flushAll ();
+
+	// tells the buffer manager to keep a manifest of its hot pages in the given file.
+	// When the buffer manager is destroyed, the (table, page) pairs of all of the
+	// buffered table pages are written there, the most recently used first, so that
+	// the next buffer manager to use the file can warm itself up with startPreload ()
+	void setManifest (string manifestFile);
+
+	// the preload is optional; nothing is read in unless this is called.  It starts up a
+	// background thread that reads the pages listed in the manifest back in, the hottest
+	// first, in big batches; tables are looked up by name in allTables, and pages of
+	// tables that are not there (or that no longer have the page) are skipped.  The
+	// manifest records the size and the modification time of each table's file, and if
+	// any of those files has changed since the manifest was written, the manifest is
+	// ignored.  The preload only uses RAM that no one is using, so it never pushes out
+	// a page that was read in by someone else, and it stops as soon as the buffer is
+	// full.  Does nothing if there is no manifest.  Should be called after setManifest ()
+	void startPreload (map <string, MyDB_TablePtr> &allTables);
+
+	// waits for the preload (if there is one) to finish
+	void waitForPreload ();
+
+	// reserves frames for an operator (such as a join or an aggregation) that is going
+	// to tie up a number of pages at once, for example by keeping them pinned.  A
+	// reservation does not set any RAM aside; it is a budget, which keeps the operators
+	// that are running at the same time from together pinning more pages than there
+	// are.  At most three quarters of the buffer (less, for a small buffer, and just one
+	// frame for a tiny one) can be reserved at once, since scans and the like need RAM,
+	// too, and the reservations never add up to more than that.  numWanted frames are
+	// granted if they are available, and otherwise whatever is left; if that is fewer
+	// than numNeeded (or than the limit, if numNeeded is bigger), this waits until other
+	// operators give back enough.  So a thread must not ask for a second reservation
+	// while it holds one.  Returns the number of frames granted; the operator should
+	// adapt (by spilling, or using smaller runs) to what it gets, and should not keep
+	// more pages pinned than that
+	size_t reserveFrames (size_t numWanted, size_t numNeeded = 1);
+
+	// gives back frames that were reserved
+	void releaseFrames (size_t numFrames);
+
+	// returns the number of frames that are not reserved
+	size_t getNumUnreserved ();
+
 	// returns the page size
 	size_t getPageSize ();
+
+	// returns the number of pages in the buffer
+	size_t getNumPages ();
 	
+	// returns the number of shards that the page table is split into
+	size_t getNumShards ();
+
+	// returns the number of page accesses that found the page already buffered, and
+	// the number that had to read the page in (summed over the replacement policies
+	// of all of the shards); repeated accesses by a thread to the page it accessed
+	// last are not counted
+	long getHits ();
+	long getMisses ();
+
+	// returns the statistics for the buffer manager as a whole (summed over all of the
+	// tables), and for each table that has had pages in the buffer manager, by name;
+	// the temp file is listed as "(temp)"
+	MyDB_BufferStats getStats ();
+	map <string, MyDB_BufferStats> getTableStats ();
+
+	// returns all of the statistics as a JSON object, with the buffer manager as a whole
+	// under "total" and the tables under "tables"
+	string getStatsJSON ();
+
 private:
 
-	// tells us the LRU number of each of the pages
-	set <MyDB_PagePtr, CheckLRU> lastUsed;
+	// the page table, replacement policies, and free RAM, partitioned into independently-latched
+	// shards; a page lives in the shard given by shardFor ()
+	vector <MyDB_BufferShard *> shards;
 
-	// list of ALL of the page objects that are currently in existence
-	map <pair <MyDB_TablePtr, size_t>, MyDB_PagePtr, PageCompare> allPages;
-	
-	// lists the FDs for all of the files
-	map <MyDB_TablePtr, int, TableCompare> fds;
+	// the buffer pool itself; all of the RAM that the shards hand out comes from here
+	MyDB_FrameTable *frames;
 
-	// all of the chunks of RAM that are currently not allocated
-	vector <void *> availableRam;
+	// the tables that the buffer manager has had pages of, by their dense ids; entries
+	// [0, numTables) are filled in, and entries are only added (while holding myLock)
+	MyDB_TableInfo *tables[MAX_TABLES];
+	atomic <size_t> numTables;
 
-	// all of the positions in the temporary file that are currently not in use
-	priority_queue<size_t, vector<size_t>, greater<size_t>> availablePositions;
+	// the dense id of each of the tables, by name (protected by myLock)
+	map <string, size_t> tableIds;
 
-	// the page size
-	size_t pageSize;
+	// where the temporary pages are written
+	MyDB_TempSpace *tempSpace;
+
+	// the tables that have been memory-mapped (protected by myLock)
+	map <MyDB_TablePtr, MyDB_MappedTable *, TableCompare> mappedTables;
+
+	// does all of the page reads and writes
+	MyDB_IOBackendPtr io;
+
+	// true if the files are opened with O_DIRECT
+	bool directIO;
 
-	// the time tick associated with the MRU page
-	long lastTimeTick;
+	// true if temp pages are compressed when they are written out
+	atomic <bool> compressTemp;
 
-	// the last position in the temporary file
-	size_t lastTempPos;
+	// the statistics for the temp files (the statistics for each table are with the
+	// table's info)
+	MyDB_StatCounters tempStats;
 
-	// where we write the data
-	string tempFile;
+	// the statistics that do not belong to any table (the latch waits)
+	MyDB_StatCounters managerStats;
+
+	// the page size
+	size_t pageSize;
 
 	// the number of buffer pages
 	size_t numPages;
 
-	// when running multi-threaded, each thread automatically pins one page (the
-	// last one accessed) so that we are guaranteed that it can't be expelled... this
-	// lists all of the pages of RAM that have been pinned in this way
-	vector <void *> threadPinnedPages;
+	// the number of frames that operators have reserved (protected by myLock); operators
+	// waiting for a reservation wait on framesReleased (used with myLock)
+	size_t numReserved;
+	pthread_cond_t framesReleased;
+
+	// signaled when a frame may have become free, because a page was unpinned or an
+	// operator gave back its reservation; used with myLock
+	pthread_cond_t ramReleased;
+
+	// the background writer, if startWriter () has been called; wakeWriter (used with
+	// myLock) wakes it up early, and stopWriter (protected by myLock) tells it to quit
+	pthread_t writerThread;
+	bool writerRunning;
+	bool stopWriter;
+	pthread_cond_t wakeWriter;
+
+	// the number of pages at the cold end of each shard that the writer keeps clean
+	size_t numToKeepClean;
+
+	// the file that the manifest of hot pages is written to; empty if there is none
+	string manifestFile;
+
+	// the background preload, if startPreload () has been called; toPreload lists the
+	// pages that it reads in, the hottest first, and stopPreload tells it to quit early
+	pthread_t preloadThread;
+	bool preloadRunning;
+	atomic <bool> stopPreload;
+	vector <pair <MyDB_TablePtr, long>> toPreload;
+
+	// held while dirty pages are being chosen and written out by the writer or by
+	// flushAll (), so that only one of them is doing this at a time.  Acquired before
+	// any shard latch
+	pthread_mutex_t flushLock;
+
+	// each thread automatically pins the last few pages that it accessed, so that we are
+	// guaranteed that they can't be expelled while the thread is using their bytes... these
+	// are the pin slots of all of the threads that have used the buffer manager.  Entries
+	// [0, numPinSlots) are filled in; entries are only added (while holding myLock)
+	MyDB_PinSlotPtr pinSlots[MAX_PIN_SLOTS];
+	atomic <size_t> numPinSlots;
+
+	// uniquely identifies this buffer manager (even after it is gone), so that a thread
+	// can find its pin slot
+	long myId;
+
+	// the number of threads started by executeThreads () that are still running
+	size_t numWorkers;
+
+	// this is the lock for the buffer manager; it protects the list of tables and the
+	// maps of the mapped tables.  Everything else is protected by the shard latches.  A
+	// thread holding a shard latch may acquire myLock, but not vice versa
+	pthread_mutex_t myLock;
 
-	// this is the start and end of the call stack used to execute each of the threads
-	// when we are executing in multi-thrreaded mode
-	void *stackBase;
-	void *stackEnd;
+	// figure out which shard a particular page hashes to
+	size_t shardFor (size_t tableId, size_t i);
 
-	// this is the lock for the buffer manager
-	pthread_mutex_t myLock;
+	// gets the dense id of the given table.  The first time that the buffer manager
+	// sees a table (or a table with the same name), the table gets the next id, and its
+	// file is opened; after that, the id is cached in the table object, so finding it
+	// does not take any latch
+	size_t getTableId (MyDB_TablePtr whichTable);
+
+	// tries to get a chunk of RAM for a page that a scan is reading by taking it from
+	// the oldest page in the scan's ring; returns a nullptr if the ring is not full, or
+	// if none of the pages in the ring can be recycled.  Must be called without holding
+	// any shard latch
+	void *getRingRam (MyDB_ScanRing &ring);
+
+	// writes out the given (unpinned) page if it is dirty, and takes away its RAM, which
+	// is returned; the shard latch must be held.  The page is written out whole
+	void *evictPage (MyDB_BufferShard &shard, MyDB_PagePtr evictMe);
+
+	// gets a chunk of RAM for a page in the given shard, evicting if needed... first the
+	// shard itself is tried, then the other shards; only one latch is held at a time.
+	// Returns a nullptr if every shard is entirely pinned.  Must be called without holding
+	// any shard latch
+	void *getRam (size_t whichShard);
+
+	// like getRam, but if every shard is entirely pinned, waits for another thread to
+	// unpin a page or give back its reservation, and tries again.  If waitForever is
+	// false, this gives up (and returns a nullptr) after a few seconds
+	void *getRamOrWait (size_t whichShard, bool waitForever);
+
+	// read the contents of the page (whose RAM has already been set, and that is marked
+	// as having a pending read) from disk, then wake up anyone waiting on it
+	void readPage (MyDB_PagePtr readMe);
+
+	// if the page is a temp page, compresses it into compressed (which is a page in
+	// size) and returns the compressed size; returns zero if the page should be written
+	// out whole, which it always is if compressed is a nullptr
+	size_t compressPage (MyDB_Page &compressMe, void *compressed);
+
+	// writes out the given pages, which have already been marked as write pending and clean
+	// (while holding their shard latches), as a single batch; then marks them as no
+	// longer pending.  Must be called without holding any shard latch
+	void writeBack (vector <MyDB_PagePtr> &writeUs);
+
+	// the body of the background writer
+	static void *runWriter (void *me);
+
+	// the body of the background preload
+	static void *runPreload (void *me);
+
+	// reads in the given pages as a single batch of I/Os, using only free RAM; returns
+	// false if the RAM ran out
+	bool preloadBatch (vector <pair <MyDB_TablePtr, long>> &loadUs);
+
+	// gets a chunk of RAM that is not in use by any page, without evicting anything;
+	// tries the given shard first.  Returns a nullptr if there is no such RAM.  Must be
+	// called without holding any shard latch
+	void *getFreeRam (size_t whichShard);
+
+	// writes the manifest of the buffered table pages to manifestFile
+	void writeManifest ();
+
+	// writes out the dirty pages at the cold end of each shard's replacement order
+	void cleanColdPages ();
+
+	// wait until the given page does not have a read pending; must hold the shard latch
+	void waitForRead (MyDB_BufferShard &shard, MyDB_PagePtr waitForMe);
+
+	// gets the pin slot of the calling thread, giving it one if it does not have one
+	MyDB_PinSlot &getPinSlot ();
 
 	// this tells the buffer manager that the current thread has recently accessed
 	// the memory location indicated, and so the associated page cannot be expelled
@@ -147,19 +425,33 @@ private:
 	// so that it cannot be expelled from the buffer manager
 	bool checkCannotExpell (void *checkMe);
 
+	// takes the memory location out of every thread's pin slot; this is done whenever a
+	// page's RAM is taken away, so that a thread's fast path in access () cannot match the
+	// RAM once it belongs to another page
+	void clearCannotExpell (void *clearMe);
+
 	// so that the page can access these private methods
 	friend class MyDB_Page;
-	friend class SortMergeJoin;
 
-	// kick out the LRU page
-	void kickOutPage ();
+	// use the replacement policy to kick out a page in the given shard, whose latch must be held; returns
+	// false if every buffered page in the shard is pinned.  If the page that is picked is a dirty temp
+	// page that is compressed when it is written, it is not kicked out; rather, it is marked as write
+	// pending and clean and put into writeUs, and false is returned, so that the caller can write it
+	// out with writeBack () after giving up the latch
+	bool kickOutPage (MyDB_BufferShard &shard, vector <MyDB_PagePtr> &writeUs);
 
-	// process an access to the given page
-	void access (MyDB_PagePtr updateMe);
+	// process an access to the given page; if the access is part of a sequential
+	// scan, the scan's ring is given.  An access cannot fail, so if every frame is
+	// pinned, this waits until some other thread gives one back
+	void access (MyDB_Page &updateMe, MyDB_ScanRing *ring = nullptr);
 
-	// removes all traces of the page from the buffer manager
+	// removes all traces of the page from the buffer manager; the latch for the page's
+	// shard must be held
 	void killPage (MyDB_PagePtr killMe);
 
+	// get the latch for the shard that the page lives in
+	pthread_mutex_t *getShardLock (MyDB_Page &forMe);
+
 };
 
 #endif
@@ -0,0 +1,47 @@
+
+#ifndef BUFFER_SHARD_H
+#define BUFFER_SHARD_H
+
+#include "MyDB_Page.h"
+#include "MyDB_PageTable.h"
+#include "MyDB_ReplacementPolicy.h"
+#include <pthread.h>
+#include <vector>
+
+using namespace std;
+
+// the buffer manager's page table is hash-partitioned into a number of these
+// shards.  Each shard has its own latch, its own replacement policy, its own set of
+// pages, and its own list of unused RAM, so that page lookups and evictions
+// that hash to different shards can proceed in parallel.  RAM is not owned by
+// a shard; when a shard runs out, it can take a chunk from another shard
+struct MyDB_BufferShard {
+
+	// decides which of the shard's buffered pages gets evicted
+	MyDB_ReplacementPolicyPtr policy;
+
+	// ALL of the (non-anonymous) page objects in the shard
+	MyDB_PageTable allPages;
+
+	// all of the chunks of RAM that the shard currently has that are not allocated
+	vector <void *> availableRam;
+
+	// this is the latch for the shard
+	pthread_mutex_t myLock;
+
+	// signaled whenever a read into one of the shard's pages completes
+	pthread_cond_t ioDone;
+
+	MyDB_BufferShard () {
+		pthread_mutex_init (&myLock, nullptr);
+		pthread_cond_init (&ioDone, nullptr);
+	}
+
+	~MyDB_BufferShard () {
+		pthread_cond_destroy (&ioDone);
+		pthread_mutex_destroy (&myLock);
+	}
+};
+
+#endif
+
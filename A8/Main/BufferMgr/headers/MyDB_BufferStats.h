@@ -0,0 +1,206 @@
+
+#ifndef BUFFER_STATS_H
+#define BUFFER_STATS_H
+
+#include <atomic>
+#include <pthread.h>
+#include <string>
+#include <time.h>
+
+using namespace std;
+
+// latencies are counted in power-of-two buckets of nanoseconds: bucket i holds the
+// latencies in [2^i, 2^(i + 1)), and the last bucket holds everything longer
+#define LATENCY_BUCKETS 36
+
+// the current time, in nanoseconds, for timing things
+inline long nowNanos () {
+	struct timespec now;
+	clock_gettime (CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000000000L + now.tv_nsec;
+}
+
+// a histogram of I/O latencies, as copied out of the buffer manager
+struct MyDB_LatencyHistogram {
+
+	MyDB_LatencyHistogram () {
+		count = 0;
+		totalNanos = 0;
+		for (int i = 0; i < LATENCY_BUCKETS; i++)
+			buckets[i] = 0;
+	}
+
+	// the mean latency, in nanoseconds
+	double meanNanos ();
+
+	// an upper bound on the latency that the given fraction of the I/Os came in
+	// under (so percentile (.99) is the p99); this is the top of a bucket, so it is
+	// accurate to within a factor of two
+	long percentile (double fraction);
+
+	// writes the histogram out as a JSON object
+	string toJSON ();
+
+	long count;
+	long totalNanos;
+	long buckets[LATENCY_BUCKETS];
+};
+
+// the statistics for a buffer manager, or for one of the tables that it holds pages of,
+// as copied out of the buffer manager.  Accesses by a thread to a page that it has
+// accessed very recently are not counted as hits, since they are never seen by the
+// buffer manager's data structures
+struct MyDB_BufferStats {
+
+	MyDB_BufferStats () {
+		hits = 0;
+		misses = 0;
+		evictions = 0;
+		writeBacks = 0;
+		pinFailures = 0;
+		lockWaits = 0;
+		lockWaitNanos = 0;
+		bytesRead = 0;
+		bytesWritten = 0;
+	}
+
+	// accesses that found the page buffered, and that had to read it in
+	long hits;
+	long misses;
+
+	// pages that lost their RAM to make room for another page
+	long evictions;
+
+	// dirty pages written back, whether by an eviction, the background writer, or a flush
+	long writeBacks;
+
+	// calls to getPinnedPage () that returned a nullptr because the buffer was full of
+	// pinned pages
+	long pinFailures;
+
+	// the number of times that a thread had to wait for a latch that was held by someone
+	// else, and the total time spent waiting.  Only kept for the buffer manager as a
+	// whole; these are zero for a table
+	long lockWaits;
+	long lockWaitNanos;
+
+	// the number of bytes moved by page reads and page writes; this is less than a page
+	// for each I/O of a temp page that was compressed
+	long bytesRead;
+	long bytesWritten;
+
+	// the latency of page reads and page writes.  When a batch of pages is written at
+	// once, each write is charged the time for the whole batch
+	MyDB_LatencyHistogram reads;
+	MyDB_LatencyHistogram writes;
+
+	// writes the stats out as a JSON object
+	string toJSON ();
+};
+
+// an atomic version of a latency histogram, which is what the buffer manager updates
+struct MyDB_LatencyCounters {
+
+	MyDB_LatencyCounters () {
+		count = 0;
+		totalNanos = 0;
+		for (int i = 0; i < LATENCY_BUCKETS; i++)
+			buckets[i] = 0;
+	}
+
+	void record (long nanos) {
+		int whichBucket = 0;
+		if (nanos > 1)
+			whichBucket = 63 - __builtin_clzl (nanos);
+		if (whichBucket >= LATENCY_BUCKETS)
+			whichBucket = LATENCY_BUCKETS - 1;
+		buckets[whichBucket].fetch_add (1, memory_order_relaxed);
+		count.fetch_add (1, memory_order_relaxed);
+		totalNanos.fetch_add (nanos, memory_order_relaxed);
+	}
+
+	void addTo (MyDB_LatencyHistogram &addToMe) {
+		addToMe.count += count.load (memory_order_relaxed);
+		addToMe.totalNanos += totalNanos.load (memory_order_relaxed);
+		for (int i = 0; i < LATENCY_BUCKETS; i++)
+			addToMe.buckets[i] += buckets[i].load (memory_order_relaxed);
+	}
+
+	atomic <long> count;
+	atomic <long> totalNanos;
+	atomic <long> buckets[LATENCY_BUCKETS];
+};
+
+// the counters that the buffer manager keeps for a table (the temp file counts as a
+// table), and for the things that do not belong to any table.  These are updated with
+// relaxed atomic adds, so they are cheap enough to always keep; a copy taken while
+// the buffer manager is busy may be a little bit out of sync with itself
+struct MyDB_StatCounters {
+
+	MyDB_StatCounters () {
+		hits = 0;
+		misses = 0;
+		evictions = 0;
+		writeBacks = 0;
+		pinFailures = 0;
+		lockWaits = 0;
+		lockWaitNanos = 0;
+		bytesRead = 0;
+		bytesWritten = 0;
+	}
+
+	void addTo (MyDB_BufferStats &addToMe) {
+		addToMe.hits += hits.load (memory_order_relaxed);
+		addToMe.misses += misses.load (memory_order_relaxed);
+		addToMe.evictions += evictions.load (memory_order_relaxed);
+		addToMe.writeBacks += writeBacks.load (memory_order_relaxed);
+		addToMe.pinFailures += pinFailures.load (memory_order_relaxed);
+		addToMe.lockWaits += lockWaits.load (memory_order_relaxed);
+		addToMe.lockWaitNanos += lockWaitNanos.load (memory_order_relaxed);
+		addToMe.bytesRead += bytesRead.load (memory_order_relaxed);
+		addToMe.bytesWritten += bytesWritten.load (memory_order_relaxed);
+		reads.addTo (addToMe.reads);
+		writes.addTo (addToMe.writes);
+	}
+
+	atomic <long> hits;
+	atomic <long> misses;
+	atomic <long> evictions;
+	atomic <long> writeBacks;
+	atomic <long> pinFailures;
+	atomic <long> lockWaits;
+	atomic <long> lockWaitNanos;
+	atomic <long> bytesRead;
+	atomic <long> bytesWritten;
+	MyDB_LatencyCounters reads;
+	MyDB_LatencyCounters writes;
+};
+
+// this locks a pthread mutex like Lock does, but if the mutex is held by someone else,
+// the wait is counted in the given counters.  An uncontended lock costs one trylock
+class TimedLock {
+
+public:
+
+	TimedLock (pthread_mutex_t *inLock, MyDB_StatCounters &stats) {
+		myLock = inLock;
+		if (pthread_mutex_trylock (myLock) == 0)
+			return;
+
+		long start = nowNanos ();
+		pthread_mutex_lock (myLock);
+		stats.lockWaits.fetch_add (1, memory_order_relaxed);
+		stats.lockWaitNanos.fetch_add (nowNanos () - start, memory_order_relaxed);
+	}
+
+	~TimedLock () {
+		pthread_mutex_unlock (myLock);
+	}
+
+private:
+
+	pthread_mutex_t *myLock;
+};
+
+#endif
+
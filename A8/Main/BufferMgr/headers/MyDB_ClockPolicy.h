@@ -0,0 +1,159 @@
+
+#ifndef CLOCK_POLICY_H
+#define CLOCK_POLICY_H
+
+#include "MyDB_FrameTable.h"
+#include "MyDB_ReplacementPolicy.h"
+#include <vector>
+
+using namespace std;
+
+// this is the CLOCK replacement policy.  All of the buffered pages in the shard that
+// are not pinned are kept, each in a fixed slot of a circular array.  Accessing a page
+// just sets the reference bit in the descriptor of the page's frame, a single atomic
+// store; when a thread re-accesses one of the pages that it pinned recently, that store
+// is the only thing done, and it is done without the shard latch.  To find a
+// victim, a hand sweeps around the ring, clearing reference bits until it finds a
+// page whose bit is already clear.  A slot that is vacated is recycled, so the ring
+// never grows past the largest number of pages that the shard has buffered at once
+class MyDB_ClockPolicy : public MyDB_ReplacementPolicy {
+
+public:
+
+	MyDB_ClockPolicy (MyDB_FrameTable &framesIn) : frames (framesIn) {
+		hand = 0;
+	}
+
+	void admit (MyDB_PagePtr admitMe) {
+		touch (admitMe);
+	}
+
+	void reference (MyDB_PagePtr referenceMe) {
+		touch (referenceMe);
+	}
+
+	void referenceUnlatched (MyDB_Page &referenceMe) {
+		frames.getDesc (referenceMe.bytes).refBit.store (true, memory_order_relaxed);
+	}
+
+	void pin (MyDB_PagePtr pinMe) {
+		remove (pinMe);
+	}
+
+	// adds a page to the ring; does nothing if it is already there
+	void unpin (MyDB_PagePtr addMe) {
+
+		if (addMe->clockSlot != -1)
+			return;
+
+		// re-use an empty slot if there is one
+		if (freeSlots.size () == 0) {
+			addMe->clockSlot = slots.size ();
+			slots.push_back (addMe);
+		} else {
+			addMe->clockSlot = freeSlots.back ();
+			freeSlots.pop_back ();
+			slots[addMe->clockSlot] = addMe;
+		}
+	}
+
+	// sweeps the hand to find a page to evict.  Pages for which canEvict () is false
+	// are passed over without losing their reference bit.  A nullptr is returned if
+	// two full trips around the ring find nothing
+	MyDB_PagePtr victim (function <bool (MyDB_PagePtr &)> canEvict) {
+
+		size_t numSlots = slots.size ();
+		for (size_t i = 0; i < 2 * numSlots; i++) {
+
+			MyDB_PagePtr &candidate = slots[hand];
+			hand = (hand + 1) % numSlots;
+
+			if (candidate == nullptr || !canEvict (candidate))
+				continue;
+
+			// give the page a second chance if it has been accessed since the last sweep
+			if (frames.getDesc (candidate->bytes).refBit.exchange (false, memory_order_relaxed))
+				continue;
+
+			return candidate;
+		}
+
+		return nullptr;
+	}
+
+	// the pages that the hand will reach first whose reference bits are already clear
+	vector <MyDB_PagePtr> coldPages (size_t howMany) {
+
+		vector <MyDB_PagePtr> returnVal;
+		size_t numSlots = slots.size ();
+		for (size_t i = 0; i < numSlots && returnVal.size () < howMany; i++) {
+			MyDB_PagePtr &candidate = slots[(hand + i) % numSlots];
+			if (candidate != nullptr && !frames.getDesc (candidate->bytes).refBit.load (memory_order_relaxed))
+				returnVal.push_back (candidate);
+		}
+
+		return returnVal;
+	}
+
+	// the pages whose reference bits are set, and then the rest; in each group, the pages
+	// that the hand will reach last come first
+	vector <MyDB_PagePtr> hotPages () {
+
+		vector <MyDB_PagePtr> returnVal;
+		size_t numSlots = slots.size ();
+		for (int pass = 0; pass < 2; pass++) {
+			for (size_t i = numSlots; i > 0; i--) {
+				MyDB_PagePtr &candidate = slots[(hand + i - 1) % numSlots];
+				if (candidate == nullptr)
+					continue;
+
+				bool referenced = frames.getDesc (candidate->bytes).refBit.load (memory_order_relaxed);
+				if (referenced == (pass == 0))
+					returnVal.push_back (candidate);
+			}
+		}
+
+		return returnVal;
+	}
+
+	void evict (MyDB_PagePtr evictMe) {
+		remove (evictMe);
+	}
+
+	void forget (MyDB_PagePtr forgetMe) {
+		remove (forgetMe);
+	}
+
+private:
+
+	// the frames of the buffer pool, which hold the reference bits
+	MyDB_FrameTable &frames;
+
+	// the circular array of pages; an empty slot is a nullptr
+	vector <MyDB_PagePtr> slots;
+
+	// the empty slots in the array
+	vector <long> freeSlots;
+
+	// the position of the clock hand
+	size_t hand;
+
+	// sets the reference bit of a (buffered) page
+	inline void touch (MyDB_PagePtr touchMe) {
+		frames.getDesc (touchMe->bytes).refBit.store (true, memory_order_relaxed);
+	}
+
+	// takes a page out of the ring; does nothing if it is not there
+	void remove (MyDB_PagePtr removeMe) {
+
+		if (removeMe->clockSlot == -1)
+			return;
+
+		slots[removeMe->clockSlot] = nullptr;
+		freeSlots.push_back (removeMe->clockSlot);
+		removeMe->clockSlot = -1;
+	}
+};
+
+#endif
+
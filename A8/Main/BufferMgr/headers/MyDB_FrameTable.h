@@ -0,0 +1,73 @@
+
+#ifndef FRAME_TABLE_H
+#define FRAME_TABLE_H
+
+#include <atomic>
+#include <memory>
+
+using namespace std;
+
+// this is what the buffer manager keeps track of for each frame (that is, for each
+// page-sized chunk of buffer RAM), no matter which page is in the frame
+struct MyDB_FrameDesc {
+
+	// the CLOCK reference bit (used by MyDB_ClockPolicy) for the page in the frame;
+	// set whenever the page is accessed, and cleared by the clock hand as it sweeps past
+	atomic <bool> refBit;
+};
+
+// the buffer pool is a single contiguous arena of frames, so every frame has a dense
+// index, and the frame holding a page can be found from the address of the page's
+// bytes with a subtraction and a divide.  Per-frame metadata is kept in an array of
+// frame descriptors, indexed the same way.  The arena is mapped with huge pages if
+// the system has some set aside; otherwise the kernel is asked to back it with
+// transparent huge pages, to cut down on TLB misses
+class MyDB_FrameTable {
+
+public:
+
+	// maps an arena with numFrames frames of pageSize bytes each
+	MyDB_FrameTable (size_t pageSize, size_t numFrames);
+	~MyDB_FrameTable ();
+
+	// the number of frames
+	size_t getNumFrames () {
+		return numFrames;
+	}
+
+	// the bytes of the given frame
+	void *getBytes (size_t whichFrame) {
+		return arena + whichFrame * pageSize;
+	}
+
+	// the index of the frame that holds the given bytes
+	size_t getFrame (void *bytes) {
+		return (((char *) bytes) - arena) / pageSize;
+	}
+
+	// the descriptor for the frame that holds the given bytes
+	MyDB_FrameDesc &getDesc (void *bytes) {
+		return frames[getFrame (bytes)];
+	}
+
+	// true if the arena is mapped with huge pages that were set aside for it
+	bool usesHugePages () {
+		return hugePages;
+	}
+
+private:
+
+	// the frames themselves, and the size of the mapping
+	char *arena;
+	size_t arenaSize;
+
+	// the descriptors
+	unique_ptr <MyDB_FrameDesc []> frames;
+
+	size_t pageSize;
+	size_t numFrames;
+	bool hugePages;
+};
+
+#endif
+
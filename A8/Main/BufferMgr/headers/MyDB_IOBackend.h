@@ -0,0 +1,82 @@
+
+#ifndef IO_BACKEND_H
+#define IO_BACKEND_H
+
+#include <memory>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+using namespace std;
+
+// this lists all of the different ways that the buffer manager can do its page I/O
+enum MyDB_IOType {PositionalIO, UringIO, SyncIO};
+
+// with O_DIRECT, the bytes, size, and file offset of every I/O must be a multiple of this
+#define DIRECT_IO_ALIGNMENT 4096
+
+// create a smart pointer for I/O backends
+class MyDB_IOBackend;
+typedef shared_ptr <MyDB_IOBackend> MyDB_IOBackendPtr;
+
+// one page-sized read or write
+struct MyDB_PageIO {
+
+	MyDB_PageIO (int fdIn, void *bytesIn, size_t numBytesIn, off_t offsetIn, bool isWriteIn) {
+		fd = fdIn;
+		bytes = bytesIn;
+		numBytes = numBytesIn;
+		offset = offsetIn;
+		isWrite = isWriteIn;
+	}
+
+	int fd;
+	void *bytes;
+	size_t numBytes;
+	off_t offset;
+	bool isWrite;
+};
+
+// an I/O backend carries out page reads and writes for the buffer manager.  I/Os
+// are handed over in batches, so that a backend that can have many I/Os in flight
+// at once gets the chance to do so; a backend is shared by all of the threads that
+// use the buffer manager, so it must be thread safe
+class MyDB_IOBackend {
+
+public:
+
+	// carries out all of the I/Os in the batch, returning once they are all done.
+	// The I/Os may be done in any order, so no two of them should touch the same
+	// bytes.  A read that runs past the end of the file just stops there
+	virtual void submit (vector <MyDB_PageIO> &batch) = 0;
+
+	// tells the kernel that the ranges of the file in the batch are going to be read
+	// soon (the bytes fields are ignored); this is just a hint.  By default, runs of
+	// adjacent ranges in the same file are merged into a single posix_fadvise call
+	virtual void prefetch (vector <MyDB_PageIO> &batch);
+
+	// these do a single read or write
+	void read (int fd, void *bytes, size_t numBytes, off_t offset);
+	void write (int fd, void *bytes, size_t numBytes, off_t offset);
+
+	virtual ~MyDB_IOBackend () {}
+
+	// opens a file that pages are going to be read from and written to, with the given
+	// open () flags.  If direct is true, the file is opened with O_DIRECT, so that its
+	// pages bypass the kernel's page cache; if the file system does not support that,
+	// the file is opened normally.  Returns -1 if the file cannot be opened
+	static int openFile (string fileName, int flags, bool direct);
+
+	// creates a backend of the given type; if the type is not supported on this
+	// system (io_uring may be compiled out, or disabled by the kernel), then a
+	// PositionalIO backend is returned instead
+	static MyDB_IOBackendPtr makeBackend (MyDB_IOType whichType);
+
+protected:
+
+	// carries out the rest of an I/O, starting done bytes in, using pread/pwrite
+	static void finishIO (MyDB_PageIO &doMe, size_t done);
+};
+
+#endif
+
@@ -0,0 +1,60 @@
+
+#ifndef LRUK_POLICY_H
+#define LRUK_POLICY_H
+
+#include <deque>
+#include <map>
+#include "MyDB_ReplacementPolicy.h"
+#include <unordered_map>
+
+using namespace std;
+
+// this is LRU-2: the victim is the unpinned page whose second-to-last reference is
+// the oldest, and pages that have only been referenced once go first (in LRU order).
+// A page that is touched once by a scan is thus evicted before a page that is used
+// over and over.  The reference history of an evicted page is retained for a while,
+// so that a page that comes back quickly does not have to earn its place again
+class MyDB_LRUKPolicy : public MyDB_ReplacementPolicy {
+
+public:
+
+	// capacity is the (approximate) number of pages held by the shard; this is how
+	// many evicted pages have their histories retained
+	MyDB_LRUKPolicy (size_t capacity);
+
+	void admit (MyDB_PagePtr admitMe);
+	void reference (MyDB_PagePtr referenceMe);
+	void pin (MyDB_PagePtr pinMe);
+	void unpin (MyDB_PagePtr unpinMe);
+	MyDB_PagePtr victim (function <bool (MyDB_PagePtr &)> canEvict);
+	void evict (MyDB_PagePtr evictMe);
+	void forget (MyDB_PagePtr forgetMe);
+
+private:
+
+	// the last two reference times of a page; a zero means no reference
+	typedef pair <long, long> History;
+
+	// what we know about each buffered page
+	struct Entry {
+		History history;
+		bool pinned;
+	};
+
+	// all of the buffered pages that have been admitted
+	unordered_map <MyDB_Page *, Entry> buffered;
+
+	// the unpinned pages, ordered by (second-to-last reference, last reference)
+	map <History, MyDB_PagePtr> candidates;
+
+	// the histories of recently evicted pages, and the order they were evicted in
+	unordered_map <MyDB_PageKey, History, MyDB_PageKeyHash> retained;
+	deque <MyDB_PageKey> retainedOrder;
+
+	// the current reference time, and the number of histories to retain
+	long now;
+	size_t capacity;
+};
+
+#endif
+
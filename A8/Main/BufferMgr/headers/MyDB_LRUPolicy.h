@@ -0,0 +1,36 @@
+
+#ifndef LRU_POLICY_H
+#define LRU_POLICY_H
+
+#include <list>
+#include "MyDB_ReplacementPolicy.h"
+#include <unordered_map>
+
+using namespace std;
+
+// this is plain LRU: the unpinned pages are kept in a list in the order they were
+// last referenced, and the victim is the least recently used one
+class MyDB_LRUPolicy : public MyDB_ReplacementPolicy {
+
+public:
+
+	void admit (MyDB_PagePtr admitMe);
+	void reference (MyDB_PagePtr referenceMe);
+	void pin (MyDB_PagePtr pinMe);
+	void unpin (MyDB_PagePtr unpinMe);
+	MyDB_PagePtr victim (function <bool (MyDB_PagePtr &)> canEvict);
+	vector <MyDB_PagePtr> hotPages ();
+	void evict (MyDB_PagePtr evictMe);
+	void forget (MyDB_PagePtr forgetMe);
+
+private:
+
+	// the unpinned pages; the LRU page is at the front
+	list <MyDB_PagePtr> lruList;
+
+	// where each of the unpinned pages is in the list
+	unordered_map <MyDB_Page *, list <MyDB_PagePtr> :: iterator> where;
+};
+
+#endif
+
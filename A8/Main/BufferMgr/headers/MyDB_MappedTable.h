@@ -0,0 +1,65 @@
+
+#ifndef MAPPED_TABLE_H
+#define MAPPED_TABLE_H
+
+#include <memory>
+#include "MyDB_Page.h"
+#include "MyDB_Table.h"
+#include <pthread.h>
+#include <vector>
+
+using namespace std;
+
+// how a memory-mapped table is going to be read; this is passed on to the kernel,
+// which uses it to decide how much to read ahead
+enum MyDB_AccessPattern {SequentialAccess, RandomAccess};
+
+// a read-only memory mapping of all of the pages of a table.  The pages of a mapped
+// table are never copied into the buffer pool: the bytes of each page are just its
+// part of the mapping, and are served straight out of the kernel's page cache.  The
+// page objects are made the first time that each page is asked for, and are kept
+// until the mapping goes away.  The mapping is read-only, so a stray write to one of
+// its pages is caught by the hardware
+class MyDB_MappedTable {
+
+public:
+
+	// maps all of the pages that the table has (according to the catalog); exits if
+	// the file is shorter than that
+	MyDB_MappedTable (MyDB_TablePtr table, size_t pageSize, MyDB_AccessPattern pattern);
+	~MyDB_MappedTable ();
+
+	// tells the kernel how the table is going to be read from now on
+	void setAccessPattern (MyDB_AccessPattern pattern);
+
+	// the number of pages that are mapped
+	size_t getNumPages () {
+		return numPages;
+	}
+
+	// the bytes of the given page
+	void *getBytes (size_t whichPage) {
+		return base + whichPage * pageSize;
+	}
+
+private:
+
+	friend class MyDB_BufferManager;
+
+	// the table, and its file
+	MyDB_TablePtr table;
+	int fd;
+
+	// the mapping, and its size
+	char *base;
+	size_t numPages;
+	size_t pageSize;
+
+	// the page objects, indexed by page number; a nullptr if a page has not been asked
+	// for yet.  Protected by myLock
+	vector <MyDB_PagePtr> pages;
+	pthread_mutex_t myLock;
+};
+
+#endif
+
@@ -12,6 +12,7 @@
 #ifndef PAGE_H
 #define PAGE_H
 
+#include <atomic>
 #include <memory>
 #include "Lock.h"
 #include "MyDB_Table.h"
@@ -24,13 +25,23 @@ typedef shared_ptr <MyDB_Page> MyDB_PagePtr;
 
 // forward deifnition to handle circular dependencies
 class MyDB_BufferManager;
+class MyDB_ScanRing;
+struct MyDB_StatCounters;
+class MyDB_TempSegment;
+class MyDB_MappedTable;
 
-class MyDB_Page {
+// the part of a page's refCount that counts handles, and the amount that it goes up by
+// for each thread that is on its way to kill the page
+#define REF_COUNT_HANDLES 0xFFFFFFFFL
+#define REF_COUNT_KILLER (1L << 32)
+
+class MyDB_Page : public enable_shared_from_this <MyDB_Page> {
 
 public:
 
-	// access the raw bytes in this page
-	void *getBytes (MyDB_PagePtr me);
+	// access the raw bytes in this page; if the access is part of a sequential
+	// scan, the scan's ring is given
+	void *getBytes (MyDB_ScanRing *ring = nullptr);
 
 	// let the page know that we have written to the bytes
 	void wroteBytes ();
@@ -48,23 +59,26 @@ public:
 	// sets the bytes in the page
 	void setBytes (void *bytes, size_t numBytes);
 
-	// decrements the ref count
-	inline void decRefCount (MyDB_PagePtr me) {
+	// decrements the ref count; whoever takes the last handle away becomes a killer,
+	// and has to go kill the page
+	inline void decRefCount () {
 
-		{
-			Lock temp (&myMutex);
-			refCount--;
-		}
+		long oldCount = refCount.load (memory_order_relaxed);
+		long newCount;
+		do {
+			newCount = oldCount - 1;
+			if ((oldCount & REF_COUNT_HANDLES) == 1)
+				newCount += REF_COUNT_KILLER;
+		} while (!refCount.compare_exchange_weak (oldCount, newCount, memory_order_acq_rel));
 
-		if (refCount == 0) {
-			killpage (me);
+		if ((oldCount & REF_COUNT_HANDLES) == 1) {
+			killpage ();
 		}
 	}
 
 	// increments the ref count
 	inline void incRefCount () {
-		Lock temp (&myMutex);
-		refCount++;
+		refCount.fetch_add (1, memory_order_relaxed);
 	}
 
 	// get the parent
@@ -74,7 +88,9 @@ private:
 
 	friend class MyDB_BufferManager;
 	friend class PageComp;
-	friend class CheckLRU;
+	friend class MyDB_ClockPolicy;
+	friend class MyDB_MappedTable;
+	friend class MyDB_ReplacementPolicy;
 
 	// a pointer to the raw bytes
 	void *bytes;
@@ -95,17 +111,64 @@ private:
 	// this is the position of the page in the relation
 	size_t pos;
 
-	// this is the last time that the page had been accessed
-	long timeTick;
+	// the buffer manager's dense id for the relation; unused for a temp page
+	size_t tableId;
+
+	// the slot that the page occupies in its shard's clock ring, or -1 if the page
+	// is not in the ring (because it is pinned or not buffered)
+	long clockSlot;
+
+	// the buffer manager shard that this page lives in
+	size_t shard;
+
+	// the file that the page is read from and written to
+	int fd;
+
+	// for a temp page, the temp segment that the page's position belongs to; a
+	// nullptr for other pages
+	MyDB_TempSegment *tempSegment;
+
+	// for a temp page that was last written out compressed, the number of compressed
+	// bytes; zero if the page was written out whole.  Protected by the shard latch
+	size_t spillBytes;
+
+	// for a page of a memory-mapped table, the mapping that the page's bytes are in;
+	// such a page is never in the page table, and its bytes never change.  A nullptr
+	// for other pages
+	MyDB_MappedTable *mapping;
+
+	// the buffer manager's statistics counters for the table that the page is in
+	MyDB_StatCounters *stats;
+
+	// true while the bytes are being read in from disk; protected by the shard latch
+	bool ioPending;
+
+	// true while the bytes are being written out by a flush; the page cannot lose its
+	// RAM until the write is done.  Protected by the shard latch
+	bool writePending;
+
+	// true if this is a temp page that was killed while a write was pending, so that it
+	// has to be killed once the write is done; protected by the shard latch
+	bool killWhenWritten;
+
+	// the scan ring that read the page in, or a nullptr if the page has been used by
+	// anyone else since then; protected by the shard latch
+	MyDB_ScanRing *scanRing;
 
-	// the number of references
-	int refCount;
+	// the number of handles to the page, plus REF_COUNT_KILLER for every thread that took
+	// the count down to zero and has not yet gone on to kill the page.  A new handle can
+	// be made for a page with no handles (while holding the shard latch), so there can be
+	// more than one killer; the page stays around until the last of them is done.  The
+	// page can only be killed (or evicted and then killed) if the whole count is zero
+	atomic <long> refCount;
 
-	// mutex on the page
-	pthread_mutex_t myMutex;
+	// a temp page has no entry in the page table, so it keeps itself around until it is
+	// killed; this is a nullptr for other pages
+	MyDB_PagePtr self;
 
-	// kill the page
-	void killpage (MyDB_PagePtr me);
+	// called by a killer; the page is killed if this is the last killer, and there are
+	// still no handles
+	void killpage ();
 };
 
 #endif
@@ -0,0 +1,32 @@
+
+#ifndef PAGE_COMPRESSOR_H
+#define PAGE_COMPRESSOR_H
+
+#include <stddef.h>
+
+using namespace std;
+
+// a small, fast LZ77 compressor (in the style of LZ4) for pages that are spilled to
+// the temp files.  The compressed data is a series of sequences, each of which is a
+// token byte (the top four bits are the number of literals, and the bottom four are
+// the length of the match, less four), then the literals, then a two-byte offset back
+// to the match, with lengths of 15 or more continued in extra bytes.  The last sequence
+// has only literals.  Matches are found with a hash table of four-byte strings, so
+// the text-heavy records that the database spills usually shrink by half or more
+class MyDB_PageCompressor {
+
+public:
+
+	// compresses numBytes bytes into at most maxOut bytes at out; returns the size of
+	// the compressed data, or zero if it would not fit.  This is safe to call on bytes
+	// that another thread is changing, although the result will then not be a copy
+	// of any one version of them
+	static size_t compress (const void *in, size_t numBytes, void *out, size_t maxOut);
+
+	// decompresses numIn compressed bytes into exactly numBytes bytes at out; returns
+	// false if the compressed data is corrupt
+	static bool decompress (const void *in, size_t numIn, void *out, size_t numBytes);
+};
+
+#endif
+
@@ -15,21 +15,23 @@
 
 #include <memory>
 #include "MyDB_Page.h"
+#include "MyDB_ScanRing.h"
 #include "MyDB_Table.h"
 #include <string>
 
-// page handles are basically smart pointers
+// page handles are basically smart pointers.  A handle is an intrusive pointer: it is a
+// small value (there is no separate handle object out on the heap), and the count of the
+// handles to a page is kept in the page itself, as an atomic, so that copying a handle
+// is a single atomic increment.  A page does not go away while there are handles to it
 using namespace std;
-class MyDB_PageHandleBase;
-typedef shared_ptr <MyDB_PageHandleBase> MyDB_PageHandle;
 
-class MyDB_PageHandleBase {
+class MyDB_PageHandle {
 
 public:
 
 	// access the raw bytes in this page
 	void *getBytes () {
-		return page->getBytes (page);
+		return page->getBytes (ring.get ());
 	}
 
 	// let the page know that we have written to the bytes.  Must always
@@ -40,21 +42,84 @@ public:
 		page->wroteBytes ();
 	}
 
-	// There are no more references to the handle when this is called...
+	// a handle is used just like the smart pointer that it replaced, so this gives
+	// access to the methods above
+	MyDB_PageHandle *operator -> () {
+		return this;
+	}
+
+	// there are no more references to the handle when this is called...
 	// this should decrmeent a reference count to the number of handles
 	// to the particular page that it references.  If the number of 
 	// references to a pinned page goes down to zero, then the page should
 	// become unpinned.  
-	~MyDB_PageHandleBase () {
-		page->decRefCount (page);
+	~MyDB_PageHandle () {
+		release ();
 	}
 
-	// sets up the page...
-	MyDB_PageHandleBase (MyDB_PagePtr useMe) {
-		page = useMe;
+	// sets up the page... if the handle is being used for a sequential scan, then
+	// the scan's ring is given, and any read of the page through the handle uses it
+	MyDB_PageHandle (const MyDB_PagePtr &useMe, MyDB_ScanRingPtr ringIn = nullptr) {
+		page = useMe.get ();
+		ring = ringIn;
 		page->incRefCount ();
 	}
 
+	// a handle that does not refer to any page
+	MyDB_PageHandle () {
+		page = nullptr;
+	}
+
+	MyDB_PageHandle (nullptr_t) {
+		page = nullptr;
+	}
+
+	MyDB_PageHandle (const MyDB_PageHandle &copyMe) {
+		page = copyMe.page;
+		ring = copyMe.ring;
+		if (page != nullptr)
+			page->incRefCount ();
+	}
+
+	MyDB_PageHandle (MyDB_PageHandle &&moveMe) {
+		page = moveMe.page;
+		ring = move (moveMe.ring);
+		moveMe.page = nullptr;
+	}
+
+	MyDB_PageHandle &operator = (const MyDB_PageHandle &copyMe) {
+		if (copyMe.page != nullptr)
+			copyMe.page->incRefCount ();
+		release ();
+		page = copyMe.page;
+		ring = copyMe.ring;
+		return *this;
+	}
+
+	MyDB_PageHandle &operator = (MyDB_PageHandle &&moveMe) {
+		if (this != &moveMe) {
+			release ();
+			page = moveMe.page;
+			ring = move (moveMe.ring);
+			moveMe.page = nullptr;
+		}
+		return *this;
+	}
+
+	// true if the two handles refer to the same page
+	bool operator == (const MyDB_PageHandle &other) const {
+		return page == other.page;
+	}
+
+	// true if the handle does not refer to any page
+	bool operator == (nullptr_t) const {
+		return page == nullptr;
+	}
+
+	bool operator != (nullptr_t) const {
+		return page != nullptr;
+	}
+
 private:
 
 	friend class MyDB_PageReaderWriter;
@@ -64,9 +129,17 @@ private:
 		return page->getParent ();
 	}
 
-	friend class CheckLRU;
+	// gives up the handle's reference to the page, if it has one
+	void release () {
+		if (page != nullptr) {
+			page->decRefCount ();
+			page = nullptr;
+		}
+	}
+
 	friend class MyDB_BufferManager;
-	MyDB_PagePtr page;
+	MyDB_Page *page;
+	MyDB_ScanRingPtr ring;
 };
 
 #endif
@@ -0,0 +1,134 @@
+
+#ifndef PAGE_TABLE_H
+#define PAGE_TABLE_H
+
+#include <functional>
+#include "MyDB_Page.h"
+#include <vector>
+
+using namespace std;
+
+// the page table of a buffer shard, which finds the page object for a (non-anonymous)
+// page given the dense id that the buffer manager gave the page's table and the
+// page's position in the table.  This is an open-addressing hash table with linear
+// probing, so a lookup is a multiply, a shift, and (usually) a single cache line.
+// The table doubles when it gets half full, and a removal shifts back the entries
+// after it, so there are never any tombstones.  It is protected by the shard latch
+class MyDB_PageTable {
+
+public:
+
+	MyDB_PageTable () {
+		numUsed = 0;
+		resize (16);
+	}
+
+	// returns the page's entry in the table (which is good until the table is next
+	// changed), or a nullptr if the page is not there
+	MyDB_PagePtr *find (size_t tableId, size_t pos) {
+		size_t key = makeKey (tableId, pos);
+		for (size_t i = slotFor (key); entries[i].key != EMPTY_KEY; i = (i + 1) & mask) {
+			if (entries[i].key == key)
+				return &entries[i].page;
+		}
+		return nullptr;
+	}
+
+	// adds a page, which must not already be there
+	void insert (size_t tableId, size_t pos, MyDB_PagePtr page) {
+		if (2 * (numUsed + 1) > entries.size ())
+			resize (2 * entries.size ());
+		place (makeKey (tableId, pos), page);
+		numUsed++;
+	}
+
+	// removes a page; does nothing if it is not there
+	void erase (size_t tableId, size_t pos) {
+
+		size_t key = makeKey (tableId, pos);
+		size_t hole = slotFor (key);
+		for (; entries[hole].key != key; hole = (hole + 1) & mask) {
+			if (entries[hole].key == EMPTY_KEY)
+				return;
+		}
+
+		// move up any entry after the hole that would no longer be found with the hole
+		// there, until we get to an empty slot
+		for (size_t i = (hole + 1) & mask; entries[i].key != EMPTY_KEY; i = (i + 1) & mask) {
+			size_t home = slotFor (entries[i].key);
+			if (((i - home) & mask) >= ((i - hole) & mask)) {
+				entries[hole] = entries[i];
+				hole = i;
+			}
+		}
+
+		entries[hole].key = EMPTY_KEY;
+		entries[hole].page = nullptr;
+		numUsed--;
+	}
+
+	// calls doMe on every page in the table; doMe must not change the table
+	void forEach (function <void (MyDB_PagePtr &)> doMe) {
+		for (Entry &entry : entries) {
+			if (entry.key != EMPTY_KEY)
+				doMe (entry.page);
+		}
+	}
+
+	// the number of pages in the table
+	size_t size () {
+		return numUsed;
+	}
+
+private:
+
+	// the key that marks an empty slot; no page has it, since table ids are small
+	static const size_t EMPTY_KEY = (size_t) -1;
+
+	struct Entry {
+		size_t key;
+		MyDB_PagePtr page;
+	};
+
+	// the table id goes in the top 24 bits of a key, and the position in the rest
+	static size_t makeKey (size_t tableId, size_t pos) {
+		return (tableId << 40) | pos;
+	}
+
+	size_t slotFor (size_t key) {
+		return (key * 0x9E3779B97F4A7C15UL) >> shift;
+	}
+
+	// puts an entry in the first empty slot at or after its home slot
+	void place (size_t key, MyDB_PagePtr &page) {
+		size_t i = slotFor (key);
+		while (entries[i].key != EMPTY_KEY)
+			i = (i + 1) & mask;
+		entries[i].key = key;
+		entries[i].page = page;
+	}
+
+	void resize (size_t numSlots) {
+		vector <Entry> oldEntries (numSlots);
+		oldEntries.swap (entries);
+		for (Entry &entry : entries)
+			entry.key = EMPTY_KEY;
+		mask = numSlots - 1;
+		shift = 64 - __builtin_ctzl (numSlots);
+		for (Entry &entry : oldEntries) {
+			if (entry.key != EMPTY_KEY)
+				place (entry.key, entry.page);
+		}
+	}
+
+	// the slots; the number of them is a power of two
+	vector <Entry> entries;
+	size_t mask;
+	int shift;
+
+	// the number of slots that are in use
+	size_t numUsed;
+};
+
+#endif
+
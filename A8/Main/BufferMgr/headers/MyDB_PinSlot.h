@@ -0,0 +1,104 @@
+
+#ifndef PIN_SLOT_H
+#define PIN_SLOT_H
+
+#include <atomic>
+#include <memory>
+
+using namespace std;
+
+// the number of pages that each thread automatically keeps pinned (the ones it accessed last)
+#define PINS_PER_THREAD 4
+
+// create a smart pointer for pin slots
+struct MyDB_PinSlot;
+typedef shared_ptr <MyDB_PinSlot> MyDB_PinSlotPtr;
+
+// each thread that uses a buffer manager gets its own pin slot from the manager the first
+// time it accesses a page.  The slot lists the RAM of the last few pages that the thread
+// accessed, so that the thread can keep using the bytes of those pages without their
+// being evicted, much like a set of hazard pointers.  Only the owning thread adds entries
+// (while holding the latch of the shard of the page involved), but any thread may read
+// them; when a page's RAM is given back, the thread doing so takes it out of every slot,
+// so that the RAM cannot be mistaken for the page that gets it next.  The slot is shared by the thread and the manager, so that either of
+// them can go away first; once the thread is done with it, the slot is cleared and can be
+// handed to another thread
+struct MyDB_PinSlot {
+
+	MyDB_PinSlot (size_t whichSlotIn) {
+		whichSlot = whichSlotIn;
+		clear ();
+		inUse = true;
+		retired = false;
+	}
+
+	// the position of the slot in the buffer manager's list of slots
+	size_t whichSlot;
+
+	// true if the given RAM is one of the entries
+	bool has (void *checkMe) {
+		for (int i = 0; i < PINS_PER_THREAD; i++) {
+			if (pinned[i].load (memory_order_relaxed) == checkMe)
+				return true;
+		}
+		return false;
+	}
+
+	// called by the owning thread when it accesses the given RAM again; true if the RAM
+	// is one of the entries, in which case it becomes the one that was used last
+	bool touch (void *touchMe) {
+		for (int i = 0; i < PINS_PER_THREAD; i++) {
+			if (pinned[i].load (memory_order_relaxed) == touchMe) {
+				lastUsed[i] = ++clock;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// adds the given RAM, replacing the entry that was used longest ago.  Entries are
+	// never moved around, since another thread could miss an entry while it was moving
+	void add (void *addMe) {
+		if (touch (addMe))
+			return;
+		int oldest = 0;
+		for (int i = 1; i < PINS_PER_THREAD; i++) {
+			if (lastUsed[i] < lastUsed[oldest])
+				oldest = i;
+		}
+		pinned[oldest].store (addMe, memory_order_relaxed);
+		lastUsed[oldest] = ++clock;
+	}
+
+	// takes the given RAM out of the entries, if it is there
+	void release (void *releaseMe) {
+		for (int i = 0; i < PINS_PER_THREAD; i++) {
+			void *expected = releaseMe;
+			pinned[i].compare_exchange_strong (expected, nullptr);
+		}
+	}
+
+	void clear () {
+		for (int i = 0; i < PINS_PER_THREAD; i++) {
+			pinned[i].store (nullptr, memory_order_relaxed);
+			lastUsed[i] = 0;
+		}
+		clock = 0;
+	}
+
+	// the RAM of the pages that the thread accessed last; unused entries are nullptr
+	atomic <void *> pinned[PINS_PER_THREAD];
+
+	// when each entry was last used by the owning thread, counted in accesses
+	unsigned long lastUsed[PINS_PER_THREAD];
+	unsigned long clock;
+
+	// true while a thread owns the slot
+	atomic <bool> inUse;
+
+	// true once the buffer manager that the slot came from is gone
+	atomic <bool> retired;
+};
+
+#endif
+
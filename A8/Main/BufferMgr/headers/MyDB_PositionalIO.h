@@ -0,0 +1,21 @@
+
+#ifndef POSITIONAL_IO_H
+#define POSITIONAL_IO_H
+
+#include "MyDB_IOBackend.h"
+
+using namespace std;
+
+// this backend does the I/Os in the batch one after another, with pread/pwrite.
+// Writes to adjacent pages of the same file are coalesced, so that each run of them
+// is written with a single pwritev.  Since pread/pwrite/pwritev do not use the file
+// offset, any number of threads can be doing I/O through the backend at once
+class MyDB_PositionalIO : public MyDB_IOBackend {
+
+public:
+
+	void submit (vector <MyDB_PageIO> &batch);
+};
+
+#endif
+
@@ -0,0 +1,48 @@
+
+#ifndef READ_AHEAD_H
+#define READ_AHEAD_H
+
+// the largest number of pages that a sequential iterator reads ahead
+#define MAX_READ_AHEAD 8
+
+// this keeps track of the read-ahead window for an iterator that walks through a
+// sequence of pages.  The window starts out at one page, and doubles (up to
+// MAX_READ_AHEAD pages) every time that the iterator moves on to the next page, so
+// that a short scan does not read a lot of pages it will never use, while a long
+// scan keeps several reads in flight
+class MyDB_ReadAhead {
+
+public:
+
+	MyDB_ReadAhead () {
+		nextPage = 0;
+		window = 1;
+	}
+
+	// the iterator has just moved to page curPage, and it will not go past page
+	// lastPage; prefetchMe (i) is called for every page i that should now be read ahead
+	template <class Prefetch>
+	void moveTo (long curPage, long lastPage, Prefetch prefetchMe) {
+
+		// if the iterator skipped past what we have read ahead, start from here
+		if (nextPage <= curPage)
+			nextPage = curPage + 1;
+
+		for (; nextPage <= lastPage && nextPage <= curPage + window; nextPage++)
+			prefetchMe (nextPage);
+
+		if (window < MAX_READ_AHEAD)
+			window *= 2;
+	}
+
+private:
+
+	// the next page that has not been read ahead
+	long nextPage;
+
+	// the number of pages past the current one that are read ahead
+	long window;
+};
+
+#endif
+
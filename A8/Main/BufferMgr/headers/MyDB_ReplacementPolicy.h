@@ -0,0 +1,154 @@
+
+#ifndef REPLACEMENT_POLICY_H
+#define REPLACEMENT_POLICY_H
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "MyDB_FrameTable.h"
+#include "MyDB_Page.h"
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// this lists all of the different page replacement policies
+enum MyDB_ReplacementType {ClockReplacement, LRUReplacement, LRUKReplacement, TwoQReplacement, ARCReplacement};
+
+// create a smart pointer for replacement policies
+class MyDB_ReplacementPolicy;
+typedef shared_ptr <MyDB_ReplacementPolicy> MyDB_ReplacementPolicyPtr;
+
+// identifies a (non-anonymous) page even after the page object is gone, so that
+// policies can remember pages that have been evicted; it is the buffer manager's id
+// for the page's table, and the page's position in the table
+typedef pair <size_t, size_t> MyDB_PageKey;
+
+struct MyDB_PageKeyHash {
+	size_t operator() (const MyDB_PageKey &hashMe) const {
+		return (hashMe.first * 0x9E3779B1UL + hashMe.second) * 0x9E3779B97F4A7C15UL;
+	}
+};
+
+// a replacement policy decides which page in a buffer shard gets evicted.  Each shard
+// has its own policy object, and (except for referenceUnlatched ()) all of the calls
+// into the policy are made while holding the shard latch.  Over its life, a page is
+// admitted (when it gets RAM), referenced any number of times, pinned and unpinned
+// any number of times, and then evicted or forgotten.  Only unpinned pages can be
+// chosen as victims; a page is admitted in the pinned state
+class MyDB_ReplacementPolicy {
+
+public:
+
+	// called when an access finds the page already buffered
+	void hit (MyDB_PagePtr hitMe) {
+		numHits++;
+		reference (hitMe);
+	}
+
+	// called when an access has to read the page in; the page is admitted
+	void miss (MyDB_PagePtr missMe) {
+		numMisses++;
+		admit (missMe);
+	}
+
+	// the number of hits and misses seen so far
+	long getHits () {
+		return numHits;
+	}
+
+	long getMisses () {
+		return numMisses;
+	}
+
+	// a page that was not buffered has just been given RAM; it starts out pinned
+	virtual void admit (MyDB_PagePtr admitMe) = 0;
+
+	// a buffered page has been accessed
+	virtual void reference (MyDB_PagePtr referenceMe) = 0;
+
+	// a buffered page has been accessed again by a thread that accessed it recently;
+	// this is called WITHOUT the shard latch, so by default it does nothing
+	virtual void referenceUnlatched (MyDB_Page &) {}
+
+	// the page can no longer be evicted
+	virtual void pin (MyDB_PagePtr pinMe) = 0;
+
+	// the page can now be evicted; does nothing if it already could be
+	virtual void unpin (MyDB_PagePtr unpinMe) = 0;
+
+	// chooses an unpinned page to evict, passing over pages for which canEvict () is
+	// false.  The victim is not removed; returns a nullptr if there is no candidate
+	virtual MyDB_PagePtr victim (function <bool (MyDB_PagePtr &)> canEvict) = 0;
+
+	// lists (up to) the next howMany pages that are likely to be chosen as victims, the
+	// most likely first, without changing anything.  By default, this just asks victim ()
+	// over and over, each time passing over the pages that have already been listed
+	virtual vector <MyDB_PagePtr> coldPages (size_t howMany) {
+
+		vector <MyDB_PagePtr> returnVal;
+		unordered_set <MyDB_Page *> listed;
+		while (returnVal.size () < howMany) {
+			MyDB_PagePtr next = victim ([&] (MyDB_PagePtr &candidate) {
+				return listed.count (candidate.get ()) == 0;
+			});
+			if (next == nullptr)
+				break;
+			listed.insert (next.get ());
+			returnVal.push_back (next);
+		}
+
+		return returnVal;
+	}
+
+	// lists all of the unpinned pages, the most recently used first (as best the policy
+	// can tell), without changing anything.  By default, this is coldPages () backwards
+	virtual vector <MyDB_PagePtr> hotPages () {
+		vector <MyDB_PagePtr> returnVal = coldPages ((size_t) -1);
+		reverse (returnVal.begin (), returnVal.end ());
+		return returnVal;
+	}
+
+	// the page has been written out and has lost its RAM
+	virtual void evict (MyDB_PagePtr evictMe) = 0;
+
+	// the page has been destroyed, so it should not be remembered; does nothing if
+	// the policy does not know about the page
+	virtual void forget (MyDB_PagePtr forgetMe) = 0;
+
+	virtual ~MyDB_ReplacementPolicy () {}
+
+	// creates a policy of the given type for a shard that holds about capacity pages
+	// of the frames in the given table
+	static MyDB_ReplacementPolicyPtr makePolicy (MyDB_ReplacementType whichType, size_t capacity,
+		MyDB_FrameTable &frames);
+
+protected:
+
+	MyDB_ReplacementPolicy () {
+		numHits = 0;
+		numMisses = 0;
+	}
+
+	// true if the page is an anonymous page (whose position in the temp file may be
+	// re-used, so it should not be remembered after it is evicted)
+	static bool isAnonymous (MyDB_PagePtr checkMe) {
+		return checkMe->myTable == nullptr;
+	}
+
+	// get the key for a non-anonymous page
+	static MyDB_PageKey keyFor (MyDB_PagePtr keyMe) {
+		return make_pair (keyMe->tableId, (size_t) keyMe->pos);
+	}
+
+private:
+
+	atomic <long> numHits;
+	atomic <long> numMisses;
+};
+
+#endif
+
@@ -0,0 +1,41 @@
+
+#ifndef RESERVATION_H
+#define RESERVATION_H
+
+#include "MyDB_BufferManager.h"
+
+using namespace std;
+
+// a reservation of buffer frames for an operator (see MyDB_BufferManager :: reserveFrames ()).
+// The frames are reserved when the object is created, and given back as soon as it goes
+// out of scope, so an operator that bails out early does not leak its budget
+class MyDB_Reservation {
+
+public:
+
+	MyDB_Reservation (MyDB_BufferManagerPtr bufferMgrIn, size_t numWanted, size_t numNeeded = 1) {
+		bufferMgr = bufferMgrIn;
+		numFrames = bufferMgr->reserveFrames (numWanted, numNeeded);
+	}
+
+	~MyDB_Reservation () {
+		bufferMgr->releaseFrames (numFrames);
+	}
+
+	// the number of frames that were granted
+	size_t size () {
+		return numFrames;
+	}
+
+private:
+
+	MyDB_BufferManagerPtr bufferMgr;
+	size_t numFrames;
+
+	// a reservation cannot be copied, since then it would be given back twice
+	MyDB_Reservation (const MyDB_Reservation &);
+	MyDB_Reservation &operator = (const MyDB_Reservation &);
+};
+
+#endif
+
@@ -0,0 +1,41 @@
+
+#ifndef SCAN_RING_H
+#define SCAN_RING_H
+
+#include <deque>
+#include <memory>
+#include "MyDB_Page.h"
+
+using namespace std;
+
+// create a smart pointer for scan rings
+class MyDB_ScanRing;
+typedef shared_ptr <MyDB_ScanRing> MyDB_ScanRingPtr;
+
+// a scan ring lets a big sequential scan recycle a small set of its own buffer
+// pages, rather than having every page it reads push something useful out of the
+// buffer.  Once the ring is full, a page that the scan reads in takes the RAM of
+// the oldest page in the ring, as long as no one else has used that page since the
+// scan read it in (if someone has, that page has been adopted by the buffer, and
+// the scan gets RAM in the usual way).  A ring is used by one thread at a time
+class MyDB_ScanRing {
+
+public:
+
+	MyDB_ScanRing (size_t maxPagesIn) {
+		maxPages = maxPagesIn;
+	}
+
+private:
+
+	friend class MyDB_BufferManager;
+
+	// the pages that the scan has read in, the oldest one first
+	deque <MyDB_PagePtr> pages;
+
+	// the number of pages that the scan can have in the ring
+	size_t maxPages;
+};
+
+#endif
+
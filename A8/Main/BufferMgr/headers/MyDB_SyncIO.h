@@ -0,0 +1,65 @@
+
+#ifndef SYNC_IO_H
+#define SYNC_IO_H
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include "Lock.h"
+#include "MyDB_IOBackend.h"
+#include <pthread.h>
+#include <unistd.h>
+
+using namespace std;
+
+// this is the fallback backend: each I/O is a seek followed by a plain read or write.
+// Since the seek moves the file offset that all of the threads share, the whole batch
+// is done while holding a latch, so only one thread at a time is doing I/O
+class MyDB_SyncIO : public MyDB_IOBackend {
+
+public:
+
+	MyDB_SyncIO () {
+		pthread_mutex_init (&myLock, nullptr);
+	}
+
+	~MyDB_SyncIO () {
+		pthread_mutex_destroy (&myLock);
+	}
+
+	void submit (vector <MyDB_PageIO> &batch) {
+
+		Lock temp (&myLock);
+		for (MyDB_PageIO &doMe : batch) {
+
+			if (lseek (doMe.fd, doMe.offset, SEEK_SET) == -1) {
+				cout << "Can't seek to offset " << doMe.offset << ": " << strerror (errno) << "\n";
+				exit (1);
+			}
+
+			// keep going until the whole page is done, or a read hits the end of the file
+			size_t done = 0;
+			while (done < doMe.numBytes) {
+				char *where = ((char *) doMe.bytes) + done;
+				ssize_t res = doMe.isWrite ? ::write (doMe.fd, where, doMe.numBytes - done) :
+					::read (doMe.fd, where, doMe.numBytes - done);
+				if (res == -1 && errno == EINTR)
+					continue;
+				if (res == -1) {
+					cout << "Page I/O failed: " << strerror (errno) << "\n";
+					exit (1);
+				}
+				if (res == 0)
+					break;
+				done += res;
+			}
+		}
+	}
+
+private:
+
+	pthread_mutex_t myLock;
+};
+
+#endif
+
@@ -0,0 +1,110 @@
+
+#ifndef TEMP_SPACE_H
+#define TEMP_SPACE_H
+
+#include "MyDB_BufferStats.h"
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// the number of pages that a temp segment grows by at once; the new space is
+// preallocated in the file system as a single extent
+#define TEMP_EXTENT_PAGES 64
+
+// a temp segment is a file that holds anonymous pages.  Each thread that makes anonymous
+// pages gets its own segment, so that threads do not fight over where their pages go,
+// and so that the pages that a thread spills land next to each other in one file.  Which
+// positions are in use is kept in a bitmap, and positions are handed out next-fit from
+// the last one handed out, so a thread that makes a run of pages writes them out
+// sequentially.  Only the owning thread allocates, but a page can be killed (and its
+// position released) by any thread, so the segment has its own latch, which is a leaf:
+// it may be acquired while holding any other latch
+class MyDB_TempSegment {
+
+public:
+
+	// the segment's file is not created until the first page is allocated; it is opened
+	// with O_DIRECT if directIO is true
+	MyDB_TempSegment (string fileName, size_t pageSize, bool directIO, MyDB_StatCounters &waitStats);
+	~MyDB_TempSegment ();
+
+	// finds a free position in the segment and marks it as used, growing the file by
+	// an extent if there is none
+	size_t allocate ();
+
+	// marks the given position as free
+	void release (size_t pos);
+
+	// the file descriptor; only valid once a page has been allocated
+	int getFd () {
+		return fd;
+	}
+
+	// the number of positions that are in use
+	size_t getNumUsed ();
+
+private:
+
+	// the file, and its name
+	int fd;
+	string fileName;
+
+	// the page size, and whether the file bypasses the kernel's page cache
+	size_t pageSize;
+	bool directIO;
+
+	// bit i of word i / 64 is set if position i is in use; the file is (at least) 64
+	// pages long for every word
+	vector <unsigned long> used;
+
+	// the number of positions in use
+	size_t numUsed;
+
+	// where the search for a free position starts
+	size_t nextPos;
+
+	// protects everything above
+	pthread_mutex_t myLock;
+
+	// where waits for the latch are counted
+	MyDB_StatCounters &waitStats;
+};
+
+// all of the temp segments of a buffer manager; the segment for each pin slot is made
+// the first time that a thread holding the slot needs one, and is used by every thread
+// that holds the slot after that.  Since a slot is only held by one thread at a time,
+// no latch is needed to find a segment.  The file for segment i is the temp file name
+// with ".i" tacked on
+class MyDB_TempSpace {
+
+public:
+
+	// there can be up to numSegments segments; their files are opened with O_DIRECT if
+	// directIO is true
+	MyDB_TempSpace (string tempFile, size_t pageSize, size_t numSegments, bool directIO, MyDB_StatCounters &waitStats);
+
+	// closes and deletes all of the files
+	~MyDB_TempSpace ();
+
+	// gets the given segment, making it if needed; only the thread that holds pin slot
+	// whichSegment may call this
+	MyDB_TempSegment &getSegment (size_t whichSegment);
+
+private:
+
+	// the segments, which are never removed; a nullptr if a segment has not been made
+	vector <MyDB_TempSegment *> segments;
+
+	// where files go, how big the pages are, and how the files are opened
+	string tempFile;
+	size_t pageSize;
+	bool directIO;
+
+	// where waits for the latches are counted
+	MyDB_StatCounters &waitStats;
+};
+
+#endif
+
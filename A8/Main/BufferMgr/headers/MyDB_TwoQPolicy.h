@@ -0,0 +1,59 @@
+
+#ifndef TWOQ_POLICY_H
+#define TWOQ_POLICY_H
+
+#include <list>
+#include "MyDB_ReplacementPolicy.h"
+#include <unordered_map>
+
+using namespace std;
+
+// this is the full version of 2Q.  A page that is read in for the first time goes
+// into the FIFO queue A1in; while A1in holds more than a quarter of the shard, the
+// victim comes from there, and its key goes into the ghost queue A1out.  A page that
+// is read in while its key is in A1out has been used twice, so it goes into Am,
+// which is managed as LRU.  Pages that are only touched once (such as the pages of a
+// big scan) thus cycle through A1in without disturbing the hot pages in Am
+class MyDB_TwoQPolicy : public MyDB_ReplacementPolicy {
+
+public:
+
+	// capacity is the (approximate) number of pages held by the shard
+	MyDB_TwoQPolicy (size_t capacity);
+
+	void admit (MyDB_PagePtr admitMe);
+	void reference (MyDB_PagePtr referenceMe);
+	void pin (MyDB_PagePtr pinMe);
+	void unpin (MyDB_PagePtr unpinMe);
+	MyDB_PagePtr victim (function <bool (MyDB_PagePtr &)> canEvict);
+	void evict (MyDB_PagePtr evictMe);
+	void forget (MyDB_PagePtr forgetMe);
+
+private:
+
+	// what we know about each buffered page
+	struct Entry {
+		bool inAm;
+		bool pinned;
+		list <MyDB_PagePtr> :: iterator pos;
+	};
+
+	// the buffered pages; the oldest (or LRU) page is at the front of each list
+	list <MyDB_PagePtr> a1in;
+	list <MyDB_PagePtr> am;
+	unordered_map <MyDB_Page *, Entry> buffered;
+
+	// the keys of pages recently evicted from A1in; the oldest is at the front
+	list <MyDB_PageKey> a1out;
+	unordered_map <MyDB_PageKey, list <MyDB_PageKey> :: iterator, MyDB_PageKeyHash> inA1out;
+
+	// the target size of A1in, and the max size of A1out
+	size_t kin;
+	size_t kout;
+
+	// finds the first unpinned, evictable page in the list
+	MyDB_PagePtr scan (list <MyDB_PagePtr> &scanMe, function <bool (MyDB_PagePtr &)> &canEvict);
+};
+
+#endif
+
@@ -0,0 +1,70 @@
+
+#ifndef URING_IO_H
+#define URING_IO_H
+
+#include "MyDB_IOBackend.h"
+#include <pthread.h>
+#include <sys/uio.h>
+
+using namespace std;
+
+// the number of I/Os that can be in flight at once on the ring
+#define URING_DEPTH 64
+
+// this backend hands each batch to the kernel through an io_uring, using the raw
+// io_uring_setup/io_uring_enter system calls (so there is no need for liburing).  All
+// of the I/Os in a batch (up to URING_DEPTH at a time) are submitted with a single
+// system call and run concurrently inside the kernel.  There is one ring per backend;
+// a thread holds the ring's latch from the time it submits a batch until the batch is
+// complete, so batches from different threads are done one after another
+class MyDB_UringIO : public MyDB_IOBackend {
+
+public:
+
+	// sets up the ring; if that fails, isReady () returns false and the backend
+	// must not be used
+	MyDB_UringIO ();
+	~MyDB_UringIO ();
+
+	// true if the ring was set up
+	bool isReady ();
+
+	void submit (vector <MyDB_PageIO> &batch);
+
+private:
+
+	// the fd for the ring, or -1 if there is none
+	int ringFd;
+
+	// the submission queue ring, the array of submission queue entries, and the
+	// completion queue ring, all of which are mapped from the kernel (the two rings
+	// may be a single mapping)
+	void *sqRing;
+	size_t sqRingSize;
+	void *sqEntries;
+	size_t sqEntriesSize;
+	void *cqRing;
+	size_t cqRingSize;
+
+	// pointers to the fields of the rings
+	unsigned *sqTail;
+	unsigned *sqMask;
+	unsigned *sqArray;
+	unsigned numEntries;
+	unsigned *cqHead;
+	unsigned *cqTail;
+	unsigned *cqMask;
+	void *cqEntries;
+
+	// the buffer descriptors for the I/Os in flight
+	struct iovec iovecs[URING_DEPTH];
+
+	// held while a batch is in flight
+	pthread_mutex_t myLock;
+
+	// unmaps the rings and closes the ring fd
+	void tearDown ();
+};
+
+#endif
+
@@ -0,0 +1,162 @@
+
+#ifndef ARC_POLICY_C
+#define ARC_POLICY_C
+
+#include "MyDB_ARCPolicy.h"
+
+MyDB_ARCPolicy :: MyDB_ARCPolicy (size_t capacityIn) {
+	capacity = capacityIn;
+	target = 0;
+}
+
+void MyDB_ARCPolicy :: admit (MyDB_PagePtr admitMe) {
+
+	Entry &entry = buffered[admitMe.get ()];
+	entry.pinned = true;
+	entry.inT2 = false;
+
+	// see if the page is in one of the ghost lists; if it is, adapt the target size
+	// of T1 and put the page in T2
+	if (!isAnonymous (admitMe)) {
+
+		MyDB_PageKey key = keyFor (admitMe);
+		double b1Size = b1.keys.size ();
+		double b2Size = b2.keys.size ();
+
+		if (removeGhost (b1, key)) {
+			target += (b2Size > b1Size ? b2Size / b1Size : 1.0);
+			if (target > capacity)
+				target = capacity;
+			entry.inT2 = true;
+		} else if (removeGhost (b2, key)) {
+			target -= (b1Size > b2Size ? b1Size / b2Size : 1.0);
+			if (target < 0)
+				target = 0;
+			entry.inT2 = true;
+		}
+	}
+
+	if (entry.inT2) {
+		entry.pos = t2.insert (t2.end (), admitMe);
+	} else {
+		entry.pos = t1.insert (t1.end (), admitMe);
+	}
+
+	trimGhosts ();
+}
+
+void MyDB_ARCPolicy :: reference (MyDB_PagePtr referenceMe) {
+
+	auto found = buffered.find (referenceMe.get ());
+	if (found == buffered.end ())
+		return;
+
+	// the page moves to the MRU end of T2
+	Entry &entry = found->second;
+	if (entry.inT2) {
+		t2.splice (t2.end (), t2, entry.pos);
+	} else {
+		t2.splice (t2.end (), t1, entry.pos);
+		entry.inT2 = true;
+	}
+}
+
+void MyDB_ARCPolicy :: pin (MyDB_PagePtr pinMe) {
+	auto found = buffered.find (pinMe.get ());
+	if (found != buffered.end ())
+		found->second.pinned = true;
+}
+
+void MyDB_ARCPolicy :: unpin (MyDB_PagePtr unpinMe) {
+	auto found = buffered.find (unpinMe.get ());
+	if (found != buffered.end ())
+		found->second.pinned = false;
+}
+
+MyDB_PagePtr MyDB_ARCPolicy :: scan (list <MyDB_PagePtr> &scanMe, function <bool (MyDB_PagePtr &)> &canEvict) {
+
+	for (MyDB_PagePtr &candidate : scanMe) {
+		if (!buffered[candidate.get ()].pinned && canEvict (candidate))
+			return candidate;
+	}
+
+	return nullptr;
+}
+
+MyDB_PagePtr MyDB_ARCPolicy :: victim (function <bool (MyDB_PagePtr &)> canEvict) {
+
+	// take from T1 if it is over its target size, otherwise from T2; if there is
+	// nothing that can be evicted there, try the other list
+	MyDB_PagePtr returnVal;
+	if (t1.size () > 0 && t1.size () >= target) {
+		returnVal = scan (t1, canEvict);
+		if (returnVal == nullptr)
+			returnVal = scan (t2, canEvict);
+	} else {
+		returnVal = scan (t2, canEvict);
+		if (returnVal == nullptr)
+			returnVal = scan (t1, canEvict);
+	}
+
+	return returnVal;
+}
+
+void MyDB_ARCPolicy :: evict (MyDB_PagePtr evictMe) {
+
+	auto found = buffered.find (evictMe.get ());
+	if (found == buffered.end ())
+		return;
+
+	// remember the page in the ghost list that goes with the list it was in
+	if (!isAnonymous (evictMe))
+		addGhost (found->second.inT2 ? b2 : b1, keyFor (evictMe));
+
+	forget (evictMe);
+	trimGhosts ();
+}
+
+void MyDB_ARCPolicy :: forget (MyDB_PagePtr forgetMe) {
+
+	auto found = buffered.find (forgetMe.get ());
+	if (found == buffered.end ())
+		return;
+
+	if (found->second.inT2) {
+		t2.erase (found->second.pos);
+	} else {
+		t1.erase (found->second.pos);
+	}
+	buffered.erase (found);
+}
+
+void MyDB_ARCPolicy :: addGhost (GhostList &toMe, MyDB_PageKey addMe) {
+	removeGhost (toMe, addMe);
+	toMe.where[addMe] = toMe.keys.insert (toMe.keys.end (), addMe);
+}
+
+bool MyDB_ARCPolicy :: removeGhost (GhostList &fromMe, MyDB_PageKey removeMe) {
+
+	auto found = fromMe.where.find (removeMe);
+	if (found == fromMe.where.end ())
+		return false;
+
+	fromMe.keys.erase (found->second);
+	fromMe.where.erase (found);
+	return true;
+}
+
+void MyDB_ARCPolicy :: trimGhosts () {
+
+	while (b1.keys.size () > 0 && t1.size () + b1.keys.size () > capacity) {
+		b1.where.erase (b1.keys.front ());
+		b1.keys.pop_front ();
+	}
+
+	while (b2.keys.size () > 0 && t1.size () + t2.size () + b1.keys.size () + b2.keys.size () > 2 * capacity) {
+		b2.where.erase (b2.keys.front ());
+		b2.keys.pop_front ();
+	}
+}
+
+#endif
+
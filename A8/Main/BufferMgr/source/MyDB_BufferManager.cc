@@ -13,72 +13,325 @@
 #ifndef BUFFER_MGR_C
 #define BUFFER_MGR_C
 
+#include <algorithm>
 #include <fcntl.h>
+#include <fstream>
 #include <iostream>
 #include "MyDB_BufferManager.h"
 #include "MyDB_Page.h"
+#include "MyDB_PageCompressor.h"
+#include <sstream>
+#include <sys/stat.h>
 #include <sys/types.h>
-#include <sys/uio.h>
+#include <time.h>
 #include <unistd.h>
+#include <unordered_set>
 #include <utility>
 
 using namespace std;
 
+// the number of pages in the ring given to a big sequential scan
+#define SCAN_RING_PAGES 8
+
+// how long the background writer sleeps between passes, unless it is woken up
+#define WRITER_NAP_MS 10
+
+// the number of pages that the preload reads in at once
+#define PRELOAD_BATCH 64
+
+// the number of frames that are always kept out of reservations, so that scans, page
+// appends, and the pages that each thread has just accessed have some RAM to use
+#define UNRESERVED_MIN 16
+
+// how long a thread that is asking for a pinned page waits for someone to give back RAM
+// when every frame is in use, before giving up, and how long it naps between tries
+#define RAM_WAIT_MS 5000
+#define RAM_NAP_MS 1
+
 size_t MyDB_BufferManager :: getPageSize () {
 	return pageSize;
 }
 
-MyDB_PageHandle MyDB_BufferManager :: getPage (MyDB_TablePtr whichTable, long i) {
-		
+size_t MyDB_BufferManager :: getNumPages () {
+	return numPages;
+}
+
+size_t MyDB_BufferManager :: reserveFrames (size_t numWanted, size_t numNeeded) {
+
 	Lock temp (getLock ());
 
-	// open the file, if it is not open
-	if (fds.count (whichTable) == 0) {
-		int fd = open (whichTable->getStorageLoc ().c_str (), O_CREAT | O_RDWR, 0666);
-		fds[whichTable] = fd;
+	// a quarter of the buffer (and at least a few frames) is kept out of reservations; in
+	// a tiny buffer, that leaves just one frame that can be reserved
+	size_t numKept = numPages / 4;
+	if (numKept < UNRESERVED_MIN)
+		numKept = UNRESERVED_MIN;
+	if (numKept >= numPages)
+		numKept = numPages - 1;
+	size_t limit = numPages - numKept;
+
+	// the reservations never add up to more than the limit, so an operator that needs
+	// more than what is left waits for the others to give some back
+	if (numNeeded > numWanted)
+		numNeeded = numWanted;
+	if (numNeeded > limit)
+		numNeeded = limit;
+	while (numReserved + numNeeded > limit)
+		pthread_cond_wait (&framesReleased, getLock ());
+
+	// grant whatever we can, up to what was asked for
+	size_t numGranted = limit - numReserved;
+	if (numGranted > numWanted)
+		numGranted = numWanted;
+
+	numReserved += numGranted;
+	return numGranted;
+}
+
+void MyDB_BufferManager :: releaseFrames (size_t numFrames) {
+	Lock temp (getLock ());
+	numReserved -= numFrames;
+	pthread_cond_broadcast (&framesReleased);
+	pthread_cond_broadcast (&ramReleased);
+}
+
+size_t MyDB_BufferManager :: getNumUnreserved () {
+	Lock temp (getLock ());
+	return numReserved < numPages ? numPages - numReserved : 0;
+}
+
+size_t MyDB_BufferManager :: getNumShards () {
+	return shards.size ();
+}
+
+long MyDB_BufferManager :: getHits () {
+	long total = 0;
+	for (MyDB_BufferShard *shard : shards)
+		total += shard->policy->getHits ();
+	return total;
+}
+
+long MyDB_BufferManager :: getMisses () {
+	long total = 0;
+	for (MyDB_BufferShard *shard : shards)
+		total += shard->policy->getMisses ();
+	return total;
+}
+
+MyDB_BufferStats MyDB_BufferManager :: getStats () {
+
+	MyDB_BufferStats returnVal;
+	managerStats.addTo (returnVal);
+	tempStats.addTo (returnVal);
+
+	size_t howMany = numTables.load (memory_order_acquire);
+	for (size_t i = 0; i < howMany; i++)
+		tables[i]->stats.addTo (returnVal);
+
+	return returnVal;
+}
+
+map <string, MyDB_BufferStats> MyDB_BufferManager :: getTableStats () {
+
+	map <string, MyDB_BufferStats> returnVal;
+	tempStats.addTo (returnVal["(temp)"]);
+
+	size_t howMany = numTables.load (memory_order_acquire);
+	for (size_t i = 0; i < howMany; i++)
+		tables[i]->stats.addTo (returnVal[tables[i]->table->getName ()]);
+
+	return returnVal;
+}
+
+string MyDB_BufferManager :: getStatsJSON () {
+
+	ostringstream out;
+	out << "{\"pageSize\": " << pageSize << ", \"numPages\": " << numPages
+		<< ", \"directIO\": " << (directIO ? "true" : "false")
+		<< ", \"total\": " << getStats ().toJSON () << ", \"tables\": {";
+
+	bool first = true;
+	for (auto &table : getTableStats ()) {
+
+		// escape anything in the name that would break the JSON
+		string name;
+		for (char c : table.first) {
+			if (c == '"' || c == '\\')
+				name.push_back ('\\');
+			name.push_back (c);
+		}
+
+		out << (first ? "" : ", ") << "\"" << name << "\": " << table.second.toJSON ();
+		first = false;
 	}
+	out << "}}";
+
+	return out.str ();
+}
+
+size_t MyDB_BufferManager :: shardFor (size_t tableId, size_t i) {
+
+	// consecutive pages of a table go to consecutive shards, so that a scan spreads out
+	return (tableId * 0x9E3779B1UL + i) % shards.size ();
+}
+
+pthread_mutex_t *MyDB_BufferManager :: getShardLock (MyDB_Page &forMe) {
+	return &(shards[forMe.shard]->myLock);
+}
+
+size_t MyDB_BufferManager :: getTableId (MyDB_TablePtr whichTable) {
+
+	// the usual case: this buffer manager was the last one to use the table, so the
+	// id is cached in the table (the top half of the key is the buffer manager's id)
+	long key = whichTable->getBufferKey ();
+	if (key != -1 && (key >> 32) == myId)
+		return key & 0xFFFFFFFFL;
 
+	TimedLock temp (getLock (), managerStats);
+
+	// see if we have seen a table with this name before; if not, give it the next id
+	size_t returnVal;
+	auto found = tableIds.find (whichTable->getName ());
+	if (found != tableIds.end ()) {
+		returnVal = found->second;
+	} else {
+		returnVal = numTables;
+		if (returnVal == MAX_TABLES) {
+			cout << "Too many tables are using the buffer manager!!\n";
+			exit (1);
+		}
+		MyDB_TableInfo *info = new MyDB_TableInfo;
+		info->table = whichTable;
+		info->fd = MyDB_IOBackend :: openFile (whichTable->getStorageLoc (), O_CREAT | O_RDWR, directIO);
+		tables[returnVal] = info;
+		tableIds[whichTable->getName ()] = returnVal;
+		numTables.store (returnVal + 1, memory_order_release);
+	}
+
+	whichTable->setBufferKey ((myId << 32) | returnVal);
+	return returnVal;
+}
+
+MyDB_PageHandle MyDB_BufferManager :: getPage (MyDB_TablePtr whichTable, long i) {
+		
 	// make sure we don't have a null table
 	if (whichTable == nullptr) {
 		cout << "Can't allocate a page with a null table!!\n";
 		exit (1);
 	}
-	
+
+	size_t tableId = getTableId (whichTable);
+	size_t whichShard = shardFor (tableId, i);
+	MyDB_BufferShard &shard = *shards[whichShard];
+
+	TimedLock temp (&shard.myLock, managerStats);
+
 	// next, see if the page is already in existence
-	pair <MyDB_TablePtr, long> whichPage = make_pair (whichTable, i);
-	if (allPages.count (whichPage) == 0) {
+	MyDB_PagePtr *found = shard.allPages.find (tableId, i);
+	if (found == nullptr) {
 
 		// it is not there, so create a page
+		MyDB_TableInfo &info = *tables[tableId];
 		MyDB_PagePtr returnVal = make_shared <MyDB_Page> (whichTable, i, *this);
-		allPages [whichPage] = returnVal;
-		return make_shared <MyDB_PageHandleBase> (returnVal);
+		returnVal->tableId = tableId;
+		returnVal->shard = whichShard;
+		returnVal->fd = info.fd;
+		returnVal->stats = &info.stats;
+		shard.allPages.insert (tableId, i, returnVal);
+		return MyDB_PageHandle (returnVal);
 	}
 
 	// it is there, so return it
-	return make_shared <MyDB_PageHandleBase> (allPages [whichPage]);
+	return MyDB_PageHandle (*found);
 }
 
-MyDB_PageHandle MyDB_BufferManager :: getPage () {
+MyDB_PageHandle MyDB_BufferManager :: getPage (MyDB_TablePtr whichTable, long i, MyDB_ScanRingPtr ring) {
+	MyDB_PageHandle returnVal = getPage (whichTable, i);
+	returnVal->ring = ring;
+	return returnVal;
+}
 
-	Lock temp (getLock ());
+MyDB_ScanRingPtr MyDB_BufferManager :: getScanRing (size_t numPagesToScan) {
+
+	// a scan of less than a quarter of the buffer can just use the buffer
+	if (numPagesToScan * 4 < numPages)
+		return nullptr;
+
+	return make_shared <MyDB_ScanRing> (SCAN_RING_PAGES);
+}
+
+void MyDB_BufferManager :: prefetch (MyDB_PageHandle prefetchMe) {
+	vector <MyDB_PageHandle> prefetchUs {prefetchMe};
+	prefetch (prefetchUs);
+}
 
-	// open the file, if it is not open
-	if (fds.count (nullptr) == 0) {
-		int fd = open (tempFile.c_str (), O_TRUNC | O_CREAT | O_RDWR, 0666);
-		fds[nullptr] = fd;
+void MyDB_BufferManager :: prefetch (vector <MyDB_PageHandle> &prefetchUs) {
+
+	// no need to do anything for the pages that are there (this check is just a hint)
+	vector <MyDB_PageIO> batch;
+	for (MyDB_PageHandle &prefetchMe : prefetchUs) {
+		MyDB_Page *page = prefetchMe->page;
+		if (page->bytes == nullptr)
+			batch.emplace_back (page->fd, nullptr, pageSize, page->pos * pageSize, false);
 	}
 
-	// check if we are extending the size of the temp file
-	size_t pos;
-	if (availablePositions.size () == 0) {
-		pos = lastTempPos++;
+	// have the kernel start reading the pages into its cache, so that the read that
+	// happens when a page is accessed does not have to wait for the disk; with direct
+	// I/O, that would just put a second copy of the pages in the kernel's cache
+	if (batch.size () > 0 && !directIO)
+		io->prefetch (batch);
+}
+
+MyDB_MappedTable *MyDB_BufferManager :: mapTable (MyDB_TablePtr whichTable, MyDB_AccessPattern pattern) {
+
+	// the file has to have the current contents of the table's pages
+	flushAll ();
+
+	Lock temp (getLock ());
+	if (mappedTables.count (whichTable) == 0) {
+		mappedTables[whichTable] = new MyDB_MappedTable (whichTable, pageSize, pattern);
 	} else {
-		pos = availablePositions.top ();
-		availablePositions.pop ();
+		mappedTables[whichTable]->setAccessPattern (pattern);
+	}
+
+	return mappedTables[whichTable];
+}
+
+MyDB_PageHandle MyDB_BufferManager :: getMappedPage (MyDB_MappedTable *whichTable, long i) {
+
+	if (i < 0 || (size_t) i >= whichTable->getNumPages ()) {
+		cout << "Page " << i << " of mapped table " << whichTable->table->getName () << " is past the end of the mapping.\n";
+		exit (1);
 	}
 
+	Lock temp (&whichTable->myLock);
+
+	// the page object is made the first time that the page is asked for
+	MyDB_PagePtr &page = whichTable->pages[i];
+	if (page == nullptr) {
+		page = make_shared <MyDB_Page> (whichTable->table, i, *this);
+		page->bytes = whichTable->getBytes (i);
+		page->numBytes = pageSize;
+		page->mapping = whichTable;
+	}
+
+	return MyDB_PageHandle (page);
+}
+
+MyDB_PageHandle MyDB_BufferManager :: getPage () {
+
+	// the page goes into the calling thread's own temp segment, which is the one that
+	// goes with its pin slot
+	size_t whichSegment = getPinSlot ().whichSlot;
+	MyDB_TempSegment &segment = tempSpace->getSegment (whichSegment);
+	size_t pos = segment.allocate ();
+
 	MyDB_PagePtr returnVal = make_shared <MyDB_Page> (nullptr, pos, *this);
-	return make_shared <MyDB_PageHandleBase> (returnVal);
+	returnVal->shard = (pos + whichSegment) % shards.size ();
+	returnVal->fd = segment.getFd ();
+	returnVal->tempSegment = &segment;
+	returnVal->stats = &tempStats;
+	returnVal->self = returnVal;
+	return MyDB_PageHandle (returnVal);
 }
 
 // this stores the info needed for the buffer manager to start up a thread
@@ -98,48 +351,18 @@ void *startThread (void *arg) {
 void MyDB_BufferManager :: executeThreads (void (*start_routine) (void *), vector <void *> args) {
 
 	// will store all of the threads
-	vector <pthread_t> threads;
-
-	// each thread has one pinned page (the last one executed)... reset this
-	threadPinnedPages.resize (args.size () + 1);
-
-	// each of the threads lacks a thread pinned page
-	for (int i = 0; i < args.size (); i++) {
-		threadPinnedPages[i + 1] = nullptr;
-	}
-
-	// this is the location where each worker is going to have their stack
-	void *origStackBase = malloc (1024 * 1024 * 4 * (args.size () + 2));
+	vector <pthread_t> threads (args.size ());
+	numWorkers = args.size ();
 
-	// align it to 2^22... chop off the last 22 bits, and then add 2^22 to the address
-	stackBase = (void *) (((((size_t) origStackBase) >> 22) << 22) + (1024 * 1024 * 4));
-	void *nextPos  = stackBase;
-	stackEnd = ((char *) stackBase) + 1024 * 1024 * 4 * args.size ();
-
-	// create all of the threads
-	for (auto arg : args) {
-
-		pthread_t thread;
-		threads.push_back(thread);
-
-		// adjust the stack base to align it correctly
-		void *stackBaseIn = (void *) ((((long) nextPos + (PTHREAD_STACK_MIN - 1)) /
-			PTHREAD_STACK_MIN) * PTHREAD_STACK_MIN);
-	
-		// this is the location of the stack base for the next thread
-		nextPos = ((char *) nextPos) + (1024 * 1024 * 4);
-
-		// create a thread
-		pthread_attr_t tattr;
-		pthread_attr_init (&tattr);
-		pthread_attr_setstack (&tattr, stackBaseIn, ((char *) nextPos) - (char *) stackBaseIn);
+	// create all of the threads; each one registers its own pin slot the first time
+	// that it accesses a page
+	for (size_t i = 0; i < args.size (); i++) {
 
 		// this is the data
 		ThreadArg *temp = new ThreadArg;
-		temp->param = arg;
+		temp->param = args[i];
 		temp->start_routine = start_routine;
-		int return_code = pthread_create(&(threads[threads.size() - 1]), &tattr, startThread, temp);
-		pthread_attr_destroy (&tattr);
+		int return_code = pthread_create (&(threads[i]), nullptr, startThread, temp);
 
 		if (return_code) {
 			cout << "ERROR; return code from pthread_create () is " << return_code << '\n';
@@ -147,274 +370,908 @@ void MyDB_BufferManager :: executeThreads (void (*start_routine) (void *), vecto
 		}
 	}
 	
-	// and wait util they all complete
+	// and wait util they all complete; as each one exits, it gives back its pin slot
 	for (auto thread : threads) {
 		pthread_join (thread, nullptr);
 	}	
 
 	// we are no longer in multi-threaded mode
-	stackBase = nullptr;
-
-	// kill the RAM used to start all of the threads
-	free (origStackBase);
-
-	// and make it so that we have no thread pinned pages
-	threadPinnedPages.resize (1);
+	numWorkers = 0;
 }
 
 pthread_mutex_t *MyDB_BufferManager :: getLock () {
 	return &myLock;
 }
 
+// the next id to give to a buffer manager
+static atomic <long> nextMgrId (0);
+
+// the pin slots that a thread has been given, one for each buffer manager that it has
+// used; when the thread exits, it gives all of them back
+struct MyDB_ThreadPins {
+
+	vector <pair <long, MyDB_PinSlotPtr>> slots;
+
+	~MyDB_ThreadPins () {
+		for (auto &slot : slots) {
+			slot.second->clear ();
+			slot.second->inUse = false;
+		}
+	}
+};
+
+static thread_local MyDB_ThreadPins threadPins;
+
+// the pin slot that the thread looked up last, and the id of the buffer manager it came from
+static thread_local long lastMgrId = -1;
+static thread_local MyDB_PinSlot *lastPinSlot = nullptr;
+
+MyDB_PinSlot &MyDB_BufferManager :: getPinSlot () {
+
+	// the usual case: the thread is using the same buffer manager as last time
+	if (lastMgrId == myId)
+		return *lastPinSlot;
+
+	// look through the thread's slots, dropping any from buffer managers that are gone
+	MyDB_PinSlotPtr found;
+	vector <pair <long, MyDB_PinSlotPtr>> &slots = threadPins.slots;
+	for (size_t i = 0; i < slots.size (); ) {
+		if (slots[i].second->retired) {
+			slots[i] = slots.back ();
+			slots.pop_back ();
+			continue;
+		}
+		if (slots[i].first == myId)
+			found = slots[i].second;
+		i++;
+	}
+
+	// this is the first time that the thread has used this buffer manager, so give it a
+	// slot; if some thread that is gone has given one back, use that
+	if (found == nullptr) {
+
+		Lock temp (getLock ());
+		for (size_t i = 0; i < numPinSlots; i++) {
+			bool notInUse = false;
+			if (pinSlots[i]->inUse.compare_exchange_strong (notInUse, true)) {
+				found = pinSlots[i];
+				break;
+			}
+		}
+
+		if (found == nullptr) {
+			if (numPinSlots == MAX_PIN_SLOTS) {
+				cout << "Too many threads are using the buffer manager!!\n";
+				exit (1);
+			}
+			found = make_shared <MyDB_PinSlot> (numPinSlots);
+			pinSlots[numPinSlots] = found;
+			numPinSlots.store (numPinSlots + 1, memory_order_release);
+		}
+
+		slots.push_back (make_pair (myId, found));
+	}
+
+	lastMgrId = myId;
+	lastPinSlot = found.get ();
+	return *found;
+}
+
 bool MyDB_BufferManager :: checkCannotExpell (void *checkMe) {
-	for (void *temp : threadPinnedPages) {
-		if (checkMe == temp)
+	size_t numSlots = numPinSlots.load (memory_order_acquire);
+	for (size_t i = 0; i < numSlots; i++) {
+		if (pinSlots[i]->has (checkMe))
 			return true;
 	}
 	return false;
 }
 
-bool MyDB_BufferManager :: checkIfThreadPinned (void *checkMe) {
-
-	// this serves to gives us the location of our call stack
-        int i;
-
-	// if we are not in one of the created worker threads, then we put this at the end of the list
-	if (stackBase == nullptr || !(((char *) &i) >= (char *) stackBase && ((char *) &i) < (char *) stackEnd)) {
-		return threadPinnedPages[0] == checkMe;
+void MyDB_BufferManager :: clearCannotExpell (void *clearMe) {
+	size_t numSlots = numPinSlots.load (memory_order_acquire);
+	for (size_t i = 0; i < numSlots; i++) {
+		pinSlots[i]->release (clearMe);
 	}
+}
 
-	// we are one of the worker threads... so see how many size 2^22 segments we are from the base of the call stack
-	size_t temp = (size_t) ((char *) &i - (char *) stackBase);
-	return threadPinnedPages[1 + (temp >> 22)] == checkMe;
+bool MyDB_BufferManager :: checkIfThreadPinned (void *checkMe) {
+	return getPinSlot ().touch (checkMe);
 }
 	
 void MyDB_BufferManager :: setCannotExpell (void *setMe) {
+	getPinSlot ().add (setMe);
+}
+
+bool MyDB_BufferManager :: kickOutPage (MyDB_BufferShard &shard, vector <MyDB_PagePtr> &writeUs) {
+	
+	// if the background writer is running, first try to find a clean page, so that
+	// we do not have to wait for a write
+	MyDB_PagePtr page;
+	if (writerRunning) {
+		page = shard.policy->victim ([this] (MyDB_PagePtr &candidate) {
+			return !candidate->isDirty && !candidate->ioPending && !candidate->writePending &&
+				!checkCannotExpell (candidate->bytes);
+		});
+	}
 
-	// this serves to gives us the location of our call stack
-        int i;
+	// ask the policy for a page that can be expelled
+	if (page == nullptr) {
+		page = shard.policy->victim ([this] (MyDB_PagePtr &candidate) {
+			return !candidate->ioPending && !candidate->writePending && !checkCannotExpell (candidate->bytes);
+		});
 
-	// if we are not in one of the created worker threads, then we put this at the end of the list
-	if (stackBase == nullptr || !(((char *) &i) >= (char *) stackBase && ((char *) &i) < (char *) stackEnd)) {
-		threadPinnedPages[0] = setMe;
-		return;
+		// the writer is falling behind, so get it going
+		if (page != nullptr && page->isDirty && writerRunning)
+			pthread_cond_signal (&wakeWriter);
 	}
 
-	// we are one of the worker threads... so see how many size 2^22 segments we are from the base of the call stack
-	size_t temp = (size_t) ((char *) &i - (char *) stackBase);
-	threadPinnedPages[1 + (temp >> 22)] = setMe;
+	// everyone in this shard is pinned
+	if (page == nullptr)
+		return false;
+
+	// a dirty temp page that is going to be compressed is not compressed while holding
+	// the latch; it is handed back to be written out, and is evicted once it is clean
+	if (page->isDirty && compressTemp && page->myTable == nullptr && pageSize > DIRECT_IO_ALIGNMENT) {
+		page->writePending = true;
+		page->isDirty = false;
+		writeUs.push_back (page);
+		return false;
+	}
+
+	// remember its RAM
+	shard.availableRam.push_back (evictPage (shard, page));
+	return true;
 }
 
-void MyDB_BufferManager :: kickOutPage () {
-	
-	if (lastUsed.size () == 0)
-		cout << "Bad: all buffer memory is exhausted!";
+// a temp page that is compressed is written and read in units of this many bytes
+static inline size_t compressedIOSize (size_t numBytes) {
+	return ((numBytes + DIRECT_IO_ALIGNMENT - 1) / DIRECT_IO_ALIGNMENT) * DIRECT_IO_ALIGNMENT;
+}
 
-	// find the oldest page
-	auto it = lastUsed.begin();
+// a thread's scratch RAM for compressing and decompressing temp pages; it is aligned,
+// so that it can be used for direct I/O
+struct MyDB_ScratchPage {
 
-	// and now find the oldest page that can be expelled
-	while (true) {
-		auto &page = *it;
-		if (!checkCannotExpell (page->bytes))
-			break;
-		it++;
+	void *bytes = nullptr;
+	size_t numBytes = 0;
+
+	void *get (size_t numBytesWanted) {
+		if (numBytes < numBytesWanted) {
+			free (bytes);
+			if (posix_memalign (&bytes, DIRECT_IO_ALIGNMENT, numBytesWanted) != 0) {
+				cout << "Can't get scratch RAM for a compressed page!!\n";
+				exit (1);
+			}
+			numBytes = numBytesWanted;
+		}
+		return bytes;
 	}
-	auto page = *it;
 
-	// write it back if necessary
+	~MyDB_ScratchPage () {
+		free (bytes);
+	}
+};
+
+static thread_local MyDB_ScratchPage scratchPage;
+
+void MyDB_BufferManager :: setCompressTempPages (bool compress) {
+	compressTemp = compress;
+}
+
+size_t MyDB_BufferManager :: compressPage (MyDB_Page &compressMe, void *compressed) {
+
+	if (compressed == nullptr || compressMe.myTable != nullptr || pageSize <= DIRECT_IO_ALIGNMENT)
+		return 0;
+
+	// it is only worth it if the write gets at least one unit smaller
+	return MyDB_PageCompressor :: compress (compressMe.bytes, pageSize, compressed, pageSize - DIRECT_IO_ALIGNMENT);
+}
+
+void *MyDB_BufferManager :: evictPage (MyDB_BufferShard &shard, MyDB_PagePtr page) {
+
+	// write it back if necessary; pages that are compressed are written by writeBack,
+	// so this one is written out whole
 	if (page->isDirty) {
-		lseek (fds[page->myTable], page->pos * pageSize, SEEK_SET);
-		write (fds[page->myTable], page->bytes, pageSize);
+		long start = nowNanos ();
+		io->write (page->fd, page->bytes, pageSize, page->pos * pageSize);
+		page->stats->writes.record (nowNanos () - start);
+		page->stats->writeBacks.fetch_add (1, memory_order_relaxed);
+		page->stats->bytesWritten.fetch_add (pageSize, memory_order_relaxed);
+		page->spillBytes = 0;
 		page->isDirty = false;
 	}
 
 	// remove it
-	lastUsed.erase (page);
-
-	// remember its RAM
-	availableRam.push_back (page->bytes);
+	shard.policy->evict (page);
+	page->stats->evictions.fetch_add (1, memory_order_relaxed);
+	void *returnVal = page->bytes;
 	page->bytes = nullptr;
+	page->scanRing = nullptr;
+	clearCannotExpell (returnVal);
 
 	// if this guy has no references, kill him
 	if (page->refCount == 0)
 		killPage (page);
+
+	return returnVal;
+}
+
+void *MyDB_BufferManager :: getRingRam (MyDB_ScanRing &ring) {
+
+	// go through the oldest pages in the ring until we find one we can recycle
+	while (ring.pages.size () >= ring.maxPages) {
+
+		MyDB_PagePtr page = ring.pages.front ();
+		ring.pages.pop_front ();
+
+		MyDB_BufferShard &shard = *shards[page->shard];
+		TimedLock temp (&shard.myLock, managerStats);
+
+		// skip the page if it has been adopted (or pinned) by someone else, if it is
+		// already gone, or if another thread is using it
+		if (page->scanRing != &ring || page->bytes == nullptr || page->ioPending || page->writePending ||
+			checkCannotExpell (page->bytes))
+			continue;
+
+		return evictPage (shard, page);
+	}
+
+	return nullptr;
+}
+
+void *MyDB_BufferManager :: getRam (size_t whichShard) {
+
+	// start with our own shard, and then go looking at the others
+	vector <MyDB_PagePtr> writeUs;
+	for (size_t i = 0; i < shards.size ();) {
+
+		MyDB_BufferShard &shard = *shards[(whichShard + i) % shards.size ()];
+		{
+			TimedLock temp (&shard.myLock, managerStats);
+
+			// see if there is space; if not, make some
+			if (shard.availableRam.size () != 0 || kickOutPage (shard, writeUs)) {
+				void *returnVal = shard.availableRam.back ();
+				shard.availableRam.pop_back ();
+				return returnVal;
+			}
+		}
+
+		// the victim has to be compressed and written first, which is done without the
+		// latch; then the shard is tried again
+		if (writeUs.size () != 0) {
+			writeBack (writeUs);
+			writeUs.clear ();
+		} else {
+			i++;
+		}
+	}
+
+	return nullptr;
+}
+
+void *MyDB_BufferManager :: getRamOrWait (size_t whichShard, bool waitForever) {
+
+	void *ram = getRam (whichShard);
+	long giveUpAt = nowNanos () + RAM_WAIT_MS * 1000000L;
+	while (ram == nullptr && (waitForever || nowNanos () < giveUpAt)) {
+
+		// every frame is pinned, either by an operator or by a thread that just used it;
+		// another thread is usually about to give one back, so wait for that.  The wait
+		// is a short nap, since a frame can be given back without holding myLock
+		{
+			Lock temp (getLock ());
+			struct timespec wakeUpAt;
+			clock_gettime (CLOCK_REALTIME, &wakeUpAt);
+			wakeUpAt.tv_nsec += RAM_NAP_MS * 1000000L;
+			if (wakeUpAt.tv_nsec >= 1000000000L) {
+				wakeUpAt.tv_sec++;
+				wakeUpAt.tv_nsec -= 1000000000L;
+			}
+			pthread_cond_timedwait (&ramReleased, getLock (), &wakeUpAt);
+		}
+
+		ram = getRam (whichShard);
+	}
+
+	return ram;
 }
 
 void MyDB_BufferManager :: killPage (MyDB_PagePtr killMe) {
 
+	MyDB_BufferShard &shard = *shards[killMe->shard];
+
+	// if this is an anon page that is being written out, then he has to stay around
+	// until the write is done
+	if (killMe->myTable == nullptr && killMe->writePending) {
+		killMe->killWhenWritten = true;
+
 	// if this is an anon page...
-	if (killMe->myTable == nullptr) {
+	} else if (killMe->myTable == nullptr) {
+
+		// recycle his position
+		killMe->tempSegment->release (killMe->pos);
 
-		// recycle him
-		availablePositions.push (killMe->pos);
 		if (killMe->bytes != nullptr) {
-			availableRam.push_back (killMe->bytes);
+			clearCannotExpell (killMe->bytes);
+			shard.availableRam.push_back (killMe->bytes);
+			pthread_cond_broadcast (&ramReleased);
 		}
 
-		// if he is in the LRU list, remove him
-		if (lastUsed.count (killMe) != 0) {
-			auto page = *(lastUsed.find (killMe));
-			lastUsed.erase (page);
-		}
+		// the replacement policy should forget about him
+		shard.policy->forget (killMe);
+
+		// and he no longer needs to keep himself around
+		killMe->self = nullptr;
 
 	// if this is a pinned, non-anon page whose data is buffered it converts...
-	} else if (lastUsed.count (killMe) == 0 && killMe->bytes != nullptr) {
-		killMe->timeTick = ++lastTimeTick;
-		lastUsed.insert (killMe);
+	} else if (killMe->bytes != nullptr) {
+		shard.policy->unpin (killMe);
 
 	// this guy has no data, so just kill him
 	} else if (killMe->bytes == nullptr) {
-		pair <MyDB_TablePtr, long> whichPage = make_pair (killMe->myTable, killMe->pos);
-		allPages.erase (whichPage);
+		shard.allPages.erase (killMe->tableId, killMe->pos);
 	}
 }
 
-// idea: when I access a page, I check to make sure that it is the same page as last time
-void MyDB_BufferManager :: access (MyDB_PagePtr updateMe) {
-	
-	// if this page was just accessed, get outta here
-	if (updateMe->timeTick > lastTimeTick - (numPages / 2) && updateMe->bytes != nullptr) {
+void MyDB_BufferManager :: writeBack (vector <MyDB_PagePtr> &writeUs) {
 
-		// if this thread has already pinned this page by access it, then we are good
-		if (checkIfThreadPinned (updateMe->bytes)) {
-			return;
+	if (writeUs.size () == 0)
+		return;
+
+	// the pages cannot lose their RAM while the write is pending, so we can write them
+	// without holding any latch (if someone changes a page in the meantime, it will just
+	// be dirty again)
+	// temp pages that are being compressed are compressed into a block of scratch RAM,
+	// with room for each of them
+	char *compressed = nullptr;
+	if (compressTemp) {
+		size_t numTemp = 0;
+		for (MyDB_PagePtr &page : writeUs)
+			numTemp += (page->myTable == nullptr);
+		if (numTemp > 0)
+			compressed = (char *) scratchPage.get (pageSize * numTemp);
+	}
 
-		// otherwise, we mark this page as thread pinned
+	vector <MyDB_PageIO> batch;
+	vector <size_t> spillBytes;
+	for (MyDB_PagePtr &page : writeUs) {
+		spillBytes.push_back (compressPage (*page, compressed));
+		if (spillBytes.back () == 0) {
+			batch.emplace_back (page->fd, page->bytes, pageSize, page->pos * pageSize, true);
 		} else {
-			Lock temp (getLock ());
-			if (updateMe->bytes != nullptr) {
-				setCannotExpell (updateMe->bytes);
-				return;
+			batch.emplace_back (page->fd, compressed, compressedIOSize (spillBytes.back ()), page->pos * pageSize, true);
+			compressed += pageSize;
+		}
+	}
+	long start = nowNanos ();
+	io->submit (batch);
+	long took = nowNanos () - start;
+
+	for (size_t i = 0; i < writeUs.size (); i++) {
+		MyDB_PagePtr &page = writeUs[i];
+		page->stats->writes.record (took);
+		page->stats->writeBacks.fetch_add (1, memory_order_relaxed);
+		page->stats->bytesWritten.fetch_add (batch[i].numBytes, memory_order_relaxed);
+		TimedLock temp (getShardLock (*page), managerStats);
+		page->spillBytes = spillBytes[i];
+		page->writePending = false;
+		if (page->killWhenWritten) {
+			page->killWhenWritten = false;
+			killPage (page);
+		}
+	}
+}
+
+void MyDB_BufferManager :: cleanColdPages () {
+
+	Lock flushing (&flushLock);
+
+	// find the dirty pages that are going to be evicted soon
+	vector <MyDB_PagePtr> writeUs;
+	for (MyDB_BufferShard *shard : shards) {
+		TimedLock temp (&shard->myLock, managerStats);
+		for (MyDB_PagePtr &page : shard->policy->coldPages (numToKeepClean)) {
+			if (page->bytes != nullptr && page->isDirty && !page->ioPending && !page->writePending) {
+				page->writePending = true;
+				page->isDirty = false;
+				writeUs.push_back (page);
 			}
 		}
 	}
 
-	{
-		Lock temp (getLock ());
+	writeBack (writeUs);
+}
 
-		// first, see if it is currently in the LRU list; if it is, update it
-		if (lastUsed.count (updateMe) == 1) {
+void MyDB_BufferManager :: flushAll () {
 
-			// update the LRU value
-			auto page = *(lastUsed.find (updateMe));
-			lastUsed.erase (page);
-			updateMe->timeTick = ++lastTimeTick;
-			lastUsed.insert (updateMe);
+	Lock flushing (&flushLock);
 
-			// and mark this page as thread pinned
-			setCannotExpell (updateMe->bytes);
+	// find all of the dirty pages, pinned or not
+	vector <MyDB_PagePtr> writeUs;
+	for (MyDB_BufferShard *shard : shards) {
+		TimedLock temp (&shard->myLock, managerStats);
+		shard->allPages.forEach ([&] (MyDB_PagePtr &page) {
+			if (page->bytes != nullptr && page->isDirty && !page->ioPending) {
+				page->writePending = true;
+				page->isDirty = false;
+				writeUs.push_back (page);
+			}
+		});
+	}
 
-			return;
-		} 
+	writeBack (writeUs);
+}
+
+void *MyDB_BufferManager :: runWriter (void *me) {
+
+	MyDB_BufferManager &bufferMgr = *((MyDB_BufferManager *) me);
+	while (true) {
+
+		// take a nap, unless someone wakes us up
+		{
+			Lock temp (bufferMgr.getLock ());
+			if (bufferMgr.stopWriter)
+				return nullptr;
+
+			struct timespec wakeUpAt;
+			clock_gettime (CLOCK_REALTIME, &wakeUpAt);
+			wakeUpAt.tv_nsec += WRITER_NAP_MS * 1000000L;
+			if (wakeUpAt.tv_nsec >= 1000000000L) {
+				wakeUpAt.tv_sec++;
+				wakeUpAt.tv_nsec -= 1000000000L;
+			}
+			pthread_cond_timedwait (&bufferMgr.wakeWriter, bufferMgr.getLock (), &wakeUpAt);
+
+			if (bufferMgr.stopWriter)
+				return nullptr;
+		}
+
+		bufferMgr.cleanColdPages ();
 	}
+}
 
-	// the file descriptor to read from
-	int fd;
+void MyDB_BufferManager :: startWriter (size_t numToKeepCleanIn) {
 
-	{
-		Lock temp (getLock ());
+	if (writerRunning)
+		return;
 
-		// not in the LRU list means that we don't have its contents buffered
-		// see if there is space
-		if (availableRam.size () == 0)
-			kickOutPage ();
+	// by default, keep a quarter of each shard clean
+	numToKeepClean = numToKeepCleanIn;
+	if (numToKeepClean == 0)
+		numToKeepClean = (numPages / shards.size () + 3) / 4;
 
-		// if there is no space, we cannot do anything
-		if (availableRam.size () == 0) {
-			cout << "Can't get any RAM to read a page!!\n";
-			exit (1);
+	int return_code = pthread_create (&writerThread, nullptr, runWriter, this);
+	if (return_code) {
+		cout << "ERROR; return code from pthread_create () is " << return_code << '\n';
+		exit (-1);
+	}
+	writerRunning = true;
+}
+
+// the size and the modification time of a file, written out as text; this is used to
+// tell if the file has been changed
+static string fileStamp (string fName) {
+	struct stat fileInfo;
+	if (stat (fName.c_str (), &fileInfo) == -1)
+		return "missing";
+
+	ostringstream stamp;
+	stamp << fileInfo.st_size << " " << fileInfo.st_mtim.tv_sec << " " << fileInfo.st_mtim.tv_nsec;
+	return stamp.str ();
+}
+
+void MyDB_BufferManager :: setManifest (string manifestFileIn) {
+	manifestFile = manifestFileIn;
+}
+
+void MyDB_BufferManager :: writeManifest () {
+
+	// get the buffered table pages in each shard, the hottest first; the pages that are
+	// pinned are not known to the replacement policy, but they are in use, so they go first
+	vector <vector <MyDB_PagePtr>> byShard;
+	for (MyDB_BufferShard *shard : shards) {
+
+		Lock temp (&shard->myLock);
+		vector <MyDB_PagePtr> hot = shard->policy->hotPages ();
+		unordered_set <MyDB_Page *> listed;
+		for (MyDB_PagePtr &page : hot)
+			listed.insert (page.get ());
+
+		vector <MyDB_PagePtr> resident;
+		shard->allPages.forEach ([&] (MyDB_PagePtr &page) {
+			if (page->bytes != nullptr && listed.count (page.get ()) == 0)
+				resident.push_back (page);
+		});
+		for (MyDB_PagePtr &page : hot) {
+			if (page->myTable != nullptr && page->bytes != nullptr)
+				resident.push_back (page);
 		}
 
-		// get some RAM for the page
-		updateMe->bytes = availableRam[availableRam.size () - 1]; 
-		setCannotExpell (updateMe->bytes);
-		updateMe->numBytes = pageSize;
-		availableRam.pop_back ();
+		byShard.push_back (resident);
+	}
 
-		// note that the page is now thread pinned
-		setCannotExpell (updateMe->bytes);
+	// the policies cannot compare pages in different shards, so the shards are interleaved
+	vector <MyDB_TablePtr> tableNames;
+	map <string, size_t> tableIds;
+	vector <pair <size_t, size_t>> pages;
+	for (size_t rank = 0; true; rank++) {
+
+		bool any = false;
+		for (vector <MyDB_PagePtr> &shardPages : byShard) {
+			if (rank >= shardPages.size ())
+				continue;
+			any = true;
+
+			MyDB_PagePtr &page = shardPages[rank];
+			string &name = page->myTable->getName ();
+			if (tableIds.count (name) == 0) {
+				tableIds[name] = tableNames.size ();
+				tableNames.push_back (page->myTable);
+			}
+			pages.push_back (make_pair (tableIds[name], page->pos));
+		}
 
-		// change the LRU info
-		updateMe->timeTick = ++lastTimeTick;
-		lastUsed.insert (updateMe);
+		if (!any)
+			break;
+	}
 
-		fd = fds[updateMe->myTable];
+	// the manifest lists the tables (along with the size and the modification time of each
+	// table's file), and then the pages, using the position of each page's table in the list
+	ofstream out (manifestFile, ofstream :: out | ofstream :: trunc);
+	if (!out.is_open ()) {
+		cout << "Could not write the buffer manifest " << manifestFile << "\n";
+		return;
 	}
 
-	// and read it
-	lseek (fd, updateMe->pos * pageSize, SEEK_SET);
-	read (fd, updateMe->bytes, pageSize);
+	out << "MyDB_manifest2 " << tableNames.size () << " " << pages.size () << "\n";
+	for (MyDB_TablePtr &table : tableNames)
+		out << table->getName () << " " << fileStamp (table->getStorageLoc ()) << "\n";
+	for (auto &page : pages)
+		out << page.first << " " << page.second << "\n";
 }
 
-MyDB_PageHandle MyDB_BufferManager :: getPinnedPage (MyDB_TablePtr whichTable, long i) {
+void MyDB_BufferManager :: startPreload (map <string, MyDB_TablePtr> &allTables) {
 
-	int fdToRead = -1;	
-	MyDB_PagePtr returnVal;
+	if (preloadRunning || manifestFile == "")
+		return;
 
-	{
-		Lock temp (getLock ());
+	ifstream in (manifestFile);
+	string header;
+	size_t numNames, numToLoad;
+	if (!(in >> header >> numNames >> numToLoad) || header != "MyDB_manifest2")
+		return;
 
-		// open the file, if it is not open
-		if (fds.count (whichTable) == 0) {
-			int fd = open (whichTable->getStorageLoc ().c_str (), O_CREAT | O_RDWR, 0666);
-			fds[whichTable] = fd;
+	// find the tables that are still around; if any of their files has been changed since
+	// the manifest was written, the pages listed may not be the hot ones (or may not even
+	// be the same pages), so the whole manifest is ignored
+	vector <MyDB_TablePtr> named;
+	for (size_t i = 0; i < numNames; i++) {
+		string name, stamp;
+		in >> name;
+		getline (in, stamp);
+		named.push_back (allTables.count (name) == 0 ? nullptr : allTables[name]);
+		if (named.back () != nullptr && " " + fileStamp (named.back ()->getStorageLoc ()) != stamp)
+			return;
+	}
+
+	// and get the list of pages, skipping any that are not in one of the tables; there is
+	// no point in reading more than fit
+	toPreload.clear ();
+	size_t whichTable;
+	long pos;
+	while (toPreload.size () < numPages && in >> whichTable >> pos) {
+		if (whichTable < named.size () && named[whichTable] != nullptr && pos >= 0 &&
+			pos <= named[whichTable]->lastPage ())
+			toPreload.push_back (make_pair (named[whichTable], pos));
+	}
+
+	if (toPreload.size () == 0)
+		return;
+
+	stopPreload = false;
+	int return_code = pthread_create (&preloadThread, nullptr, runPreload, this);
+	if (return_code) {
+		cout << "ERROR; return code from pthread_create () is " << return_code << '\n';
+		exit (-1);
+	}
+	preloadRunning = true;
+}
+
+void MyDB_BufferManager :: waitForPreload () {
+	if (preloadRunning) {
+		pthread_join (preloadThread, nullptr);
+		preloadRunning = false;
+	}
+}
+
+void *MyDB_BufferManager :: runPreload (void *me) {
+
+	MyDB_BufferManager &bufferMgr = *((MyDB_BufferManager *) me);
+	vector <pair <MyDB_TablePtr, long>> &toPreload = bufferMgr.toPreload;
+
+	// go through the pages, the hottest first, a batch at a time
+	for (size_t first = 0; first < toPreload.size () && !bufferMgr.stopPreload; first += PRELOAD_BATCH) {
+
+		size_t last = first + PRELOAD_BATCH;
+		if (last > toPreload.size ())
+			last = toPreload.size ();
+		vector <pair <MyDB_TablePtr, long>> batch (toPreload.begin () + first, toPreload.begin () + last);
+
+		// put the batch in file order, so that the reads are sequential
+		sort (batch.begin (), batch.end (), [] (const pair <MyDB_TablePtr, long> &lhs,
+			const pair <MyDB_TablePtr, long> &rhs) {
+			return lhs.first->getName () < rhs.first->getName () ||
+				(lhs.first->getName () == rhs.first->getName () && lhs.second < rhs.second);
+		});
+
+		if (!bufferMgr.preloadBatch (batch))
+			break;
+	}
+
+	return nullptr;
+}
+
+void *MyDB_BufferManager :: getFreeRam (size_t whichShard) {
+
+	for (size_t i = 0; i < shards.size (); i++) {
+
+		MyDB_BufferShard &shard = *shards[(whichShard + i) % shards.size ()];
+		TimedLock temp (&shard.myLock, managerStats);
+		if (shard.availableRam.size () == 0)
+			continue;
+
+		void *returnVal = shard.availableRam.back ();
+		shard.availableRam.pop_back ();
+		return returnVal;
+	}
+
+	return nullptr;
+}
+
+bool MyDB_BufferManager :: preloadBatch (vector <pair <MyDB_TablePtr, long>> &loadUs) {
+
+	// the handles keep the pages around until they are read in
+	vector <MyDB_PageHandle> handles;
+	vector <MyDB_PageIO> reads;
+	bool outOfRam = false;
+	for (auto &loadMe : loadUs) {
+
+		MyDB_PageHandle handle = getPage (loadMe.first, loadMe.second);
+		MyDB_Page &page = *handle->page;
+		void *ram = getFreeRam (page.shard);
+		if (ram == nullptr) {
+			outOfRam = true;
+			break;
 		}
-	
-		// make sure we don't have a null table
-		if (whichTable == nullptr) {
-			cout << "Can't allocate a page with a null table!!\n";
-			exit (1);
+
+		// set the page up for a read, just like access () does on a miss, unless someone
+		// else got to the page first
+		MyDB_BufferShard &shard = *shards[page.shard];
+		TimedLock temp (&shard.myLock, managerStats);
+		if (page.bytes != nullptr || page.ioPending) {
+			shard.availableRam.push_back (ram);
+			continue;
 		}
 
-		// first, see if the page is there in the buffer
-		pair <MyDB_TablePtr, long> whichPage = make_pair (whichTable, i);
+		MyDB_PagePtr pagePtr = page.shared_from_this ();
+		page.bytes = ram;
+		page.numBytes = pageSize;
+		page.ioPending = true;
+		shard.policy->admit (pagePtr);
+		shard.policy->unpin (pagePtr);
+		reads.emplace_back (page.fd, page.bytes, pageSize, page.pos * pageSize, false);
+		handles.push_back (handle);
+	}
 
-		// see if we already know him
-		if (allPages.count (whichPage) == 0) {
+	// do all of the reads at once
+	long start = nowNanos ();
+	io->submit (reads);
+	long took = nowNanos () - start;
 
-			// in this case, we do not
-			returnVal = make_shared <MyDB_Page> (whichTable, i, *this);
-			allPages [whichPage] = returnVal;
+	for (MyDB_PageHandle &handle : handles) {
+		MyDB_Page &page = *handle->page;
+		page.stats->reads.record (took);
+		page.stats->bytesRead.fetch_add (pageSize, memory_order_relaxed);
 
-		// in this case, we do
-		} else {
+		MyDB_BufferShard &shard = *shards[page.shard];
+		TimedLock temp (&shard.myLock, managerStats);
+		page.ioPending = false;
+		pthread_cond_broadcast (&shard.ioDone);
+	}
+
+	return !outOfRam;
+}
+
+void MyDB_BufferManager :: waitForRead (MyDB_BufferShard &shard, MyDB_PagePtr waitForMe) {
+	while (waitForMe->ioPending) {
+		pthread_cond_wait (&shard.ioDone, &shard.myLock);
+	}
+}
+
+void MyDB_BufferManager :: readPage (MyDB_PagePtr readMe) {
+
+	// the page has RAM and is marked as pending, so no one else will touch the bytes
+	long start = nowNanos ();
+	if (readMe->spillBytes == 0) {
+		io->read (readMe->fd, readMe->bytes, pageSize, readMe->pos * pageSize);
+		readMe->stats->bytesRead.fetch_add (pageSize, memory_order_relaxed);
+
+	// the page was written out compressed
+	} else {
+		size_t numBytes = compressedIOSize (readMe->spillBytes);
+		void *compressed = scratchPage.get (pageSize);
+		io->read (readMe->fd, compressed, numBytes, readMe->pos * pageSize);
+		if (!MyDB_PageCompressor :: decompress (compressed, readMe->spillBytes, readMe->bytes, pageSize)) {
+			cout << "A compressed temp page is corrupt!!\n";
+			exit (1);
+		}
+		readMe->stats->bytesRead.fetch_add (numBytes, memory_order_relaxed);
+	}
+	readMe->stats->reads.record (nowNanos () - start);
+
+	MyDB_BufferShard &shard = *shards[readMe->shard];
+	TimedLock temp (&shard.myLock, managerStats);
+	readMe->ioPending = false;
+	pthread_cond_broadcast (&shard.ioDone);
+}
+
+// idea: when I access a page, I check to make sure that it is the same page as last time
+void MyDB_BufferManager :: access (MyDB_Page &page, MyDB_ScanRing *ring) {
+
+	// the page of a mapped table is always there
+	if (page.mapping != nullptr)
+		return;
 	
-			// get him out of the LRU list if he is there
-			returnVal = allPages [whichPage];
-			if (lastUsed.count (returnVal) != 0) {
-				auto page = *(lastUsed.find (returnVal));
-		       		lastUsed.erase (page);
+	// if this page was just accessed by this thread, then it is buffered and all we need
+	// to do is to set the reference bit
+	if (page.bytes != nullptr && checkIfThreadPinned (page.bytes)) {
+		shards[page.shard]->policy->referenceUnlatched (page);
+		return;
+	}
+
+	// the caller has a handle, so the page is not going anywhere
+	MyDB_PagePtr updateMe = page.shared_from_this ();
+
+	MyDB_BufferShard &shard = *shards[updateMe->shard];
+	void *ram = nullptr;
+
+	while (true) {
+
+		{
+			TimedLock temp (&shard.myLock, managerStats);
+			waitForRead (shard, updateMe);
+
+			// the page is buffered (possibly because another thread just read it in)
+			if (updateMe->bytes != nullptr) {
+
+				// give back any RAM we grabbed
+				if (ram != nullptr)
+					shard.availableRam.push_back (ram);
+
+				// let the policy know; unlike the fast path above, this is done under the
+				// latch, since the page is not sure to stay buffered until it is thread pinned
+				shard.policy->hit (updateMe);
+				updateMe->stats->hits.fetch_add (1, memory_order_relaxed);
+
+				// if someone other than the scan that read the page in is using it,
+				// then the page no longer belongs to the scan
+				if (updateMe->scanRing != ring)
+					updateMe->scanRing = nullptr;
+
+				// and mark this page as thread pinned
+				setCannotExpell (updateMe->bytes);
+				return;
+			}
+
+			// we have RAM, so we can buffer the page
+			if (ram != nullptr) {
+				updateMe->bytes = ram; 
+				updateMe->numBytes = pageSize;
+				updateMe->ioPending = true;
+				updateMe->scanRing = ring;
+
+				// note that the page is now thread pinned
+				setCannotExpell (updateMe->bytes);
+
+				// and let the policy know; the page is not pinned
+				shard.policy->miss (updateMe);
+				updateMe->stats->misses.fetch_add (1, memory_order_relaxed);
+				shard.policy->unpin (updateMe);
+				break;
 			}
 		}
 
-		// see if we need to get his data
-		if (returnVal->bytes == nullptr) {
+		// not buffered; find some RAM for the page without holding our latch... a scan
+		// first tries to recycle a page from its ring
+		if (ring != nullptr)
+			ram = getRingRam (*ring);
+		// an access cannot fail, so if every frame is pinned, this waits until one is not
+		if (ram == nullptr)
+			ram = getRamOrWait (updateMe->shard, true);
+	}
+
+	// and read it
+	readPage (updateMe);
+	if (ring != nullptr)
+		ring->pages.push_back (updateMe);
+}
+
+MyDB_PageHandle MyDB_BufferManager :: getPinnedPage (MyDB_TablePtr whichTable, long i) {
+
+	// make sure we don't have a null table
+	if (whichTable == nullptr) {
+		cout << "Can't allocate a page with a null table!!\n";
+		exit (1);
+	}
+
+	size_t tableId = getTableId (whichTable);
+	size_t whichShard = shardFor (tableId, i);
+	MyDB_BufferShard &shard = *shards[whichShard];
+	MyDB_PagePtr returnVal;
+	MyDB_PageHandle returnHandle;
+	void *ram = nullptr;
+
+	while (true) {
+
+		{
+			TimedLock temp (&shard.myLock, managerStats);
+
+			// see if we already know him
+			MyDB_PagePtr *found = shard.allPages.find (tableId, i);
+			if (found == nullptr) {
+
+				// in this case, we do not
+				MyDB_TableInfo &info = *tables[tableId];
+				returnVal = make_shared <MyDB_Page> (whichTable, i, *this);
+				returnVal->tableId = tableId;
+				returnVal->shard = whichShard;
+				returnVal->fd = info.fd;
+				returnVal->stats = &info.stats;
+				shard.allPages.insert (tableId, i, returnVal);
+
+			// in this case, we do
+			} else {
+				returnVal = *found;
+				waitForRead (shard, returnVal);
+			}
+
+			// see if we already have his data; if so, he is now pinned
+			if (returnVal->bytes != nullptr) {
+				shard.policy->hit (returnVal);
+				returnVal->stats->hits.fetch_add (1, memory_order_relaxed);
+				shard.policy->pin (returnVal);
+				returnVal->scanRing = nullptr;
+				if (ram != nullptr)
+					shard.availableRam.push_back (ram);
+				return MyDB_PageHandle (returnVal);
+			}
 
-			// see if there is space to make a pinned page
-			if (availableRam.size () == 0)
-				kickOutPage ();
-	
-			// if there is no space, we cannot do anything
-			if (availableRam.size () == 0) 
-				return nullptr;
-	
 			// set up the return val
-			returnVal->bytes = availableRam[availableRam.size () - 1];
-			returnVal->numBytes = pageSize;
-			availableRam.pop_back ();
-			fdToRead = fds[returnVal->myTable];
+			if (ram != nullptr) {
+				returnVal->bytes = ram;
+				returnVal->numBytes = pageSize;
+				returnVal->ioPending = true;
+				shard.policy->miss (returnVal);
+				returnVal->stats->misses.fetch_add (1, memory_order_relaxed);
+
+				// the handle is made while we hold the latch, so no one can kill the page
+				returnHandle = MyDB_PageHandle (returnVal);
+				break;
+			}
 		}
 
+		// see if there is space to make a pinned page; if there is no space, we cannot do anything
+		ram = getRamOrWait (whichShard, false);
+		if (ram == nullptr) {
+			returnVal->stats->pinFailures.fetch_add (1, memory_order_relaxed);
+			return nullptr;
+		}
 	}
 
-	if (fdToRead != -1) {
-		lseek (fdToRead, returnVal->pos * pageSize, SEEK_SET);
-		read (fdToRead, returnVal->bytes, pageSize);
-	}
+	readPage (returnVal);
 
 	// get outta here
-	return make_shared <MyDB_PageHandleBase> (returnVal);
+	return returnHandle;
 }
 
 MyDB_PageHandle MyDB_BufferManager :: getPinnedPage () {
@@ -422,20 +1279,19 @@ MyDB_PageHandle MyDB_BufferManager :: getPinnedPage () {
 	// get a page to return
 	MyDB_PageHandle returnVal = getPage ();
 
-	Lock temp (getLock ());
-
-	// see if there is space to make a pinned page
-	if (availableRam.size () == 0)
-		kickOutPage ();
-
-	// if there is no space, we cannot do anything
-	if (availableRam.size () == 0) 
+	// see if there is space to make a pinned page; if there is no space, we cannot do anything
+	void *ram = getRamOrWait (returnVal->page->shard, false);
+	if (ram == nullptr) {
+		returnVal->page->stats->pinFailures.fetch_add (1, memory_order_relaxed);
 		return nullptr;
+	}
 
-	returnVal->page->bytes = availableRam[availableRam.size () - 1];
+	MyDB_BufferShard &shard = *shards[returnVal->page->shard];
+	TimedLock temp (&shard.myLock, managerStats);
+	returnVal->page->bytes = ram;
 	setCannotExpell (returnVal->page->bytes);
 	returnVal->page->numBytes = pageSize;
-	availableRam.pop_back ();
+	shard.policy->admit (returnVal->page->shared_from_this ());
 
 	// and get outta here
 	return returnVal;
@@ -443,79 +1299,152 @@ MyDB_PageHandle MyDB_BufferManager :: getPinnedPage () {
 
 void MyDB_BufferManager :: unpin (MyDB_PagePtr unpinMe) {
 
-	Lock temp (getLock ());
-	unpinMe->timeTick = ++lastTimeTick;
-	lastUsed.insert (unpinMe);
+	MyDB_BufferShard &shard = *shards[unpinMe->shard];
+	TimedLock temp (&shard.myLock, managerStats);
+	if (unpinMe->bytes != nullptr)
+		shard.policy->unpin (unpinMe);
+
+	// someone may be waiting for a frame that can be evicted
+	pthread_cond_broadcast (&ramReleased);
 }
 
-MyDB_BufferManager :: MyDB_BufferManager (size_t pageSizeIn, size_t numPagesIn, string tempFileIn) {
+MyDB_BufferManager :: MyDB_BufferManager (size_t pageSizeIn, size_t numPagesIn, string tempFileIn, size_t numShards,
+	MyDB_ReplacementType replacement, MyDB_IOType ioType, bool directIOIn) {
 
 	// remember the inputs
 	pageSize = pageSizeIn;
+	io = MyDB_IOBackend :: makeBackend (ioType);
 
-	// this is the location where we write temp pages
-	tempFile = tempFileIn;
+	// temp pages are written out whole until someone asks otherwise
+	compressTemp = false;
 
-	// there is one thead pinned page... having to do with the main thread
-	threadPinnedPages.resize (1);
-	threadPinnedPages [0] = nullptr;
+	// direct I/O only works if every page I/O is aligned
+	directIO = directIOIn;
+	if (directIO && pageSize % DIRECT_IO_ALIGNMENT != 0) {
+		cout << "Page size " << pageSize << " is not a multiple of " << DIRECT_IO_ALIGNMENT
+			<< ", so not using direct I/O.\n";
+		directIO = false;
+	}
 
-	// we are not running in multi-threaded mode
-	stackBase = nullptr;
+	// this is where we write temp pages
+	tempSpace = new MyDB_TempSpace (tempFileIn, pageSize, MAX_PIN_SLOTS, directIO, managerStats);
 
-	// start at time tick zero
-	lastTimeTick = 0;
+	// no thread has used the buffer manager yet
+	myId = nextMgrId++;
+	numPinSlots = 0;
+
+	// and no table has been given an id
+	numTables = 0;
+
+	// we are not running in multi-threaded mode
+	numWorkers = 0;
 
 	// initialize the mutex
 	pthread_mutex_init (&myLock, nullptr);
+	pthread_mutex_init (&flushLock, nullptr);
 
-	// position in temp file
-	lastTempPos = 0;
+	// there is no background writer until someone starts one
+	writerRunning = false;
+	stopWriter = false;
+	numToKeepClean = 0;
+	pthread_cond_init (&wakeWriter, nullptr);
+	pthread_cond_init (&framesReleased, nullptr);
+	pthread_cond_init (&ramReleased, nullptr);
+
+	// there is no manifest or preload until someone asks for them
+	preloadRunning = false;
+	stopPreload = false;
 
 	// the number of pages; we add some extra pages just to be safe
 	numPages = numPagesIn + 10;
+	numReserved = 0;
+
+	// by default, use one shard for every eight pages, up to 16 shards
+	if (numShards == 0) {
+		numShards = numPages / 8;
+		if (numShards > 16)
+			numShards = 16;
+		if (numShards == 0)
+			numShards = 1;
+	}
 
 	// create all of the RAM
+	frames = new MyDB_FrameTable (pageSize, numPages);
+
+	for (size_t i = 0; i < numShards; i++) {
+		shards.push_back (new MyDB_BufferShard);
+		shards[i]->policy = MyDB_ReplacementPolicy :: makePolicy (replacement, (numPages + numShards - 1) / numShards,
+			*frames);
+	}
+
+	// and deal it out to the shards
 	for (size_t i = 0; i < numPages; i++) {
-		availableRam.push_back (malloc (pageSizeIn));
+		shards[i % numShards]->availableRam.push_back (frames->getBytes (i));
 	}	
 }
 
 MyDB_BufferManager :: ~MyDB_BufferManager () {
 	
-	if (threadPinnedPages.size () != 1) {
+	if (numWorkers != 0) {
 		std :: cout << "This is bad.  It appears the buffer manager is being killed with some threads outstanding.\n";
 	}
 
-	for (auto page : allPages) {
+	// shut down the background writer
+	if (writerRunning) {
+		{
+			Lock temp (getLock ());
+			stopWriter = true;
+			pthread_cond_signal (&wakeWriter);
+		}
+		pthread_join (writerThread, nullptr);
+		writerRunning = false;
+	}
+
+	// stop the preload, if it is still going
+	stopPreload = true;
+	waitForPreload ();
 
-		if (page.second->bytes != nullptr) {
+	// write back all of the dirty pages
+	flushAll ();
 
-			// write it back if necessary
-			if (page.second->isDirty) {
-				lseek (fds[page.second->myTable], page.second->pos * pageSize, SEEK_SET);
-				write (fds[page.second->myTable], page.second->bytes, pageSize);
-			}
+	// remember what was hot, for next time; this is done after the flush, so that the
+	// manifest has the final sizes and times of the table files
+	if (manifestFile != "")
+		writeManifest ();
 
-			free (page.second->bytes);
-			page.second->bytes = nullptr;
-		}
+	// none of the pages have RAM any more
+	for (MyDB_BufferShard *shard : shards) {
+		shard->allPages.forEach ([] (MyDB_PagePtr &page) {
+			page->bytes = nullptr;
+		});
+		delete shard;
 	}
 
-	// delete the rest of the RAM
-	for (auto ram : availableRam) {
-		free (ram);
+	// delete the RAM, and the mappings
+	delete frames;
+	for (auto &table : mappedTables)
+		delete table.second;
+
+	// the threads that have pin slots should no longer hang on to them
+	for (size_t i = 0; i < numPinSlots; i++) {
+		pinSlots[i]->retired = true;
 	}
 
-	// get rid of the lock
+	// get rid of the locks
+	pthread_cond_destroy (&wakeWriter);
+	pthread_cond_destroy (&framesReleased);
+	pthread_cond_destroy (&ramReleased);
+	pthread_mutex_destroy (&flushLock);
 	pthread_mutex_destroy (&myLock);
 	
-	// finally, close the files
-	for (auto fd : fds) {
-		close (fd.second);
+	// finally, close the files, and get rid of the temp files
+	size_t howMany = numTables;
+	for (size_t i = 0; i < howMany; i++) {
+		close (tables[i]->fd);
+		delete tables[i];
 	}
 
-	unlink (tempFile.c_str ());
+	delete tempSpace;
 }
 
 
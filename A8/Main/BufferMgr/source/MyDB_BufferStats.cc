@@ -0,0 +1,63 @@
+
+#ifndef BUFFER_STATS_C
+#define BUFFER_STATS_C
+
+#include "MyDB_BufferStats.h"
+#include <sstream>
+
+using namespace std;
+
+double MyDB_LatencyHistogram :: meanNanos () {
+	if (count == 0)
+		return 0;
+	return ((double) totalNanos) / count;
+}
+
+long MyDB_LatencyHistogram :: percentile (double fraction) {
+
+	// find the bucket that the I/O at the given rank falls in
+	long rank = (long) (fraction * count);
+	long soFar = 0;
+	for (int i = 0; i < LATENCY_BUCKETS; i++) {
+		soFar += buckets[i];
+		if (soFar > rank)
+			return 2L << i;
+	}
+
+	return 0;
+}
+
+string MyDB_LatencyHistogram :: toJSON () {
+
+	ostringstream out;
+	out << "{\"count\": " << count << ", \"meanMicros\": " << meanNanos () / 1000.0
+		<< ", \"p50Micros\": " << percentile (.5) / 1000.0
+		<< ", \"p99Micros\": " << percentile (.99) / 1000.0
+		<< ", \"p999Micros\": " << percentile (.999) / 1000.0;
+
+	// the buckets, without the empty ones at the top
+	int numToList = LATENCY_BUCKETS;
+	while (numToList > 0 && buckets[numToList - 1] == 0)
+		numToList--;
+	out << ", \"log2NanosBuckets\": [";
+	for (int i = 0; i < numToList; i++)
+		out << (i == 0 ? "" : ", ") << buckets[i];
+	out << "]}";
+
+	return out.str ();
+}
+
+string MyDB_BufferStats :: toJSON () {
+
+	ostringstream out;
+	out << "{\"hits\": " << hits << ", \"misses\": " << misses << ", \"evictions\": " << evictions
+		<< ", \"writeBacks\": " << writeBacks << ", \"pinFailures\": " << pinFailures
+		<< ", \"lockWaits\": " << lockWaits << ", \"lockWaitMicros\": " << lockWaitNanos / 1000.0
+		<< ", \"bytesRead\": " << bytesRead << ", \"bytesWritten\": " << bytesWritten
+		<< ", \"reads\": " << reads.toJSON () << ", \"writes\": " << writes.toJSON () << "}";
+
+	return out.str ();
+}
+
+#endif
+
@@ -0,0 +1,63 @@
+
+#ifndef FRAME_TABLE_C
+#define FRAME_TABLE_C
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include "MyDB_FrameTable.h"
+#include <sys/mman.h>
+
+using namespace std;
+
+// the size of a huge page; the arena is aligned to (and a multiple of) this
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+MyDB_FrameTable :: MyDB_FrameTable (size_t pageSizeIn, size_t numFramesIn) {
+
+	pageSize = pageSizeIn;
+	numFrames = numFramesIn;
+	arenaSize = ((pageSize * numFrames + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE) * HUGE_PAGE_SIZE;
+	hugePages = false;
+
+	// first try to get huge pages that have been set aside
+#ifdef MAP_HUGETLB
+	void *mapped = mmap (nullptr, arenaSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	if (mapped != MAP_FAILED) {
+		arena = (char *) mapped;
+		hugePages = true;
+	}
+#endif
+
+	// if that did not work, map an extra huge page's worth so that we can align the
+	// arena to a huge page boundary, then trim off the ends
+	if (!hugePages) {
+
+		char *mapped = (char *) mmap (nullptr, arenaSize + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (mapped == MAP_FAILED) {
+			cout << "Can't map " << arenaSize << " bytes for the buffer pool: " << strerror (errno) << "\n";
+			exit (1);
+		}
+
+		arena = (char *) ((((size_t) mapped) + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE);
+		if (arena != mapped)
+			munmap (mapped, arena - mapped);
+		munmap (arena + arenaSize, (mapped + HUGE_PAGE_SIZE) - arena);
+
+#ifdef MADV_HUGEPAGE
+		madvise (arena, arenaSize, MADV_HUGEPAGE);
+#endif
+	}
+
+	frames.reset (new MyDB_FrameDesc[numFrames]);
+	for (size_t i = 0; i < numFrames; i++)
+		frames[i].refBit = false;
+}
+
+MyDB_FrameTable :: ~MyDB_FrameTable () {
+	munmap (arena, arenaSize);
+}
+
+#endif
+
@@ -0,0 +1,97 @@
+
+#ifndef IO_BACKEND_C
+#define IO_BACKEND_C
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include "MyDB_IOBackend.h"
+#include "MyDB_PositionalIO.h"
+#include "MyDB_SyncIO.h"
+#include "MyDB_UringIO.h"
+#include <unistd.h>
+
+using namespace std;
+
+void MyDB_IOBackend :: prefetch (vector <MyDB_PageIO> &batch) {
+
+	for (size_t i = 0; i < batch.size (); ) {
+
+		// find the run of I/Os that continue on from this one
+		off_t start = batch[i].offset;
+		off_t end = start + batch[i].numBytes;
+		size_t j = i + 1;
+		for (; j < batch.size () && batch[j].fd == batch[i].fd && batch[j].offset == end; j++)
+			end += batch[j].numBytes;
+
+		posix_fadvise (batch[i].fd, start, end - start, POSIX_FADV_WILLNEED);
+		i = j;
+	}
+}
+
+void MyDB_IOBackend :: read (int fd, void *bytes, size_t numBytes, off_t offset) {
+	vector <MyDB_PageIO> batch;
+	batch.emplace_back (fd, bytes, numBytes, offset, false);
+	submit (batch);
+}
+
+void MyDB_IOBackend :: write (int fd, void *bytes, size_t numBytes, off_t offset) {
+	vector <MyDB_PageIO> batch;
+	batch.emplace_back (fd, bytes, numBytes, offset, true);
+	submit (batch);
+}
+
+void MyDB_IOBackend :: finishIO (MyDB_PageIO &doMe, size_t done) {
+
+	// keep going until the whole page is done, or a read hits the end of the file
+	while (done < doMe.numBytes) {
+
+		char *where = ((char *) doMe.bytes) + done;
+		ssize_t res;
+		if (doMe.isWrite)
+			res = pwrite (doMe.fd, where, doMe.numBytes - done, doMe.offset + done);
+		else
+			res = pread (doMe.fd, where, doMe.numBytes - done, doMe.offset + done);
+
+		if (res == -1 && errno == EINTR)
+			continue;
+
+		if (res == -1) {
+			cout << "Page I/O failed: " << strerror (errno) << "\n";
+			exit (1);
+		}
+
+		if (res == 0)
+			return;
+
+		done += res;
+	}
+}
+
+int MyDB_IOBackend :: openFile (string fileName, int flags, bool direct) {
+
+	if (direct) {
+		int fd = open (fileName.c_str (), flags | O_DIRECT, 0666);
+		if (fd != -1 || errno != EINVAL)
+			return fd;
+	}
+
+	return open (fileName.c_str (), flags, 0666);
+}
+
+MyDB_IOBackendPtr MyDB_IOBackend :: makeBackend (MyDB_IOType whichType) {
+
+	if (whichType == UringIO) {
+		shared_ptr <MyDB_UringIO> returnVal = make_shared <MyDB_UringIO> ();
+		if (returnVal->isReady ())
+			return returnVal;
+	} else if (whichType == SyncIO) {
+		return make_shared <MyDB_SyncIO> ();
+	}
+
+	return make_shared <MyDB_PositionalIO> ();
+}
+
+#endif
+
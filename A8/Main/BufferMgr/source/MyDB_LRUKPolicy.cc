@@ -0,0 +1,113 @@
+
+#ifndef LRUK_POLICY_C
+#define LRUK_POLICY_C
+
+#include "MyDB_LRUKPolicy.h"
+
+MyDB_LRUKPolicy :: MyDB_LRUKPolicy (size_t capacityIn) {
+	now = 0;
+	capacity = capacityIn;
+}
+
+void MyDB_LRUKPolicy :: admit (MyDB_PagePtr admitMe) {
+
+	Entry &entry = buffered[admitMe.get ()];
+	entry.history = make_pair (0, 0);
+	entry.pinned = true;
+
+	// if we saw this page recently, pick up its history
+	if (!isAnonymous (admitMe)) {
+		auto found = retained.find (keyFor (admitMe));
+		if (found != retained.end ()) {
+			entry.history = found->second;
+			retained.erase (found);
+		}
+	}
+
+	// and record this reference
+	entry.history = make_pair (entry.history.second, ++now);
+}
+
+void MyDB_LRUKPolicy :: reference (MyDB_PagePtr referenceMe) {
+
+	auto found = buffered.find (referenceMe.get ());
+	if (found == buffered.end ())
+		return;
+
+	Entry &entry = found->second;
+	if (!entry.pinned)
+		candidates.erase (entry.history);
+
+	entry.history = make_pair (entry.history.second, ++now);
+
+	if (!entry.pinned)
+		candidates[entry.history] = referenceMe;
+}
+
+void MyDB_LRUKPolicy :: pin (MyDB_PagePtr pinMe) {
+
+	auto found = buffered.find (pinMe.get ());
+	if (found == buffered.end () || found->second.pinned)
+		return;
+
+	candidates.erase (found->second.history);
+	found->second.pinned = true;
+}
+
+void MyDB_LRUKPolicy :: unpin (MyDB_PagePtr unpinMe) {
+
+	auto found = buffered.find (unpinMe.get ());
+	if (found == buffered.end () || !found->second.pinned)
+		return;
+
+	candidates[found->second.history] = unpinMe;
+	found->second.pinned = false;
+}
+
+MyDB_PagePtr MyDB_LRUKPolicy :: victim (function <bool (MyDB_PagePtr &)> canEvict) {
+
+	for (auto &candidate : candidates) {
+		if (canEvict (candidate.second))
+			return candidate.second;
+	}
+
+	return nullptr;
+}
+
+void MyDB_LRUKPolicy :: evict (MyDB_PagePtr evictMe) {
+
+	auto found = buffered.find (evictMe.get ());
+	if (found == buffered.end ())
+		return;
+
+	// remember the history of the page
+	if (!isAnonymous (evictMe)) {
+		MyDB_PageKey key = keyFor (evictMe);
+		retained[key] = found->second.history;
+		retainedOrder.push_back (key);
+
+		// and forget the oldest history if we have too many; the key at the front
+		// may have been re-admitted and evicted again since, in which case we just
+		// lose its history a bit early
+		if (retainedOrder.size () > capacity) {
+			retained.erase (retainedOrder.front ());
+			retainedOrder.pop_front ();
+		}
+	}
+
+	forget (evictMe);
+}
+
+void MyDB_LRUKPolicy :: forget (MyDB_PagePtr forgetMe) {
+
+	auto found = buffered.find (forgetMe.get ());
+	if (found == buffered.end ())
+		return;
+
+	if (!found->second.pinned)
+		candidates.erase (found->second.history);
+	buffered.erase (found);
+}
+
+#endif
+
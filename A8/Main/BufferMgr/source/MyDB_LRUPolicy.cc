@@ -0,0 +1,58 @@
+
+#ifndef LRU_POLICY_C
+#define LRU_POLICY_C
+
+#include "MyDB_LRUPolicy.h"
+
+void MyDB_LRUPolicy :: admit (MyDB_PagePtr) {
+	// the page is pinned, so there is nothing to do until it is unpinned
+}
+
+void MyDB_LRUPolicy :: reference (MyDB_PagePtr referenceMe) {
+
+	// if the page is in the list, move it to the MRU end
+	auto found = where.find (referenceMe.get ());
+	if (found != where.end ())
+		lruList.splice (lruList.end (), lruList, found->second);
+}
+
+void MyDB_LRUPolicy :: pin (MyDB_PagePtr pinMe) {
+	forget (pinMe);
+}
+
+void MyDB_LRUPolicy :: unpin (MyDB_PagePtr unpinMe) {
+
+	// an unpinned page goes in at the MRU end
+	if (where.count (unpinMe.get ()) == 0)
+		where[unpinMe.get ()] = lruList.insert (lruList.end (), unpinMe);
+}
+
+MyDB_PagePtr MyDB_LRUPolicy :: victim (function <bool (MyDB_PagePtr &)> canEvict) {
+
+	for (MyDB_PagePtr &candidate : lruList) {
+		if (canEvict (candidate))
+			return candidate;
+	}
+
+	return nullptr;
+}
+
+vector <MyDB_PagePtr> MyDB_LRUPolicy :: hotPages () {
+	return vector <MyDB_PagePtr> (lruList.rbegin (), lruList.rend ());
+}
+
+void MyDB_LRUPolicy :: evict (MyDB_PagePtr evictMe) {
+	forget (evictMe);
+}
+
+void MyDB_LRUPolicy :: forget (MyDB_PagePtr forgetMe) {
+
+	auto found = where.find (forgetMe.get ());
+	if (found != where.end ()) {
+		lruList.erase (found->second);
+		where.erase (found);
+	}
+}
+
+#endif
+
@@ -0,0 +1,66 @@
+
+#ifndef MAPPED_TABLE_C
+#define MAPPED_TABLE_C
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include "MyDB_MappedTable.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+MyDB_MappedTable :: MyDB_MappedTable (MyDB_TablePtr tableIn, size_t pageSizeIn, MyDB_AccessPattern pattern) {
+
+	table = tableIn;
+	pageSize = pageSizeIn;
+	numPages = table->lastPage () + 1;
+	pages.resize (numPages);
+	pthread_mutex_init (&myLock, nullptr);
+
+	fd = open (table->getStorageLoc ().c_str (), O_RDONLY);
+	if (fd == -1) {
+		cout << "Can't open " << table->getStorageLoc () << " to map it: " << strerror (errno) << "\n";
+		exit (1);
+	}
+
+	// touching a page past the end of the file would kill us, so check up front
+	struct stat fileInfo;
+	fstat (fd, &fileInfo);
+	if ((size_t) fileInfo.st_size < numPages * pageSize) {
+		cout << "Can't map table " << table->getName () << ": the file has " << fileInfo.st_size / pageSize
+			<< " pages, and the catalog says that it has " << numPages << "\n";
+		exit (1);
+	}
+
+	base = (char *) mmap (nullptr, numPages * pageSize, PROT_READ, MAP_SHARED, fd, 0);
+	if (base == MAP_FAILED) {
+		cout << "Can't map table " << table->getName () << ": " << strerror (errno) << "\n";
+		exit (1);
+	}
+
+	setAccessPattern (pattern);
+}
+
+MyDB_MappedTable :: ~MyDB_MappedTable () {
+
+	// the page objects should not point into the mapping once it is gone
+	for (MyDB_PagePtr &page : pages) {
+		if (page != nullptr)
+			page->bytes = nullptr;
+	}
+
+	munmap (base, numPages * pageSize);
+	close (fd);
+	pthread_mutex_destroy (&myLock);
+}
+
+void MyDB_MappedTable :: setAccessPattern (MyDB_AccessPattern pattern) {
+	madvise (base, numPages * pageSize, pattern == SequentialAccess ? MADV_SEQUENTIAL : MADV_RANDOM);
+}
+
+#endif
+
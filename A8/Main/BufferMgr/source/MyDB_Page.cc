@@ -16,8 +16,8 @@
 #include "MyDB_Page.h"
 #include "MyDB_Table.h"
 
-void *MyDB_Page :: getBytes (MyDB_PagePtr me) {
-	parent.access (me);	
+void *MyDB_Page :: getBytes (MyDB_ScanRing *ring) {
+	parent.access (*this, ring);
 	return bytes;
 }
 
@@ -25,22 +25,47 @@ void MyDB_Page :: wroteBytes () {
 	isDirty = true;
 }
 
-MyDB_Page :: ~MyDB_Page () {
-	pthread_mutex_destroy (&myMutex);
+void MyDB_Page :: setBytes (void *bytesIn, size_t numBytesIn) {
+	bytes = bytesIn;
+	numBytes = numBytesIn;
 }
 
+MyDB_Page :: ~MyDB_Page () {}
+
 MyDB_Page :: MyDB_Page (MyDB_TablePtr myTableIn, size_t iin, MyDB_BufferManager &parentIn) : 
 	parent (parentIn), myTable (myTableIn), pos (iin) { 
 	bytes = nullptr;
 	isDirty = false;	
-	pthread_mutex_init (&myMutex, nullptr);
 	refCount = 0;
-	timeTick = -1;
+	clockSlot = -1;
+	shard = 0;
+	fd = -1;
+	tableId = 0;
+	tempSegment = nullptr;
+	spillBytes = 0;
+	mapping = nullptr;
+	stats = nullptr;
+	ioPending = false;
+	writePending = false;
+	killWhenWritten = false;
+	scanRing = nullptr;
 }
 
-void MyDB_Page :: killpage (MyDB_PagePtr me) {
-	Lock temp (parent.getLock ());
-	parent.killPage (me);
+void MyDB_Page :: killpage () {
+
+	// the page of a mapped table belongs to the mapping, which keeps it around
+	if (mapping != nullptr) {
+		refCount.fetch_sub (REF_COUNT_KILLER, memory_order_acq_rel);
+		return;
+	}
+
+	TimedLock temp (parent.getShardLock (*this), parent.managerStats);
+
+	// a handle to a page with no handles is only ever made while holding the shard
+	// latch, so if the count is now zero, it will stay that way; the page may go away
+	// as soon as it is killed, so it is not touched after that
+	if (refCount.fetch_sub (REF_COUNT_KILLER, memory_order_acq_rel) == REF_COUNT_KILLER)
+		parent.killPage (shared_from_this ());
 }
 
 MyDB_BufferManager &MyDB_Page :: getParent () {
@@ -0,0 +1,193 @@
+
+#ifndef PAGE_COMPRESSOR_C
+#define PAGE_COMPRESSOR_C
+
+#include <cstdint>
+#include <cstring>
+#include "MyDB_PageCompressor.h"
+#include <vector>
+
+using namespace std;
+
+// the hash table of four-byte strings has 2^HASH_BITS entries
+#define HASH_BITS 14
+
+// matches are at least this long, and at most this far back
+#define MIN_MATCH 4
+#define MAX_OFFSET 65535
+
+// the last few bytes are always literals, so that a match never runs off of the end
+#define LAST_LITERALS 8
+
+static inline uint32_t read32 (const unsigned char *from) {
+	uint32_t returnVal;
+	memcpy (&returnVal, from, sizeof (returnVal));
+	return returnVal;
+}
+
+// a thread's hash table for compress ().  Rather than clearing the table for every page,
+// each call numbers the positions starting just past the ones that the last call used,
+// so the entries left over from earlier pages are simply ignored
+struct MyDB_HashScratch {
+	vector <uint32_t> lastSeen;
+	uint32_t base = 0;
+};
+
+static thread_local MyDB_HashScratch hashScratch;
+
+// the number of extra bytes that a length of a sequence takes up
+static inline size_t lengthBytes (size_t length) {
+	return length >= 15 ? (length - 15) / 255 + 1 : 0;
+}
+
+// writes out a length that did not fit in its four bits of the token
+static inline unsigned char *putLength (unsigned char *to, size_t length) {
+	for (; length >= 255; length -= 255)
+		*to++ = 255;
+	*to++ = (unsigned char) length;
+	return to;
+}
+
+size_t MyDB_PageCompressor :: compress (const void *inBytes, size_t numBytes, void *outBytes, size_t maxOut) {
+
+	const unsigned char *in = (const unsigned char *) inBytes;
+	unsigned char *out = (unsigned char *) outBytes;
+	unsigned char *outEnd = out + maxOut;
+	unsigned char *op = out;
+
+	// the position of the last string with each hash, plus base + 1 (so an entry that is
+	// not past base is empty); the table is cleared only when the numbers run out
+	if (hashScratch.lastSeen.size () == 0 || numBytes >= UINT32_MAX - hashScratch.base) {
+		hashScratch.lastSeen.assign (1 << HASH_BITS, 0);
+		hashScratch.base = 0;
+	}
+	uint32_t *lastSeen = hashScratch.lastSeen.data ();
+	size_t base = hashScratch.base;
+	hashScratch.base += numBytes;
+
+	size_t anchor = 0;
+	size_t pos = 0;
+	while (numBytes > LAST_LITERALS + MIN_MATCH && pos < numBytes - LAST_LITERALS - MIN_MATCH) {
+
+		uint32_t next = read32 (in + pos);
+		uint32_t hash = (next * 2654435761U) >> (32 - HASH_BITS);
+		size_t candidate = lastSeen[hash];
+		lastSeen[hash] = base + pos + 1;
+
+		if (candidate <= base || pos - (candidate - base - 1) > MAX_OFFSET || read32 (in + candidate - base - 1) != next) {
+			pos++;
+			continue;
+		}
+
+		// extend the match as far as it goes
+		size_t matchPos = candidate - base - 1;
+		size_t length = MIN_MATCH;
+		while (pos + length < numBytes - LAST_LITERALS && in[matchPos + length] == in[pos + length])
+			length++;
+
+		// the token, the literals, the offset, and the rest of the match length
+		size_t numLiterals = pos - anchor;
+		if ((size_t) (outEnd - op) < 1 + lengthBytes (numLiterals) + numLiterals + 2 + lengthBytes (length - MIN_MATCH))
+			return 0;
+
+		unsigned char *token = op++;
+		*token = (unsigned char) ((numLiterals < 15 ? numLiterals : 15) << 4);
+		if (numLiterals >= 15)
+			op = putLength (op, numLiterals - 15);
+		memcpy (op, in + anchor, numLiterals);
+		op += numLiterals;
+
+		size_t offset = pos - matchPos;
+		*op++ = (unsigned char) (offset & 0xFF);
+		*op++ = (unsigned char) (offset >> 8);
+
+		size_t extra = length - MIN_MATCH;
+		*token |= (unsigned char) (extra < 15 ? extra : 15);
+		if (extra >= 15)
+			op = putLength (op, extra - 15);
+
+		pos += length;
+		anchor = pos;
+	}
+
+	// the last sequence is all literals
+	size_t numLiterals = numBytes - anchor;
+	if ((size_t) (outEnd - op) < 1 + lengthBytes (numLiterals) + numLiterals)
+		return 0;
+
+	*op++ = (unsigned char) ((numLiterals < 15 ? numLiterals : 15) << 4);
+	if (numLiterals >= 15)
+		op = putLength (op, numLiterals - 15);
+	memcpy (op, in + anchor, numLiterals);
+	op += numLiterals;
+
+	return op - out;
+}
+
+bool MyDB_PageCompressor :: decompress (const void *inBytes, size_t numIn, void *outBytes, size_t numBytes) {
+
+	const unsigned char *ip = (const unsigned char *) inBytes;
+	const unsigned char *inEnd = ip + numIn;
+	unsigned char *out = (unsigned char *) outBytes;
+	unsigned char *op = out;
+	unsigned char *outEnd = out + numBytes;
+
+	while (ip < inEnd) {
+
+		unsigned char token = *ip++;
+
+		// the literals
+		size_t numLiterals = token >> 4;
+		if (numLiterals == 15) {
+			unsigned char more;
+			do {
+				if (ip == inEnd)
+					return false;
+				more = *ip++;
+				numLiterals += more;
+			} while (more == 255);
+		}
+		if (numLiterals > (size_t) (inEnd - ip) || numLiterals > (size_t) (outEnd - op))
+			return false;
+		memcpy (op, ip, numLiterals);
+		ip += numLiterals;
+		op += numLiterals;
+
+		// the last sequence has no match
+		if (ip == inEnd)
+			break;
+
+		// the match, which may overlap the bytes it produces, so it is copied a byte at a time
+		if (inEnd - ip < 2)
+			return false;
+		size_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		size_t length = (token & 15);
+		if (length == 15) {
+			unsigned char more;
+			do {
+				if (ip == inEnd)
+					return false;
+				more = *ip++;
+				length += more;
+			} while (more == 255);
+		}
+		length += MIN_MATCH;
+
+		if (offset == 0 || offset > (size_t) (op - out) || length > (size_t) (outEnd - op))
+			return false;
+		const unsigned char *match = op - offset;
+		if (offset >= length) {
+			memcpy (op, match, length);
+			op += length;
+		} else {
+			for (size_t i = 0; i < length; i++)
+				*op++ = *match++;
+		}
+	}
+
+	return op == outEnd;
+}
+
+#endif
+
@@ -0,0 +1,72 @@
+
+#ifndef POSITIONAL_IO_C
+#define POSITIONAL_IO_C
+
+#include <algorithm>
+#include <climits>
+#include "MyDB_PositionalIO.h"
+#include <sys/uio.h>
+
+using namespace std;
+
+void MyDB_PositionalIO :: submit (vector <MyDB_PageIO> &batch) {
+
+	// put the writes in file order, so that adjacent pages end up next to each other
+	vector <MyDB_PageIO *> writes;
+	for (MyDB_PageIO &doMe : batch) {
+		if (doMe.isWrite)
+			writes.push_back (&doMe);
+		else
+			finishIO (doMe, 0);
+	}
+
+	sort (writes.begin (), writes.end (), [] (MyDB_PageIO *lhs, MyDB_PageIO *rhs) {
+		return lhs->fd < rhs->fd || (lhs->fd == rhs->fd && lhs->offset < rhs->offset);
+	});
+
+	vector <struct iovec> iovecs;
+	for (size_t i = 0; i < writes.size (); ) {
+
+		// find the run of writes that continue on from this one
+		size_t j = i + 1;
+		off_t end = writes[i]->offset + writes[i]->numBytes;
+		for (; j < writes.size () && j - i < IOV_MAX && writes[j]->fd == writes[i]->fd &&
+			writes[j]->offset == end; j++)
+			end += writes[j]->numBytes;
+
+		if (j - i == 1) {
+			finishIO (*writes[i], 0);
+			i = j;
+			continue;
+		}
+
+		iovecs.clear ();
+		for (size_t k = i; k < j; k++) {
+			struct iovec next;
+			next.iov_base = writes[k]->bytes;
+			next.iov_len = writes[k]->numBytes;
+			iovecs.push_back (next);
+		}
+
+		ssize_t res = pwritev (writes[i]->fd, iovecs.data (), iovecs.size (), writes[i]->offset);
+		if (res == -1)
+			res = 0;
+
+		// if the write came up short (or failed), finish off the pages it did not get
+		// to one at a time; finishIO takes care of reporting a real error
+		size_t written = res;
+		for (size_t k = i; k < j; k++) {
+			if (written >= writes[k]->numBytes) {
+				written -= writes[k]->numBytes;
+			} else {
+				finishIO (*writes[k], written);
+				written = 0;
+			}
+		}
+
+		i = j;
+	}
+}
+
+#endif
+
@@ -0,0 +1,29 @@
+
+#ifndef REPLACEMENT_POLICY_C
+#define REPLACEMENT_POLICY_C
+
+#include "MyDB_ARCPolicy.h"
+#include "MyDB_ClockPolicy.h"
+#include "MyDB_LRUKPolicy.h"
+#include "MyDB_LRUPolicy.h"
+#include "MyDB_ReplacementPolicy.h"
+#include "MyDB_TwoQPolicy.h"
+
+MyDB_ReplacementPolicyPtr MyDB_ReplacementPolicy :: makePolicy (MyDB_ReplacementType whichType, size_t capacity,
+	MyDB_FrameTable &frames) {
+
+	if (whichType == LRUReplacement) {
+		return make_shared <MyDB_LRUPolicy> ();
+	} else if (whichType == LRUKReplacement) {
+		return make_shared <MyDB_LRUKPolicy> (capacity);
+	} else if (whichType == TwoQReplacement) {
+		return make_shared <MyDB_TwoQPolicy> (capacity);
+	} else if (whichType == ARCReplacement) {
+		return make_shared <MyDB_ARCPolicy> (capacity);
+	}
+
+	return make_shared <MyDB_ClockPolicy> (frames);
+}
+
+#endif
+
@@ -0,0 +1,114 @@
+
+#ifndef TEMP_SPACE_C
+#define TEMP_SPACE_C
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include "MyDB_IOBackend.h"
+#include "MyDB_TempSpace.h"
+#include <unistd.h>
+
+using namespace std;
+
+// the number of positions tracked by each word of a bitmap
+#define BITS_PER_WORD 64
+
+MyDB_TempSegment :: MyDB_TempSegment (string fileNameIn, size_t pageSizeIn, bool directIOIn,
+	MyDB_StatCounters &waitStatsIn) : waitStats (waitStatsIn) {
+	fd = -1;
+	fileName = fileNameIn;
+	pageSize = pageSizeIn;
+	directIO = directIOIn;
+	numUsed = 0;
+	nextPos = 0;
+	pthread_mutex_init (&myLock, nullptr);
+}
+
+MyDB_TempSegment :: ~MyDB_TempSegment () {
+	if (fd != -1) {
+		close (fd);
+		unlink (fileName.c_str ());
+	}
+	pthread_mutex_destroy (&myLock);
+}
+
+size_t MyDB_TempSegment :: getNumUsed () {
+	TimedLock temp (&myLock, waitStats);
+	return numUsed;
+}
+
+size_t MyDB_TempSegment :: allocate () {
+
+	TimedLock temp (&myLock, waitStats);
+
+	if (fd == -1) {
+		fd = MyDB_IOBackend :: openFile (fileName, O_TRUNC | O_CREAT | O_RDWR, directIO);
+		if (fd == -1) {
+			cout << "Can't open temp file " << fileName << ": " << strerror (errno) << "\n";
+			exit (1);
+		}
+	}
+
+	// look for a free position at or after nextPos, then wrap around to the start
+	size_t numWords = used.size ();
+	size_t startWord = nextPos / BITS_PER_WORD;
+	for (size_t i = 0; i <= numWords && numUsed < numWords * BITS_PER_WORD; i++) {
+
+		size_t whichWord = (startWord + i) % numWords;
+		unsigned long freeBits = ~used[whichWord];
+
+		// in the first word, only the positions at or after nextPos count
+		if (i == 0)
+			freeBits &= ~0UL << (nextPos % BITS_PER_WORD);
+
+		if (freeBits != 0) {
+			int whichBit = __builtin_ctzl (freeBits);
+			used[whichWord] |= 1UL << whichBit;
+			numUsed++;
+			nextPos = whichWord * BITS_PER_WORD + whichBit + 1;
+			return nextPos - 1;
+		}
+	}
+
+	// everything is in use, so grow the file by an extent; if the file system cannot
+	// preallocate, the file just grows as pages are written
+	size_t pos = numWords * BITS_PER_WORD;
+	fallocate (fd, 0, pos * pageSize, TEMP_EXTENT_PAGES * pageSize);
+	used.resize (numWords + (TEMP_EXTENT_PAGES + BITS_PER_WORD - 1) / BITS_PER_WORD, 0);
+
+	used[pos / BITS_PER_WORD] |= 1UL;
+	numUsed++;
+	nextPos = pos + 1;
+	return pos;
+}
+
+void MyDB_TempSegment :: release (size_t pos) {
+	TimedLock temp (&myLock, waitStats);
+	used[pos / BITS_PER_WORD] &= ~(1UL << (pos % BITS_PER_WORD));
+	numUsed--;
+}
+
+MyDB_TempSpace :: MyDB_TempSpace (string tempFileIn, size_t pageSizeIn, size_t numSegments, bool directIOIn,
+	MyDB_StatCounters &waitStatsIn) : waitStats (waitStatsIn) {
+	tempFile = tempFileIn;
+	pageSize = pageSizeIn;
+	directIO = directIOIn;
+	segments.resize (numSegments, nullptr);
+}
+
+MyDB_TempSpace :: ~MyDB_TempSpace () {
+	for (MyDB_TempSegment *segment : segments)
+		delete segment;
+}
+
+MyDB_TempSegment &MyDB_TempSpace :: getSegment (size_t whichSegment) {
+	if (segments[whichSegment] == nullptr)
+		segments[whichSegment] = new MyDB_TempSegment (tempFile + "." + to_string (whichSegment), pageSize,
+			directIO, waitStats);
+	return *segments[whichSegment];
+}
+
+#endif
+
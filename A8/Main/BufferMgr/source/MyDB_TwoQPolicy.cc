@@ -0,0 +1,121 @@
+
+#ifndef TWOQ_POLICY_C
+#define TWOQ_POLICY_C
+
+#include "MyDB_TwoQPolicy.h"
+
+MyDB_TwoQPolicy :: MyDB_TwoQPolicy (size_t capacity) {
+
+	// these are the sizes suggested in the 2Q paper
+	kin = capacity / 4 + 1;
+	kout = capacity / 2 + 1;
+}
+
+void MyDB_TwoQPolicy :: admit (MyDB_PagePtr admitMe) {
+
+	Entry &entry = buffered[admitMe.get ()];
+	entry.pinned = true;
+	entry.inAm = false;
+
+	// if the page was recently kicked out of A1in, then it is hot
+	if (!isAnonymous (admitMe)) {
+		auto found = inA1out.find (keyFor (admitMe));
+		if (found != inA1out.end ()) {
+			a1out.erase (found->second);
+			inA1out.erase (found);
+			entry.inAm = true;
+		}
+	}
+
+	if (entry.inAm) {
+		entry.pos = am.insert (am.end (), admitMe);
+	} else {
+		entry.pos = a1in.insert (a1in.end (), admitMe);
+	}
+}
+
+void MyDB_TwoQPolicy :: reference (MyDB_PagePtr referenceMe) {
+
+	// a reference only matters to a page in Am; A1in is FIFO
+	auto found = buffered.find (referenceMe.get ());
+	if (found != buffered.end () && found->second.inAm)
+		am.splice (am.end (), am, found->second.pos);
+}
+
+void MyDB_TwoQPolicy :: pin (MyDB_PagePtr pinMe) {
+	auto found = buffered.find (pinMe.get ());
+	if (found != buffered.end ())
+		found->second.pinned = true;
+}
+
+void MyDB_TwoQPolicy :: unpin (MyDB_PagePtr unpinMe) {
+	auto found = buffered.find (unpinMe.get ());
+	if (found != buffered.end ())
+		found->second.pinned = false;
+}
+
+MyDB_PagePtr MyDB_TwoQPolicy :: scan (list <MyDB_PagePtr> &scanMe, function <bool (MyDB_PagePtr &)> &canEvict) {
+
+	for (MyDB_PagePtr &candidate : scanMe) {
+		if (!buffered[candidate.get ()].pinned && canEvict (candidate))
+			return candidate;
+	}
+
+	return nullptr;
+}
+
+MyDB_PagePtr MyDB_TwoQPolicy :: victim (function <bool (MyDB_PagePtr &)> canEvict) {
+
+	// take from A1in if it is over its target size, otherwise from Am; if there is
+	// nothing that can be evicted there, try the other queue
+	MyDB_PagePtr returnVal;
+	if (a1in.size () > kin) {
+		returnVal = scan (a1in, canEvict);
+		if (returnVal == nullptr)
+			returnVal = scan (am, canEvict);
+	} else {
+		returnVal = scan (am, canEvict);
+		if (returnVal == nullptr)
+			returnVal = scan (a1in, canEvict);
+	}
+
+	return returnVal;
+}
+
+void MyDB_TwoQPolicy :: evict (MyDB_PagePtr evictMe) {
+
+	auto found = buffered.find (evictMe.get ());
+	if (found == buffered.end ())
+		return;
+
+	// a page leaving A1in is remembered in A1out
+	if (!found->second.inAm && !isAnonymous (evictMe)) {
+		MyDB_PageKey key = keyFor (evictMe);
+		if (inA1out.count (key) == 0) {
+			inA1out[key] = a1out.insert (a1out.end (), key);
+			if (a1out.size () > kout) {
+				inA1out.erase (a1out.front ());
+				a1out.pop_front ();
+			}
+		}
+	}
+
+	forget (evictMe);
+}
+
+void MyDB_TwoQPolicy :: forget (MyDB_PagePtr forgetMe) {
+
+	auto found = buffered.find (forgetMe.get ());
+	if (found == buffered.end ())
+		return;
+
+	if (found->second.inAm) {
+		am.erase (found->second.pos);
+	} else {
+		a1in.erase (found->second.pos);
+	}
+	buffered.erase (found);
+}
+
+#endif
+
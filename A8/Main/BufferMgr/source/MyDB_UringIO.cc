@@ -0,0 +1,209 @@
+
+#ifndef URING_IO_C
+#define URING_IO_C
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include "Lock.h"
+#include "MyDB_UringIO.h"
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+
+// io_uring is only usable if the kernel headers know about it
+#if defined (__NR_io_uring_setup) && defined (__NR_io_uring_enter)
+#define HAVE_URING
+#endif
+
+using namespace std;
+
+// gets a field of one of the mapped rings, which is offset bytes into the mapping
+#define RING_FIELD(ring, offset) ((unsigned *) (((char *) (ring)) + (offset)))
+
+#ifdef HAVE_URING
+
+MyDB_UringIO :: MyDB_UringIO () {
+
+	pthread_mutex_init (&myLock, nullptr);
+	sqRing = MAP_FAILED;
+	sqEntries = MAP_FAILED;
+	cqRing = MAP_FAILED;
+
+	struct io_uring_params params;
+	memset (&params, 0, sizeof (params));
+	ringFd = syscall (__NR_io_uring_setup, URING_DEPTH, &params);
+	if (ringFd < 0) {
+		ringFd = -1;
+		return;
+	}
+
+	// map in the rings; newer kernels put both of them in one mapping
+	sqRingSize = params.sq_off.array + params.sq_entries * sizeof (unsigned);
+	cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof (struct io_uring_cqe);
+	bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (singleMap) {
+		if (cqRingSize > sqRingSize)
+			sqRingSize = cqRingSize;
+		cqRingSize = sqRingSize;
+	}
+
+	sqRing = mmap (nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+	if (sqRing == MAP_FAILED) {
+		tearDown ();
+		return;
+	}
+
+	if (singleMap) {
+		cqRing = sqRing;
+	} else {
+		cqRing = mmap (nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+		if (cqRing == MAP_FAILED) {
+			tearDown ();
+			return;
+		}
+	}
+
+	sqEntriesSize = params.sq_entries * sizeof (struct io_uring_sqe);
+	sqEntries = mmap (nullptr, sqEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+	if (sqEntries == MAP_FAILED) {
+		tearDown ();
+		return;
+	}
+
+	sqTail = RING_FIELD (sqRing, params.sq_off.tail);
+	sqMask = RING_FIELD (sqRing, params.sq_off.ring_mask);
+	sqArray = RING_FIELD (sqRing, params.sq_off.array);
+	numEntries = params.sq_entries;
+	cqHead = RING_FIELD (cqRing, params.cq_off.head);
+	cqTail = RING_FIELD (cqRing, params.cq_off.tail);
+	cqMask = RING_FIELD (cqRing, params.cq_off.ring_mask);
+	cqEntries = ((char *) cqRing) + params.cq_off.cqes;
+
+	// we never submit more than there are iovecs for
+	if (numEntries > URING_DEPTH)
+		numEntries = URING_DEPTH;
+}
+
+void MyDB_UringIO :: submit (vector <MyDB_PageIO> &batch) {
+
+	Lock temp (&myLock);
+	struct io_uring_sqe *sqes = (struct io_uring_sqe *) sqEntries;
+	struct io_uring_cqe *cqes = (struct io_uring_cqe *) cqEntries;
+
+	// go through the batch, as many I/Os at a time as the ring holds
+	for (size_t first = 0; first < batch.size (); first += numEntries) {
+
+		unsigned numToDo = numEntries;
+		if (batch.size () - first < numToDo)
+			numToDo = batch.size () - first;
+
+		// fill in the submission queue entries; we are the only one who moves the tail
+		unsigned tail = *sqTail;
+		for (unsigned i = 0; i < numToDo; i++) {
+
+			MyDB_PageIO &doMe = batch[first + i];
+			unsigned index = (tail + i) & *sqMask;
+			struct io_uring_sqe *sqe = &sqes[index];
+			memset (sqe, 0, sizeof (*sqe));
+
+			iovecs[i].iov_base = doMe.bytes;
+			iovecs[i].iov_len = doMe.numBytes;
+			sqe->opcode = doMe.isWrite ? IORING_OP_WRITEV : IORING_OP_READV;
+			sqe->fd = doMe.fd;
+			sqe->off = doMe.offset;
+			sqe->addr = (unsigned long) &iovecs[i];
+			sqe->len = 1;
+			sqe->user_data = first + i;
+			sqArray[index] = index;
+		}
+
+		// make the entries visible to the kernel
+		__atomic_store_n (sqTail, tail + numToDo, __ATOMIC_RELEASE);
+
+		// submit them, and wait for all of them to complete
+		unsigned numToSubmit = numToDo;
+		unsigned numDone = 0;
+		while (numDone < numToDo) {
+
+			int res = syscall (__NR_io_uring_enter, ringFd, numToSubmit, numToDo - numDone,
+				IORING_ENTER_GETEVENTS, nullptr, 0);
+			if (res < 0 && errno != EINTR) {
+				cout << "io_uring_enter failed: " << strerror (errno) << "\n";
+				exit (1);
+			}
+			if (res > 0)
+				numToSubmit -= res;
+
+			// reap whatever has completed
+			unsigned head = *cqHead;
+			while (head != __atomic_load_n (cqTail, __ATOMIC_ACQUIRE)) {
+
+				struct io_uring_cqe *cqe = &cqes[head & *cqMask];
+				MyDB_PageIO &doMe = batch[cqe->user_data];
+
+				// if the I/O failed or came up short, do the rest of it by hand;
+				// finishIO takes care of reporting a real error
+				if (cqe->res < 0)
+					finishIO (doMe, 0);
+				else if (cqe->res > 0 && (size_t) cqe->res < doMe.numBytes)
+					finishIO (doMe, cqe->res);
+
+				head++;
+				numDone++;
+			}
+			__atomic_store_n (cqHead, head, __ATOMIC_RELEASE);
+		}
+	}
+}
+
+#else
+
+// without io_uring, the backend is never ready, so it is never used
+MyDB_UringIO :: MyDB_UringIO () {
+	pthread_mutex_init (&myLock, nullptr);
+	ringFd = -1;
+	sqRing = MAP_FAILED;
+	sqEntries = MAP_FAILED;
+	cqRing = MAP_FAILED;
+}
+
+void MyDB_UringIO :: submit (vector <MyDB_PageIO> &batch) {
+	for (MyDB_PageIO &doMe : batch)
+		finishIO (doMe, 0);
+}
+
+#endif
+
+bool MyDB_UringIO :: isReady () {
+	return ringFd != -1;
+}
+
+void MyDB_UringIO :: tearDown () {
+
+	if (sqEntries != MAP_FAILED)
+		munmap (sqEntries, sqEntriesSize);
+	if (cqRing != MAP_FAILED && cqRing != sqRing)
+		munmap (cqRing, cqRingSize);
+	if (sqRing != MAP_FAILED)
+		munmap (sqRing, sqRingSize);
+	if (ringFd != -1)
+		close (ringFd);
+
+	sqRing = MAP_FAILED;
+	sqEntries = MAP_FAILED;
+	cqRing = MAP_FAILED;
+	ringFd = -1;
+}
+
+MyDB_UringIO :: ~MyDB_UringIO () {
+	tearDown ();
+	pthread_mutex_destroy (&myLock);
+}
+
+#endif
+
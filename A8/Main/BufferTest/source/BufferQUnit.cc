@@ -0,0 +1,753 @@
+
+#ifndef BUFFER_TEST_H
+#define BUFFER_TEST_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include "MyDB_ARCPolicy.h"
+#include "MyDB_BufferManager.h"
+#include "MyDB_ClockPolicy.h"
+#include "MyDB_IOBackend.h"
+#include "MyDB_LRUKPolicy.h"
+#include "MyDB_LRUPolicy.h"
+#include "MyDB_PageCompressor.h"
+#include "MyDB_PageHandle.h"
+#include "MyDB_PageTable.h"
+#include "MyDB_UringIO.h"
+#include "MyDB_TwoQPolicy.h"
+#include "QUnit.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+// the page size and the number of pages for the I/O tests; there are more pages than
+// fit on the ring at once, and not a multiple of the ring's depth
+#define TEST_PAGE_SIZE 4096
+#define TEST_IO_PAGES (2 * URING_DEPTH + 13)
+
+// the size of the pages that are compressed, and the number of temp pages written through
+// a small buffer that compresses them
+#define TEST_COMPRESS_SIZE 16384
+#define TEST_SPILL_PAGES 200
+
+// a backend that does the first part of each I/O itself, and then leaves the rest to
+// finishIO, just like the ring does when the kernel completes only part of an I/O
+class MyDB_ShortIO : public MyDB_IOBackend {
+
+public:
+
+	void submit (vector <MyDB_PageIO> &batch) {
+		for (MyDB_PageIO &doMe : batch) {
+			size_t part = doMe.numBytes / 3;
+			ssize_t res = doMe.isWrite ? pwrite (doMe.fd, doMe.bytes, part, doMe.offset) :
+				pread (doMe.fd, doMe.bytes, part, doMe.offset);
+			finishIO (doMe, res > 0 ? res : 0);
+		}
+	}
+};
+
+// the byte that should be at position pos of page i
+static char testByte (int seed, size_t i, size_t pos) {
+	return (char) ((i * 131 + pos * 7 + seed) % 251);
+}
+
+// the byte that should be at position pos of temp page i; mostly runs of letters, which
+// compress well, with a few bytes in between that do not
+static char spillByte (size_t i, size_t pos) {
+	return (pos % 100 < 90) ? (char) ('a' + (i + pos / 100) % 26) : testByte (i, i, pos);
+}
+
+// gets page-aligned buffers (so that they work with O_DIRECT) for the given number of pages
+static char *getPages (size_t numPages) {
+	void *bytes;
+	if (posix_memalign (&bytes, DIRECT_IO_ALIGNMENT, numPages * TEST_PAGE_SIZE) != 0) {
+		cout << "Can't get RAM for the I/O test.\n";
+		exit (1);
+	}
+	return (char *) bytes;
+}
+
+// writes all of the pages in one batch, reads them back in another batch, and checks them;
+// then reads a page that runs past the end of the file, which should just stop there
+static void testBackend (QUnit::UnitTest &qunit, MyDB_IOBackend &myIO, int seed, bool direct) {
+
+	int fd = MyDB_IOBackend :: openFile ("ioTestFile", O_CREAT | O_RDWR | O_TRUNC, direct);
+	QUNIT_IS_TRUE (fd != -1);
+
+	char *written = getPages (TEST_IO_PAGES);
+	char *read = getPages (TEST_IO_PAGES);
+	vector <MyDB_PageIO> batch;
+	for (size_t i = 0; i < TEST_IO_PAGES; i++) {
+		for (size_t pos = 0; pos < TEST_PAGE_SIZE; pos++)
+			written[i * TEST_PAGE_SIZE + pos] = testByte (seed, i, pos);
+		batch.emplace_back (fd, written + i * TEST_PAGE_SIZE, TEST_PAGE_SIZE, i * TEST_PAGE_SIZE, true);
+	}
+	myIO.submit (batch);
+
+	// read them back in reverse order
+	memset (read, 0, TEST_IO_PAGES * TEST_PAGE_SIZE);
+	batch.clear ();
+	for (size_t i = TEST_IO_PAGES; i-- > 0;)
+		batch.emplace_back (fd, read + i * TEST_PAGE_SIZE, TEST_PAGE_SIZE, i * TEST_PAGE_SIZE, false);
+	myIO.submit (batch);
+	QUNIT_IS_EQUAL (memcmp (written, read, TEST_IO_PAGES * TEST_PAGE_SIZE), 0);
+
+	// and one page at a time
+	memset (read, 0, TEST_PAGE_SIZE);
+	myIO.read (fd, read, TEST_PAGE_SIZE, (TEST_IO_PAGES - 1) * TEST_PAGE_SIZE);
+	QUNIT_IS_EQUAL (memcmp (written + (TEST_IO_PAGES - 1) * TEST_PAGE_SIZE, read, TEST_PAGE_SIZE), 0);
+
+	// O_DIRECT needs aligned offsets, so the read past the end is only done without it
+	if (!direct) {
+		memset (read, 0, 2 * TEST_PAGE_SIZE);
+		batch.clear ();
+		batch.emplace_back (fd, read, TEST_PAGE_SIZE, TEST_IO_PAGES * TEST_PAGE_SIZE - 100, false);
+		batch.emplace_back (fd, read + TEST_PAGE_SIZE, TEST_PAGE_SIZE, TEST_IO_PAGES * TEST_PAGE_SIZE, false);
+		myIO.submit (batch);
+		QUNIT_IS_EQUAL (memcmp (written + TEST_IO_PAGES * TEST_PAGE_SIZE - 100, read, 100), 0);
+		bool untouched = true;
+		for (size_t pos = 100; pos < 2 * TEST_PAGE_SIZE; pos++)
+			untouched = untouched && read[pos] == 0;
+		QUNIT_IS_TRUE (untouched);
+	}
+
+	free (written);
+	free (read);
+	close (fd);
+	unlink ("ioTestFile");
+}
+
+// compresses the page into exactly maxOut bytes of room, followed by a few guard bytes that
+// must not be touched; returns the compressed size
+static size_t compressInto (QUnit::UnitTest &qunit, vector <unsigned char> &page, vector <unsigned char> &out, size_t maxOut) {
+	out.assign (maxOut + 64, 0xEE);
+	size_t size = MyDB_PageCompressor :: compress (page.data (), page.size (), out.data (), maxOut);
+	bool guardOK = true;
+	for (size_t i = maxOut; i < out.size (); i++)
+		guardOK = guardOK && out[i] == 0xEE;
+	QUNIT_IS_TRUE (guardOK);
+	return size;
+}
+
+// compresses the page with plenty of room, and checks that it decompresses to the same bytes
+static size_t roundTrip (QUnit::UnitTest &qunit, vector <unsigned char> &page) {
+	vector <unsigned char> out;
+	size_t size = compressInto (qunit, page, out, page.size () + page.size () / 255 + 16);
+	QUNIT_IS_TRUE (size != 0);
+	vector <unsigned char> back (page.size ());
+	QUNIT_IS_TRUE (MyDB_PageCompressor :: decompress (out.data (), size, back.data (), back.size ()));
+	QUNIT_IS_TRUE (back == page);
+	return size;
+}
+
+// the slot that the page table starts looking for a page in, when the table has 16 slots
+static size_t homeSlot (size_t tableId, size_t pos) {
+	return (((tableId << 40) | pos) * 0x9E3779B97F4A7C15UL) >> 60;
+}
+
+// checks that exactly the pages in expected can be found in the table
+static bool checkPageTable (MyDB_PageTable &table, map <pair <size_t, size_t>, MyDB_PagePtr> &expected,
+	vector <pair <size_t, size_t>> &gone) {
+
+	bool allOK = table.size () == expected.size ();
+	for (auto &page : expected) {
+		MyDB_PagePtr *found = table.find (page.first.first, page.first.second);
+		allOK = allOK && found != nullptr && *found == page.second;
+	}
+	for (auto &key : gone)
+		allOK = allOK && table.find (key.first, key.second) == nullptr;
+
+	size_t numSeen = 0;
+	table.forEach ([&] (MyDB_PagePtr &) {numSeen++;});
+	return allOK && numSeen == expected.size ();
+}
+
+// the pages for the replacement policy tests; page i is at position i of a table
+static vector <MyDB_PagePtr> policyPages (MyDB_BufferManager &myMgr, size_t numPages) {
+	MyDB_TablePtr table = make_shared <MyDB_Table> ("policyTable", "policyTable.bin");
+	vector <MyDB_PagePtr> pages;
+	for (size_t i = 0; i < numPages; i++)
+		pages.push_back (make_shared <MyDB_Page> (table, i, myMgr));
+	return pages;
+}
+
+// a page is read in just like access () does it: it is admitted pinned, and then unpinned
+static void bringIn (MyDB_ReplacementPolicy &policy, MyDB_PagePtr page) {
+	policy.miss (page);
+	policy.unpin (page);
+}
+
+static bool anyPage (MyDB_PagePtr &) {
+	return true;
+}
+
+// where the next howMany victims are in pages, each of which is evicted once it is chosen;
+// a -1 means that there was no victim
+static string evictNext (MyDB_ReplacementPolicy &policy, vector <MyDB_PagePtr> &pages, size_t howMany) {
+	ostringstream order;
+	for (size_t i = 0; i < howMany; i++) {
+		MyDB_PagePtr victim = policy.victim (anyPage);
+		long which = find (pages.begin (), pages.end (), victim) - pages.begin ();
+		order << (i == 0 ? "" : " ") << (victim == nullptr ? -1 : which);
+		if (victim != nullptr)
+			policy.evict (victim);
+	}
+	return order.str ();
+}
+
+// with only the hot pages buffered, reads the scan pages in one at a time through a shard
+// that holds capacity pages, evicting a victim whenever the shard is full; true if none
+// of the hot pages is ever the victim
+static bool scanSparesHot (MyDB_ReplacementPolicy &policy, vector <MyDB_PagePtr> &hot, vector <MyDB_PagePtr> &scan,
+	size_t capacity) {
+
+	set <MyDB_Page *> isHot;
+	for (MyDB_PagePtr &page : hot)
+		isHot.insert (page.get ());
+
+	size_t numBuffered = hot.size ();
+	for (MyDB_PagePtr &page : scan) {
+		if (numBuffered == capacity) {
+			MyDB_PagePtr victim = policy.victim (anyPage);
+			if (victim == nullptr || isHot.count (victim.get ()) != 0)
+				return false;
+			policy.evict (victim);
+			numBuffered--;
+		}
+		bringIn (policy, page);
+		numBuffered++;
+	}
+
+	return true;
+}
+
+// writes numPages pages of test bytes to the table through the buffer manager
+static void writeTable (MyDB_BufferManager &myMgr, MyDB_TablePtr table, size_t numPages, int seed) {
+	for (size_t i = 0; i < numPages; i++) {
+		MyDB_PageHandle page = myMgr.getPage (table, i);
+		char *bytes = (char *) page->getBytes ();
+		for (size_t pos = 0; pos < TEST_PAGE_SIZE; pos++)
+			bytes[pos] = testByte (seed, i, pos);
+		page->wroteBytes ();
+	}
+	table->setLastPage (numPages - 1);
+}
+
+// the text of a file
+static string fileText (string fName) {
+	ifstream in (fName);
+	ostringstream text;
+	text << in.rdbuf ();
+	return text.str ();
+}
+
+// starts up a buffer manager with the given manifest, lets it preload whatever it will,
+// and returns the number of pages that it read in
+static long preloadFrom (string manifest, map <string, MyDB_TablePtr> &allTables) {
+	ofstream out ("preloadManifest", ofstream :: out | ofstream :: trunc);
+	out << manifest;
+	out.close ();
+
+	MyDB_BufferManager myMgr (TEST_PAGE_SIZE, 16, "tempFile");
+	myMgr.setManifest ("preloadManifest");
+	myMgr.startPreload (allTables);
+	myMgr.waitForPreload ();
+	return myMgr.getStats ().bytesRead / TEST_PAGE_SIZE;
+}
+
+int main () {
+
+	QUnit::UnitTest qunit(cerr, QUnit::normal);
+
+	{
+		// every one of the I/O backends should write and read back the same bytes
+		cout << "TEST 1..." << flush;
+		const char *names[] = {"positional", "io_uring", "sync"};
+		MyDB_IOType types[] = {PositionalIO, UringIO, SyncIO};
+		for (int i = 0; i < 3; i++) {
+			MyDB_IOBackendPtr myIO = MyDB_IOBackend :: makeBackend (types[i]);
+			cout << names[i] << flush;
+			if (types[i] == UringIO && dynamic_pointer_cast <MyDB_UringIO> (myIO) == nullptr)
+				cout << " (not supported here, so this is positional)" << flush;
+			cout << "..." << flush;
+			testBackend (qunit, *myIO, i, false);
+			testBackend (qunit, *myIO, i + 10, true);
+		}
+
+		// and so should the path for an I/O that the kernel only does part of
+		cout << "short completions..." << flush;
+		MyDB_ShortIO shortIO;
+		testBackend (qunit, shortIO, 20, false);
+		cout << "done" << endl << flush;
+	}
+
+	{
+		// the compressor should give back exactly what it was given
+		cout << "TEST 2..." << flush;
+		srand48 (530);
+
+		// random bytes do not compress, so they do not fit in less than a page
+		cout << "incompressible..." << flush;
+		vector <unsigned char> noise (TEST_COMPRESS_SIZE);
+		for (unsigned char &c : noise)
+			c = lrand48 () % 256;
+		vector <unsigned char> out;
+		QUNIT_IS_EQUAL (compressInto (qunit, noise, out, TEST_COMPRESS_SIZE - DIRECT_IO_ALIGNMENT), 0);
+		QUNIT_IS_TRUE (roundTrip (qunit, noise) > TEST_COMPRESS_SIZE);
+
+		// a page of zeros is one long match
+		cout << "zeros..." << flush;
+		vector <unsigned char> zeros (TEST_COMPRESS_SIZE, 0);
+		QUNIT_IS_TRUE (roundTrip (qunit, zeros) < 100);
+
+		// some literals and then a long run; with any less room than it needs, the compressor
+		// gives up without writing past the end, wherever the limit falls in the run
+		cout << "limit..." << flush;
+		vector <unsigned char> run (TEST_COMPRESS_SIZE, 'a');
+		for (size_t i = 0; i < 1000; i++)
+			run[i] = lrand48 () % 256;
+		size_t size = roundTrip (qunit, run);
+		bool allFailed = true;
+		for (size_t maxOut = 0; maxOut < size; maxOut++)
+			allFailed = allFailed && compressInto (qunit, run, out, maxOut) == 0;
+		QUNIT_IS_TRUE (allFailed);
+		QUNIT_IS_EQUAL (compressInto (qunit, run, out, size), size);
+
+		// records look like text, with lots of short repeats; compressing the pages in a
+		// different order gives the same results, even though the hash table is reused
+		cout << "text..." << flush;
+		vector <unsigned char> text (TEST_COMPRESS_SIZE);
+		for (size_t i = 0; i < text.size (); i++)
+			text[i] = "Supplier#0000|furiously regular|"[(i * 7 + lrand48 () % 3) % 32];
+		size_t textSize = roundTrip (qunit, text);
+		QUNIT_IS_TRUE (textSize < TEST_COMPRESS_SIZE);
+		roundTrip (qunit, zeros);
+		roundTrip (qunit, noise);
+		QUNIT_IS_EQUAL (roundTrip (qunit, text), textSize);
+
+		// cutting off any part of the compressed data is caught
+		cout << "truncated..." << flush;
+		compressInto (qunit, text, out, TEST_COMPRESS_SIZE);
+		vector <unsigned char> back (TEST_COMPRESS_SIZE);
+		bool allCaught = true;
+		for (size_t numIn = 0; numIn < textSize; numIn++)
+			allCaught = allCaught && !MyDB_PageCompressor :: decompress (out.data (), numIn, back.data (), back.size ());
+		QUNIT_IS_TRUE (allCaught);
+		cout << "done" << endl << flush;
+	}
+
+	{
+		// temp pages that are compressed when they are evicted should come back intact
+		cout << "TEST 3..." << flush;
+		MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (TEST_COMPRESS_SIZE, 16, "tempFile");
+		myMgr->setCompressTempPages (true);
+		vector <MyDB_PageHandle> pages;
+		for (int i = 0; i < TEST_SPILL_PAGES; i++) {
+			pages.push_back (myMgr->getPage ());
+			char *bytes = (char *) pages.back ()->getBytes ();
+			for (size_t pos = 0; pos < TEST_COMPRESS_SIZE; pos++)
+				bytes[pos] = spillByte (i, pos);
+			pages.back ()->wroteBytes ();
+		}
+
+		bool allOK = true;
+		for (int i = 0; i < TEST_SPILL_PAGES; i++) {
+			char *bytes = (char *) pages[i]->getBytes ();
+			for (size_t pos = 0; pos < TEST_COMPRESS_SIZE; pos++)
+				allOK = allOK && bytes[pos] == spillByte (i, pos);
+		}
+		QUNIT_IS_TRUE (allOK);
+		QUNIT_IS_TRUE (myMgr->getStats ().bytesWritten < (long) (TEST_SPILL_PAGES * TEST_COMPRESS_SIZE) / 2);
+		cout << "done" << endl << flush;
+	}
+
+	{
+		// the page table should find every page that is left after each removal, even when
+		// the pages collide around the end of the table, where probing wraps around to the
+		// start (a table with 16 slots holds up to 7 pages without growing)
+		cout << "TEST 4..." << flush;
+		MyDB_BufferManager myMgr (TEST_PAGE_SIZE, 16, "tempFile");
+		vector <pair <size_t, size_t>> keys;
+		size_t numWanted[] = {3, 2, 2};
+		size_t slots[] = {15, 14, 0};
+		for (int which = 0; which < 3; which++) {
+			for (size_t pos = 0; numWanted[which] > 0; pos++) {
+				if (homeSlot (1, pos) == slots[which]) {
+					keys.push_back (make_pair ((size_t) 1, pos));
+					numWanted[which]--;
+				}
+			}
+		}
+
+		// try every order of removing them
+		vector <int> order = {0, 1, 2, 3, 4, 5, 6};
+		bool allOK = true;
+		do {
+			MyDB_PageTable table;
+			map <pair <size_t, size_t>, MyDB_PagePtr> expected;
+			vector <pair <size_t, size_t>> gone;
+			for (auto &key : keys) {
+				expected[key] = make_shared <MyDB_Page> (nullptr, key.second, myMgr);
+				table.insert (key.first, key.second, expected[key]);
+			}
+			allOK = allOK && checkPageTable (table, expected, gone);
+
+			for (int i : order) {
+				table.erase (keys[i].first, keys[i].second);
+				expected.erase (keys[i]);
+				gone.push_back (keys[i]);
+				allOK = allOK && checkPageTable (table, expected, gone);
+
+				// removing a page that is not there changes nothing
+				table.erase (keys[i].first, keys[i].second);
+				allOK = allOK && checkPageTable (table, expected, gone);
+			}
+		} while (next_permutation (order.begin (), order.end ()));
+		QUNIT_IS_TRUE (allOK);
+
+		// and the same with lots of pages from a few tables, as the table grows
+		MyDB_PageTable table;
+		map <pair <size_t, size_t>, MyDB_PagePtr> expected;
+		vector <pair <size_t, size_t>> gone;
+		srand48 (18);
+		for (int i = 0; i < 20000; i++) {
+			pair <size_t, size_t> key (lrand48 () % 3, lrand48 () % 2000);
+			if (expected.count (key) == 0) {
+				expected[key] = make_shared <MyDB_Page> (nullptr, key.second, myMgr);
+				table.insert (key.first, key.second, expected[key]);
+			} else {
+				table.erase (key.first, key.second);
+				expected.erase (key);
+			}
+			if (i % 1000 == 0)
+				allOK = allOK && checkPageTable (table, expected, gone);
+		}
+		QUNIT_IS_TRUE (allOK && checkPageTable (table, expected, gone));
+		cout << "done" << endl << flush;
+	}
+	{
+		// when every frame is pinned, a request for a pinned page gives up (and is counted),
+		// but an access waits for as long as it takes for a frame to be given back
+		cout << "TEST 5..." << flush;
+		MyDB_BufferManager myMgr (TEST_PAGE_SIZE, 4, "tempFile");
+		vector <MyDB_PageHandle> pinned;
+		for (size_t i = 0; i < myMgr.getNumPages (); i++)
+			pinned.push_back (myMgr.getPinnedPage ());
+
+		atomic <bool> done (false);
+		MyDB_PageHandle waiting = myMgr.getPage ();
+		thread accessor ([&] {
+			waiting->getBytes ();
+			done = true;
+		});
+
+		cout << "pin fails..." << flush;
+		QUNIT_IS_TRUE (myMgr.getPinnedPage () == nullptr);
+		QUNIT_IS_EQUAL (myMgr.getStats ().pinFailures, 1);
+
+		// the access has now been waiting for longer than the request did
+		cout << "access waits..." << flush;
+		this_thread :: sleep_for (chrono :: milliseconds (500));
+		QUNIT_IS_FALSE (done);
+		pinned.pop_back ();
+		accessor.join ();
+		QUNIT_IS_TRUE (done);
+		cout << "done" << endl << flush;
+	}
+	{
+		// each replacement policy should pick its victims in the order that it is supposed
+		// to, never pick a pinned page, and (except for plain LRU) keep its hot pages
+		// through a scan that touches each of its pages once
+		cout << "TEST 6..." << flush;
+		MyDB_BufferManager myMgr (TEST_PAGE_SIZE, 16, "tempFile");
+		vector <MyDB_PagePtr> pages = policyPages (myMgr, 64);
+		vector <MyDB_PagePtr> scan (pages.begin () + 20, pages.end ());
+
+		// LRU: a hit moves a page to the MRU end, and a pinned page is passed over until it
+		// is unpinned, when it goes in at the MRU end
+		cout << "LRU..." << flush;
+		{
+			MyDB_LRUPolicy policy;
+			for (int i = 0; i < 4; i++)
+				bringIn (policy, pages[i]);
+			policy.hit (pages[1]);
+			policy.pin (pages[2]);
+			QUNIT_IS_EQUAL (evictNext (policy, pages, 2), "0 3");
+			bringIn (policy, pages[4]);
+			policy.unpin (pages[2]);
+			QUNIT_IS_TRUE (policy.victim ([&] (MyDB_PagePtr &page) {return page != pages[1];}) == pages[4]);
+			QUNIT_IS_EQUAL (evictNext (policy, pages, 4), "1 4 2 -1");
+		}
+
+		// LRU-2: the pages referenced once go first, in LRU order, and then the rest, by
+		// their second-to-last reference.  An evicted page's history comes back with it,
+		// for as long as it is retained (the histories of capacity pages are retained)
+		cout << "LRU-K..." << flush;
+		{
+			MyDB_LRUKPolicy policy (4);
+			bringIn (policy, pages[0]);
+			bringIn (policy, pages[1]);
+			policy.hit (pages[0]);
+			policy.hit (pages[1]);
+			bringIn (policy, pages[2]);
+			bringIn (policy, pages[3]);
+			policy.pin (pages[2]);
+			QUNIT_IS_TRUE (policy.victim (anyPage) == pages[3]);
+			policy.unpin (pages[2]);
+			QUNIT_IS_EQUAL (evictNext (policy, pages, 5), "2 3 0 1 -1");
+
+			// page 0 comes back with two references, so a page read in once goes before it
+			bringIn (policy, pages[0]);
+			bringIn (policy, pages[5]);
+			QUNIT_IS_EQUAL (evictNext (policy, pages, 1), "5");
+
+			// that eviction pushed out the oldest history, which was page 2's, but not page 3's
+			bringIn (policy, pages[2]);
+			bringIn (policy, pages[3]);
+			QUNIT_IS_EQUAL (evictNext (policy, pages, 4), "2 0 3 -1");
+		}
+		{
+			MyDB_LRUKPolicy policy (8);
+			vector <MyDB_PagePtr> hot (pages.begin (), pages.begin () + 4);
+			for (MyDB_PagePtr &page : hot) {
+				bringIn (policy, page);
+				policy.hit (page);
+			}
+			QUNIT_IS_TRUE (scanSparesHot (policy, hot, scan, 8));
+		}
+
+		// 2Q with a capacity of 8, so A1in has a target size of 3 and A1out holds 5 keys
+		cout << "2Q..." << flush;
+		{
+			MyDB_TwoQPolicy policy (8);
+
+			// A1in is FIFO, so the hit does not save page 0
+			for (int i = 0; i < 4; i++)
+				bringIn (policy, pages[i]);
+			policy.hit (pages[0]);
+			QUNIT_IS_EQUAL (evictNext (policy, pages, 1), "0");
+
+			// page 0 is in A1out, so when it comes back, it goes to Am; A1in is at its
+			// target, so the victim comes from Am, unless everything there is pinned
+			bringIn (policy, pages[0]);
+			QUNIT_IS_TRUE (policy.victim (anyPage) == pages[0]);
+			policy.pin (pages[0]);
+			QUNIT_IS_TRUE (policy.victim (anyPage) == pages[1]);
+			policy.unpin (pages[0]);
+
+			// six pages leave A1in, and only the last five are remembered
+			for (int i = 10; i < 16; i++)
+				bringIn (policy, pages[i]);
+			QUNIT_IS_EQUAL (evictNext (policy, pages, 6), "1 2 3 10 11 12");
+
+			// so page 12 goes to Am and page 1 goes to A1in
+			bringIn (policy, pages[12]);
+			bringIn (policy, pages[1]);
+			policy.hit (pages[0]);
+			QUNIT_IS_EQUAL (evictNext (policy, pages, 7), "13 12 0 14 15 1 -1");
+		}
+		{
+			// the hot pages get to Am by being read in again while they are in A1out
+			MyDB_TwoQPolicy policy (8);
+			vector <MyDB_PagePtr> hot (pages.begin (), pages.begin () + 3);
+			for (MyDB_PagePtr &page : hot) {
+				bringIn (policy, page);
+				policy.evict (page);
+			}
+			for (MyDB_PagePtr &page : hot)
+				bringIn (policy, page);
+			QUNIT_IS_TRUE (scanSparesHot (policy, hot, scan, 8));
+		}
+
+		// ARC with a capacity of 4
+		cout << "ARC..." << flush;
+		{
+			MyDB_ARCPolicy policy (4);
+			for (int i = 0; i < 4; i++)
+				bringIn (policy, pages[i]);
+
+			// the target size of T1 starts at zero, so T1 goes first
+			QUNIT_IS_EQUAL (evictNext (policy, pages, 2), "0 1");
+
+			// each page that comes back from B1 raises the target by one, and goes into T2
+			bringIn (policy, pages[0]);
+			bringIn (policy, pages[1]);
+
+			// T1 (pages 2 and 3) is at its target of two, so it gives up page 2; then it is
+			// under the target, so T2 gives up its LRU page
+			QUNIT_IS_EQUAL (evictNext (policy, pages, 2), "2 0");
+
+			// page 0 comes back from B2, which lowers the target to one, so T1 gives up page 3
+			bringIn (policy, pages[0]);
+			policy.pin (pages[3]);
+			QUNIT_IS_TRUE (policy.victim (anyPage) == pages[1]);
+			policy.unpin (pages[3]);
+			QUNIT_IS_EQUAL (evictNext (policy, pages, 4), "3 1 0 -1");
+		}
+		{
+			// T1 and B1 together hold at most capacity pages, so after a scan through T1,
+			// page 13 is no longer in B1, and it goes back into T1 rather than T2
+			MyDB_ARCPolicy policy (4);
+			bringIn (policy, pages[0]);
+			policy.hit (pages[0]);
+			vector <MyDB_PagePtr> hot (pages.begin (), pages.begin () + 1);
+			vector <MyDB_PagePtr> shortScan (pages.begin () + 10, pages.begin () + 18);
+			QUNIT_IS_TRUE (scanSparesHot (policy, hot, shortScan, 4));
+			bringIn (policy, pages[13]);
+			QUNIT_IS_EQUAL (evictNext (policy, pages, 6), "15 16 17 13 0 -1");
+		}
+		{
+			MyDB_ARCPolicy policy (8);
+			vector <MyDB_PagePtr> hot (pages.begin (), pages.begin () + 4);
+			for (MyDB_PagePtr &page : hot) {
+				bringIn (policy, page);
+				policy.hit (page);
+			}
+			QUNIT_IS_TRUE (scanSparesHot (policy, hot, scan, 8));
+		}
+		cout << "done" << endl << flush;
+	}
+	{
+		// CLOCK keeps its reference bits in the frame descriptors, so each page is given a
+		// frame of its own.  A set bit buys a page exactly one more trip of the hand; pinned
+		// pages are out of the ring, and thread-pinned ones (those that canEvict () turns
+		// down) are passed over without losing their bits.  The unlatched reference that
+		// access () does for a page that the thread pinned recently is the same as a hit
+		cout << "TEST 7..." << flush;
+		MyDB_BufferManager myMgr (TEST_PAGE_SIZE, 16, "tempFile");
+		vector <MyDB_PagePtr> pages = policyPages (myMgr, 8);
+		MyDB_FrameTable frames (TEST_PAGE_SIZE, pages.size ());
+		for (size_t i = 0; i < pages.size (); i++)
+			pages[i]->setBytes (frames.getBytes (i), TEST_PAGE_SIZE);
+
+		for (int unlatched = 0; unlatched < 2; unlatched++) {
+			MyDB_ClockPolicy policy (frames);
+			for (int i = 0; i < 4; i++)
+				bringIn (policy, pages[i]);
+
+			// every bit is set, so the first trip clears them all, and the second finds page 0
+			QUNIT_IS_EQUAL (evictNext (policy, pages, 1), "0");
+			QUNIT_IS_TRUE (!frames.getDesc (frames.getBytes (1)).refBit.load ());
+
+			// page 1 is referenced again, so the hand passes it once, clearing its bit
+			if (unlatched)
+				policy.referenceUnlatched (*pages[1]);
+			else
+				policy.hit (pages[1]);
+			QUNIT_IS_TRUE (frames.getDesc (frames.getBytes (1)).refBit.load ());
+			QUNIT_IS_EQUAL (evictNext (policy, pages, 4), "2 3 1 -1");
+		}
+
+		{
+			MyDB_ClockPolicy policy (frames);
+			for (int i = 0; i < 4; i++)
+				bringIn (policy, pages[i]);
+
+			// page 0 is pinned, so it leaves the ring, and page 1 is thread pinned; its bit
+			// is set, and it stays set while the hand passes over it
+			policy.pin (pages[0]);
+			auto notOne = [&] (MyDB_PagePtr &page) {return page != pages[1];};
+			QUNIT_IS_TRUE (policy.victim (notOne) == pages[2]);
+			QUNIT_IS_TRUE (frames.getDesc (frames.getBytes (1)).refBit.load ());
+			policy.evict (pages[2]);
+			QUNIT_IS_TRUE (policy.victim (notOne) == pages[3]);
+			policy.evict (pages[3]);
+
+			// with nothing else in the ring, two trips turn up no victim
+			QUNIT_IS_TRUE (policy.victim (notOne) == nullptr);
+			QUNIT_IS_TRUE (frames.getDesc (frames.getBytes (1)).refBit.load ());
+
+			// once page 1 is no longer thread pinned, it gets its one extra trip, and page 0
+			// comes back (into a free slot) when it is unpinned
+			policy.unpin (pages[0]);
+			QUNIT_IS_EQUAL (evictNext (policy, pages, 3), "1 0 -1");
+		}
+
+		// the pages must not give the frames back to the buffer manager
+		for (MyDB_PagePtr &page : pages)
+			page->setBytes (nullptr, 0);
+		cout << "done" << endl << flush;
+	}
+	{
+		// the manifest written when a buffer manager goes away should bring the same table
+		// pages back in; pages that are not in one of the tables are skipped, and if a
+		// table's file has been changed, the whole manifest is ignored
+		cout << "TEST 8..." << flush;
+		map <string, MyDB_TablePtr> allTables;
+		allTables["preloadA"] = make_shared <MyDB_Table> ("preloadA", "preloadA.bin");
+		allTables["preloadB"] = make_shared <MyDB_Table> ("preloadB", "preloadB.bin");
+		{
+			MyDB_BufferManager myMgr (TEST_PAGE_SIZE, 16, "tempFile");
+			myMgr.setManifest ("preloadManifest");
+			writeTable (myMgr, allTables["preloadA"], 6, 1);
+			writeTable (myMgr, allTables["preloadB"], 4, 2);
+		}
+		string manifest = fileText ("preloadManifest");
+
+		cout << "round trip..." << flush;
+		{
+			MyDB_BufferManager myMgr (TEST_PAGE_SIZE, 16, "tempFile");
+			myMgr.setManifest ("preloadManifest");
+			myMgr.startPreload (allTables);
+			myMgr.waitForPreload ();
+			QUNIT_IS_EQUAL (myMgr.getStats ().bytesRead, 10 * TEST_PAGE_SIZE);
+
+			// every page is now a hit, and has the right bytes
+			bool allOK = true;
+			for (int whichTable = 0; whichTable < 2; whichTable++) {
+				MyDB_TablePtr table = allTables[whichTable == 0 ? "preloadA" : "preloadB"];
+				for (int i = 0; i <= table->lastPage (); i++) {
+					MyDB_PageHandle page = myMgr.getPage (table, i);
+					char *bytes = (char *) page->getBytes ();
+					for (size_t pos = 0; pos < TEST_PAGE_SIZE; pos++)
+						allOK = allOK && bytes[pos] == testByte (whichTable + 1, i, pos);
+				}
+			}
+			QUNIT_IS_TRUE (allOK);
+			QUNIT_IS_EQUAL (myMgr.getStats ().misses, 0);
+			QUNIT_IS_EQUAL (myMgr.getStats ().hits, 10);
+		}
+
+		// keep the table lines from the manifest, and add one for a table that is gone; only
+		// the last of the pages listed is in one of the tables
+		cout << "bad pages..." << flush;
+		istringstream lines (manifest);
+		string header, line, tableLines;
+		size_t numNames, whichA = 0;
+		lines >> header >> numNames;
+		getline (lines, line);
+		for (size_t i = 0; i < numNames; i++) {
+			getline (lines, line);
+			tableLines += line + "\n";
+			if (line.find ("preloadA ") == 0)
+				whichA = i;
+		}
+		ostringstream badPages;
+		badPages << header << " " << numNames + 1 << " 5\n" << tableLines << "ghost 0 0 0\n";
+		badPages << whichA << " 6\n" << whichA << " -1\n" << numNames << " 0\n" << numNames + 1 << " 0\n";
+		badPages << whichA << " 5\n";
+		QUNIT_IS_EQUAL (preloadFrom (badPages.str (), allTables), 1);
+
+		// a table's file is changed after the manifest is written
+		cout << "stale..." << flush;
+		QUNIT_IS_EQUAL (preloadFrom (manifest, allTables), 10);
+		struct timespec longAgo[2] = {{0, 0}, {0, 0}};
+		utimensat (AT_FDCWD, "preloadB.bin", longAgo, 0);
+		QUNIT_IS_EQUAL (preloadFrom (manifest, allTables), 0);
+		cout << "done" << endl << flush;
+	}
+}
+
+#endif
@@ -89,6 +89,12 @@ public:
         void setTupleCount (size_t toMe);
         size_t getTupleCount ();
 
+	// the buffer manager that used the table last caches the dense id that it gave
+	// the table here (see MyDB_BufferManager :: getTableId ()); the key is -1 if no
+	// buffer manager has used the table
+	long getBufferKey ();
+	void setBufferKey (long toMe);
+
 private:
 
 	// the distinct value counts
@@ -117,6 +123,9 @@ private:
 
 	// location of the root node
 	int rootLocation;
+
+	// the buffer manager's cached id for the table; read and written atomically
+	long bufferKey;
 };
 
 #endif
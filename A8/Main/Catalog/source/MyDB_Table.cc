@@ -11,6 +11,7 @@ MyDB_Table :: MyDB_Table (string name, string storageLocIn) {
 	fileType = "heap";
 	sortAtt = "none";
 	rootLocation = -1;
+	bufferKey = -1;
 }
 
 MyDB_Table :: MyDB_Table (string name, string storageLocIn, MyDB_SchemaPtr mySchemaIn) {
@@ -21,6 +22,7 @@ MyDB_Table :: MyDB_Table (string name, string storageLocIn, MyDB_SchemaPtr mySch
 	fileType = "heap";
 	sortAtt = "none";
 	rootLocation = -1;
+	bufferKey = -1;
 }
 
 MyDB_Table :: MyDB_Table (string name, string storageLocIn, MyDB_SchemaPtr mySchemaIn, string fileTypeIn, string sortAttIn) {
@@ -31,6 +33,7 @@ MyDB_Table :: MyDB_Table (string name, string storageLocIn, MyDB_SchemaPtr mySch
 	fileType = fileTypeIn;
 	sortAtt = sortAttIn;
 	rootLocation = -1;
+	bufferKey = -1;
 }
 
 MyDB_Table :: ~MyDB_Table () {}
@@ -63,6 +66,14 @@ size_t MyDB_Table :: getTupleCount () {
         return count;
 }
 
+long MyDB_Table :: getBufferKey () {
+	return __atomic_load_n (&bufferKey, __ATOMIC_ACQUIRE);
+}
+
+void MyDB_Table :: setBufferKey (long toMe) {
+	__atomic_store_n (&bufferKey, toMe, __ATOMIC_RELEASE);
+}
+
 void MyDB_Table :: setRootLocation (int toMe) {
 	rootLocation = toMe;
 }
@@ -102,7 +113,9 @@ map <string, MyDB_TablePtr> MyDB_Table :: getAllTables (MyDB_CatalogPtr fromMe)
 	return returnVal;
 }
 
-MyDB_Table :: MyDB_Table () {}
+MyDB_Table :: MyDB_Table () {
+	bufferKey = -1;
+}
 
 int MyDB_Table :: lastPage () {
 	return last;
@@ -116,6 +129,7 @@ bool MyDB_Table :: fromCatalog (string tableNameIn, MyDB_CatalogPtr catalog) {
 	
 	// get the storage location
 	tableName = tableNameIn;
+	bufferKey = -1;
         if (!catalog->getString (tableName + ".fileName", storageLoc)) {
 		return false;
 	}
@@ -16,6 +16,7 @@
 #include "MyDB_RecordIteratorAlt.h"
 #include "MyDB_PageRecIteratorAlt.h"
 #include "MyDB_PageReaderWriter.h"
+#include "MyDB_ReadAhead.h"
 #include "MyDB_Record.h"
 #include <vector>
 
@@ -28,6 +29,9 @@ public:
         // load the current record into the parameter
         void getCurrent (MyDB_RecordPtr intoMe) override;
 
+	// make the parameter a view of the current record
+	void getCurrentView (MyDB_RecordPtr intoMe) override;
+
         // after a call to advance (), a call to getCurrentPointer () will get the address
         // of the record.  At a later time, it is then possible to reconstitute the record
         // by calling MyDB_Record.fromBinary (obtainedPointer)... ASSUMING that the page that
@@ -39,6 +43,9 @@ public:
         // be called until after getCurrent () has been called
         bool advance () override;
 
+	// the records after the current one on its page, or on the next page that has any
+	size_t getBatch (MyDB_RecordBatch &batch) override;
+
 	// destructor and contructor
 	MyDB_PageListIteratorAlt (vector <MyDB_PageReaderWriter> &forUs);
 	~MyDB_PageListIteratorAlt ();
@@ -48,6 +55,10 @@ private:
 	MyDB_RecordIteratorAltPtr myIter;
 	vector <MyDB_PageReaderWriter> forUs;
 	int curPage;
+	MyDB_ReadAhead readAhead;
+
+	// asks for the pages after the current one to be read ahead
+	void prefetchNext ();
 };
 
 #endif
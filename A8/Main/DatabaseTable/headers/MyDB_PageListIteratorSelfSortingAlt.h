@@ -6,6 +6,7 @@
 #include "MyDB_RecordIteratorAlt.h"
 #include "MyDB_PageRecIteratorAlt.h"
 #include "MyDB_PageReaderWriter.h"
+#include "MyDB_ReadAhead.h"
 #include "MyDB_Record.h"
 #include <vector>
 
@@ -20,6 +21,11 @@ public:
 		myIter->getCurrent (intoMe);
 	}
 
+	// make the parameter a view of the current record
+	void getCurrentView (MyDB_RecordPtr intoMe) override {
+		myIter->getCurrentView (intoMe);
+	}
+
         // after a call to advance (), a call to getCurrentPointer () will get the address
         // of the record.  At a later time, it is then possible to reconstitute the record
         // by calling MyDB_Record.fromBinary (obtainedPointer)... ASSUMING that the page that
@@ -38,13 +44,42 @@ public:
 				if (!lowComparator () && !highComparator ()) {
 					return true;
 				}
-			} else if (curPage == forUs.size () - 1) {
+			} else if (curPage == (int) forUs.size () - 1) {
 				return false;
 			} else {
 				curPage++;
 				if (sortOrNot)
 					forUs[curPage].sortInPlace (comparator, lhs, rhs);	
 				myIter = forUs[curPage].getIteratorAlt ();
+				prefetchNext ();
+			}
+		}
+	}
+
+	// the records after the current one on its page that are in the range, or the ones on
+	// the next page that has any
+	size_t getBatch (MyDB_RecordBatch &batch) override {
+		while (true) {
+			if (myIter->getBatch (batch) != 0) {
+
+				// keep the ones in the range
+				size_t m = 0;
+				for (size_t i = 0; i < batch.size (); i++) {
+					myRec->viewBinary (batch.positions[i]);
+					if (!lowComparator () && !highComparator ())
+						batch.positions[m++] = batch.positions[i];
+				}
+				batch.positions.resize (m);
+				if (m != 0)
+					return m;
+			} else if (curPage == (int) forUs.size () - 1) {
+				return 0;
+			} else {
+				curPage++;
+				if (sortOrNot)
+					forUs[curPage].sortInPlace (comparator, lhs, rhs);	
+				myIter = forUs[curPage].getIteratorAlt ();
+				prefetchNext ();
 			}
 		}
 	}
@@ -69,6 +104,7 @@ public:
 		if (sortOrNot)
 			forUs[curPage].sortInPlace (comparator, lhs, rhs);	
 		myIter = forUsIn[curPage].getIteratorAlt ();
+		prefetchNext ();
 	}
 
 	~MyDB_PageListIteratorSelfSortingAlt () {}
@@ -84,6 +120,14 @@ private:
 	int curPage;
 	bool sortOrNot;
 	MyDB_RecordPtr myRec;
+	MyDB_ReadAhead readAhead;
+
+	// asks for the pages after the current one to be read ahead
+	void prefetchNext () {
+		readAhead.moveTo (curPage, forUs.size () - 1, [&] (long i) {
+			forUs[i].prefetch ();
+		});
+	}
 };
 
 #endif
@@ -30,6 +30,10 @@ public:
 	// constructor for a page in the same file as the parent
 	MyDB_PageReaderWriter (MyDB_TableReaderWriter &parent, int whichPage);
 
+	// constructor for a page in the same file as the parent that is being read
+	// as part of a sequential scan using the given ring (which may be a nullptr)
+	MyDB_PageReaderWriter (MyDB_TableReaderWriter &parent, int whichPage, MyDB_ScanRingPtr ring);
+
 	// constructor for a page that can be pinned, if desired
 	MyDB_PageReaderWriter (bool pinned, MyDB_TableReaderWriter &parent, int whichPage);
 
@@ -86,13 +90,24 @@ public:
 	// returns the actual bytes
 	void *getBytes ();
 
+	// asks the buffer manager to read the page in the background, since it is
+	// going to be needed soon
+	void prefetch ();
+
 private:
 
+	// kills the program if the page is in a table that was opened read-only; its bytes are
+	// mapped read-only, so writing them would crash
+	void checkWritable ();
+
 	// this is the page that we are messing with
 	MyDB_PageHandle myPage;	
 	
 	// this is our buffer manager
 	size_t pageSize;
+
+	// the table that the page is in, if the table was opened read-only (otherwise, nullptr)
+	MyDB_TablePtr readOnlyTable;
 };
 
 // gets an instance of an alternatie iterator over a list of pages
@@ -24,6 +24,9 @@ public:
         // load the current record into the parameter
         void getCurrent (MyDB_RecordPtr intoMe) override;
 
+	// make the parameter a view of the current record
+	void getCurrentView (MyDB_RecordPtr intoMe) override;
+
         // after a call to advance (), a call to getCurrentPointer () will get the address
         // of the record.  At a later time, it is then possible to reconstitute the record
         // by calling MyDB_Record.fromBinary (obtainedPointer)... ASSUMING that the page that
@@ -35,6 +38,9 @@ public:
         // be called until after getCurrent () has been called
         bool advance () override;
 
+	// the records after the current one on the page, straight from the page's bytes
+	size_t getBatch (MyDB_RecordBatch &batch) override;
+
 	// destructor and contructor
 	MyDB_PageRecIteratorAlt (MyDB_PageHandle myPageIn); 
 	~MyDB_PageRecIteratorAlt ();
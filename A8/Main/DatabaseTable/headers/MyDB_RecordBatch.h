@@ -0,0 +1,52 @@
+
+#ifndef RECORD_BATCH_H
+#define RECORD_BATCH_H
+
+#include "MyDB_PageHandle.h"
+#include <vector>
+
+using namespace std;
+
+// the most records that an iterator puts into a batch
+#define MYDB_BATCH_SIZE 1024
+
+// a batch of records, as handed out by MyDB_RecordIteratorAlt.getBatch (): the addresses
+// of the records' bytes (as written by MyDB_Record.toBinary ()).  The records in a batch are
+// usually all on one page, which is not pinned; if the page is evicted and read back in
+// somewhere else while the batch is being used (say, because the operator appended to its
+// output), get () finds the records at the page's new address.  The addresses in positions
+// are only good until then, so they should be used right after the batch is filled
+class MyDB_RecordBatch {
+
+public:
+
+	// the address of each record in the batch
+	vector <void *> positions;
+
+	// the page that the records are on, and where its bytes were when the batch was filled;
+	// if the records are not on a page, then page is a nullptr
+	MyDB_PageHandle page;
+	char *base;
+
+	// when the records are not on a page, they are copied into here
+	vector <char> copies;
+
+	// the address of record i, as of now
+	inline void *get (size_t i) {
+		if (page == nullptr)
+			return positions[i];
+		return ((char *) page->getBytes ()) + (((char *) positions[i]) - base);
+	}
+
+	// the number of records in the batch
+	inline size_t size () {
+		return positions.size ();
+	}
+
+	MyDB_RecordBatch () {
+		positions.reserve (MYDB_BATCH_SIZE);
+		base = nullptr;
+	}
+};
+
+#endif
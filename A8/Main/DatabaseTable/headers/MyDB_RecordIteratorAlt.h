@@ -4,6 +4,7 @@
 
 #include <memory>
 #include "MyDB_Record.h"
+#include "MyDB_RecordBatch.h"
 using namespace std;
 
 // This pure virtual class is used to iterate through the records in a page or file
@@ -20,6 +21,14 @@ public:
 	// load the current record into the parameter
 	virtual void getCurrent (MyDB_RecordPtr intoMe) = 0;
 
+	// like getCurrent (), but the record is made into a view of the record's bytes on the
+	// page, rather than a copy of them (see MyDB_Record.viewBinary ()).  So the record can
+	// be used until the page could be evicted; this is the way to go for an operator that
+	// is done with each record before it writes anything
+	virtual void getCurrentView (MyDB_RecordPtr intoMe) {
+		getCurrent (intoMe);
+	}
+
         // after a call to advance (), a call to getCurrentPointer () will get the address
         // of the record.  At a later time, it is then possible to reconstitute the record
         // by calling MyDB_Record.fromBinary (obtainedPointer)... ASSUMING that the page that
@@ -31,6 +40,29 @@ public:
 	// be called until after getCurrent () has been called
 	virtual bool advance () = 0;
 
+	// fills the batch with up to MYDB_BATCH_SIZE of the records that come after the current
+	// one, and moves past them, so that the next call to advance () returns false if they
+	// were the last ones.  Returns the number of records in the batch; zero means that there
+	// are no more.  An iterator that can hand out records straight from a page does so; this
+	// one calls advance () and copies each record, which always works
+	virtual size_t getBatch (MyDB_RecordBatch &batch) {
+		vector <size_t> offsets;
+		batch.copies.clear ();
+		while (offsets.size () < MYDB_BATCH_SIZE && advance ()) {
+			char *pos = (char *) getCurrentPointer ();
+			offsets.push_back (batch.copies.size ());
+			batch.copies.insert (batch.copies.end (), pos, pos + MyDB_Record :: getBinarySize (pos));
+		}
+
+		// the copies do not move any more, so now we know where the records are
+		batch.positions.clear ();
+		for (size_t offset : offsets)
+			batch.positions.push_back (batch.copies.data () + offset);
+		batch.page = nullptr;
+		batch.base = nullptr;
+		return batch.size ();
+	}
+
 	// destructor and contructor
 	MyDB_RecordIteratorAlt () {};
 	virtual ~MyDB_RecordIteratorAlt () {};
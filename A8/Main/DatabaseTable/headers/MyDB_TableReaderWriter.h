@@ -35,6 +35,13 @@ public:
 	// create a table reader/writer
 	MyDB_TableReaderWriter (MyDB_TablePtr forMe, MyDB_BufferManagerPtr myBuffer);
 
+	// create a read-only reader for a table that already has pages; the table's file
+	// is memory-mapped, and its pages are served directly out of the mapping rather
+	// than being copied into the buffer (see MyDB_BufferManager :: mapTable ()).  The
+	// access pattern is passed on to the kernel, to guide its read-ahead.  Trying to
+	// change the table through the reader is an error
+	MyDB_TableReaderWriter (MyDB_TablePtr forMe, MyDB_BufferManagerPtr myBuffer, MyDB_AccessPattern readOnlyPattern);
+
 	// gets an empty record from this table
 	MyDB_RecordPtr getEmptyRecord ();
 
@@ -43,17 +50,20 @@ public:
 
 	// return an itrator over this table... each time returnVal->next () is
 	// called, the resulting record will be placed into the record pointed to
-	// by iterateIntoMe
-	MyDB_RecordIteratorPtr getIterator (MyDB_RecordPtr iterateIntoMe);
+	// by iterateIntoMe.  If bigScan is true, then the iterator is used for a
+	// one-time sequential scan, and if the table is large, the scan recycles a
+	// small ring of buffer pages rather than flushing the whole buffer
+	MyDB_RecordIteratorPtr getIterator (MyDB_RecordPtr iterateIntoMe, bool bigScan = false);
 
         // gets an instance of an alternate iterator over the table... this is an
-        // iterator that has the alternate getCurrent ()/advance () interface
-        MyDB_RecordIteratorAltPtr getIteratorAlt ();
+        // iterator that has the alternate getCurrent ()/advance () interface; bigScan
+        // is as above
+        MyDB_RecordIteratorAltPtr getIteratorAlt (bool bigScan = false);
 
 	// gets an instance of an alternate iterator over the page; this iterator
 	// works on a range of pages in the file, and iterates from lowPage through
-	// highPage inclusive
-	MyDB_RecordIteratorAltPtr getIteratorAlt (int lowPage, int highPage);
+	// highPage inclusive; bigScan is as above
+	MyDB_RecordIteratorAltPtr getIteratorAlt (int lowPage, int highPage, bool bigScan = false);
 
 	// load a text file into this table... this returns a pair where the first
 	// entry is a list of (approximate) distinct value counts for each of the
@@ -85,6 +95,9 @@ public:
 	// gets the table object for this guy
 	MyDB_TablePtr getTable ();
 
+	// true if the table's pages are being served out of a read-only mapping
+	bool isMapped ();
+
 private:
 
 	friend class MyDB_PageReaderWriter;
@@ -92,6 +105,21 @@ private:
 	MyDB_TablePtr forMe;
 	MyDB_BufferManagerPtr myBuffer;
 	shared_ptr <MyDB_PageReaderWriter> lastPage;
+
+	// the mapping that the pages are served from, if this is a read-only reader;
+	// otherwise a nullptr
+	MyDB_MappedTable *mapping;
+
+	// gets the i^th page, out of the mapping if there is one; the page is pinned if
+	// pinned is true, and is read as part of a scan with the given ring (which may be
+	// a nullptr) otherwise
+	MyDB_PageHandle getPage (long i, bool pinned, MyDB_ScanRingPtr ring);
+
+	// exits if this is a read-only reader
+	void checkWritable ();
+
+	// gets the scan ring (if any) for an iterator over the table
+	MyDB_ScanRingPtr getScanRing (bool bigScan);
 	
 };
 
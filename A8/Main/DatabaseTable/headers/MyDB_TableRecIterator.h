@@ -14,6 +14,7 @@
 #define TABLE_REC_ITER_H
 
 #include "MyDB_RecordIterator.h"
+#include "MyDB_ReadAhead.h"
 #include "MyDB_Record.h"
 #include "MyDB_TableReaderWriter.h"
 #include "MyDB_Table.h"
@@ -35,9 +36,10 @@ public:
 	// return true iff there is another record in the file/page
 	bool hasNext () override;
 
-	// destructor and contructor
+	// destructor and contructor; if the iterator is used for a big scan, it reads the
+	// pages through the given ring (otherwise the ring is a nullptr)
 	MyDB_TableRecIterator (MyDB_TableReaderWriter &myParent, MyDB_TablePtr myTableIn,
-        	MyDB_RecordPtr myRecIn);
+        	MyDB_RecordPtr myRecIn, MyDB_ScanRingPtr ring = nullptr);
 	~MyDB_TableRecIterator ();
 
 private:
@@ -48,6 +50,11 @@ private:
 	MyDB_TableReaderWriter &myParent;
 	MyDB_TablePtr myTable;
         MyDB_RecordPtr myRec;
+	MyDB_ScanRingPtr ring;
+	MyDB_ReadAhead readAhead;
+
+	// asks for the pages after the current one to be read ahead
+	void prefetchNext ();
 
 };
 
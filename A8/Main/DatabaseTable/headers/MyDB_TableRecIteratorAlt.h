@@ -14,6 +14,7 @@
 #define TABLE_REC_ITER_ALT_H
 
 #include "MyDB_RecordIteratorAlt.h"
+#include "MyDB_ReadAhead.h"
 #include "MyDB_Record.h"
 #include "MyDB_TableReaderWriter.h"
 #include "MyDB_Table.h"
@@ -25,6 +26,9 @@ public:
         // load the current record into the parameter
         void getCurrent (MyDB_RecordPtr intoMe) override;
 
+	// make the parameter a view of the current record
+	void getCurrentView (MyDB_RecordPtr intoMe) override;
+
         // after a call to advance (), a call to getCurrentPointer () will get the address
         // of the record.  At a later time, it is then possible to reconstitute the record
         // by calling MyDB_Record.fromBinary (obtainedPointer)... ASSUMING that the page that
@@ -36,10 +40,15 @@ public:
         // be called until after getCurrent () has been called
         bool advance () override;
 
-	// destructor and contructor
-	MyDB_TableRecIteratorAlt (MyDB_TableReaderWriter &myParent, MyDB_TablePtr myTableIn);
+	// the records after the current one on its page, or on the next page that has any
+	size_t getBatch (MyDB_RecordBatch &batch) override;
+
+	// destructor and contructor; if the iterator is used for a big scan, it reads the
+	// pages through the given ring (otherwise the ring is a nullptr)
+	MyDB_TableRecIteratorAlt (MyDB_TableReaderWriter &myParent, MyDB_TablePtr myTableIn, MyDB_ScanRingPtr ring = nullptr);
 	~MyDB_TableRecIteratorAlt ();
-	MyDB_TableRecIteratorAlt (MyDB_TableReaderWriter &myParent, MyDB_TablePtr myTableIn, int lowPage, int highPage);
+	MyDB_TableRecIteratorAlt (MyDB_TableReaderWriter &myParent, MyDB_TablePtr myTableIn, int lowPage, int highPage,
+		MyDB_ScanRingPtr ring = nullptr);
 
 private:
 
@@ -48,6 +57,11 @@ private:
 	int highPage;	
 	MyDB_TableReaderWriter &myParent;
 	MyDB_TablePtr myTable;
+	MyDB_ScanRingPtr ring;
+	MyDB_ReadAhead readAhead;
+
+	// asks for the pages after the current one to be read ahead
+	void prefetchNext ();
 };
 
 #endif
@@ -20,19 +20,43 @@ void MyDB_PageListIteratorAlt :: getCurrent (MyDB_RecordPtr intoMe) {
 	myIter->getCurrent (intoMe);
 }
 
+void MyDB_PageListIteratorAlt :: getCurrentView (MyDB_RecordPtr intoMe) {
+	myIter->getCurrentView (intoMe);
+}
+
 bool MyDB_PageListIteratorAlt :: advance () {
 
 	if (myIter->advance ())
 		return true;
 
-	if (curPage == forUs.size () - 1)
+	if (curPage == (int) forUs.size () - 1)
 		return false;
 
 	curPage++;
 	myIter = forUs[curPage].getIteratorAlt ();
+	prefetchNext ();
 	return advance ();
 }
 
+size_t MyDB_PageListIteratorAlt :: getBatch (MyDB_RecordBatch &batch) {
+
+	while (myIter->getBatch (batch) == 0) {
+		if (curPage == (int) forUs.size () - 1)
+			return 0;
+
+		curPage++;
+		myIter = forUs[curPage].getIteratorAlt ();
+		prefetchNext ();
+	}
+	return batch.size ();
+}
+
+void MyDB_PageListIteratorAlt :: prefetchNext () {
+	readAhead.moveTo (curPage, forUs.size () - 1, [&] (long i) {
+		forUs[i].prefetch ();
+	});
+}
+
 void *MyDB_PageListIteratorAlt :: getCurrentPointer () {
 	return myIter->getCurrentPointer ();
 }
@@ -41,6 +65,7 @@ MyDB_PageListIteratorAlt :: MyDB_PageListIteratorAlt (vector <MyDB_PageReaderWri
 	forUs = forUsIn;
 	curPage = 0;
 	myIter = forUsIn[curPage].getIteratorAlt ();		
+	prefetchNext ();
 }
 
 MyDB_PageListIteratorAlt :: ~MyDB_PageListIteratorAlt () {}
@@ -27,19 +27,28 @@
 MyDB_PageReaderWriter :: MyDB_PageReaderWriter (MyDB_TableReaderWriter &parent, int whichPage) {
 
 	// get the actual page
-	myPage = parent.getBufferMgr ()->getPage (parent.getTable (), whichPage);
+	myPage = parent.getPage (whichPage, false, nullptr);
 	pageSize = parent.getBufferMgr ()->getPageSize ();
+	if (parent.isMapped ())
+		readOnlyTable = parent.getTable ();
+}
+
+MyDB_PageReaderWriter :: MyDB_PageReaderWriter (MyDB_TableReaderWriter &parent, int whichPage, MyDB_ScanRingPtr ring) {
+
+	// get the actual page
+	myPage = parent.getPage (whichPage, false, ring);
+	pageSize = parent.getBufferMgr ()->getPageSize ();
+	if (parent.isMapped ())
+		readOnlyTable = parent.getTable ();
 }
 
 MyDB_PageReaderWriter :: MyDB_PageReaderWriter (bool pinned, MyDB_TableReaderWriter &parent, int whichPage) {
 
 	// get the actual page
-	if (pinned) {
-		myPage = parent.getBufferMgr ()->getPinnedPage (parent.getTable (), whichPage);
-	} else {
-		myPage = parent.getBufferMgr ()->getPage (parent.getTable (), whichPage);
-	}
+	myPage = parent.getPage (whichPage, pinned, nullptr);
 	pageSize = parent.getBufferMgr ()->getPageSize ();
+	if (parent.isMapped ())
+		readOnlyTable = parent.getTable ();
 }
 
 MyDB_PageReaderWriter :: MyDB_PageReaderWriter (MyDB_BufferManager &parent) {
@@ -59,7 +68,15 @@ MyDB_PageReaderWriter :: MyDB_PageReaderWriter (bool pinned, MyDB_BufferManager
 	clear ();
 }
 
+void MyDB_PageReaderWriter :: checkWritable () {
+	if (readOnlyTable != nullptr) {
+		cout << "Table " << readOnlyTable->getName () << " was opened read-only, and can't be changed.\n";
+		exit (1);
+	}
+}
+
 void MyDB_PageReaderWriter :: clear () {
+	checkWritable ();
 	NUM_BYTES_USED = 2 * sizeof (size_t);
 	PAGE_TYPE = MyDB_PageType :: RegularPage;
 	myPage->wroteBytes ();	
@@ -82,6 +99,7 @@ MyDB_RecordIteratorAltPtr MyDB_PageReaderWriter :: getIteratorAlt () {
 }
 
 void MyDB_PageReaderWriter :: setType (MyDB_PageType toMe) {
+	checkWritable ();
 	PAGE_TYPE = toMe;
 	myPage->wroteBytes ();	
 }
@@ -96,6 +114,7 @@ void *MyDB_PageReaderWriter :: appendAndReturnLocation (MyDB_RecordPtr appendMe)
 
 bool MyDB_PageReaderWriter :: append (MyDB_RecordPtr appendMe) {
 	
+	checkWritable ();
 	size_t recSize = appendMe->getBinarySize ();
 	if (recSize > NUM_BYTES_LEFT)
 		return false;
@@ -111,6 +130,7 @@ bool MyDB_PageReaderWriter :: append (MyDB_RecordPtr appendMe) {
 void MyDB_PageReaderWriter :: 
 	sortInPlace (function <bool ()> comparator, MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs) {
 
+	checkWritable ();
 	void *temp = malloc (pageSize);
 	memcpy (temp, myPage->getBytes (), pageSize);
 
@@ -177,6 +197,10 @@ size_t MyDB_PageReaderWriter :: getPageSize () {
 	return pageSize;
 }
 
+void MyDB_PageReaderWriter :: prefetch () {
+	myPage->getParent ().prefetch (myPage);
+}
+
 void *MyDB_PageReaderWriter :: getBytes () {
 	return myPage->getBytes ();
 }
@@ -24,8 +24,37 @@ void MyDB_PageRecIteratorAlt :: getCurrent (MyDB_RecordPtr intoMe) {
 	nextRecSize = ((char *) nextPos) - ((char *) pos);	
 }
 
+void MyDB_PageRecIteratorAlt :: getCurrentView (MyDB_RecordPtr intoMe) {
+	void *pos = bytesConsumed + (char *) myPage->getBytes ();
+ 	void *nextPos = intoMe->viewBinary (pos, myPage);
+	nextRecSize = ((char *) nextPos) - ((char *) pos);	
+}
+
 void *MyDB_PageRecIteratorAlt :: getCurrentPointer () {
-	return bytesConsumed + (char *) myPage->getBytes ();
+	void *pos = bytesConsumed + (char *) myPage->getBytes ();
+	nextRecSize = MyDB_Record :: getBinarySize (pos);
+	return pos;
+}
+
+size_t MyDB_PageRecIteratorAlt :: getBatch (MyDB_RecordBatch &batch) {
+
+	// if advance () has not been called, we are still at the first record
+	char *bytes = (char *) myPage->getBytes ();
+	size_t pos = bytesConsumed + (nextRecSize == -1 ? 0 : nextRecSize);
+	size_t end = NUM_BYTES_USED;
+
+	batch.positions.clear ();
+	while (pos != end && batch.size () < MYDB_BATCH_SIZE) {
+		batch.positions.push_back (bytes + pos);
+		pos += MyDB_Record :: getBinarySize (bytes + pos);
+	}
+	batch.page = myPage;
+	batch.base = bytes;
+
+	// and we are past all of them, so the next advance () is at the record after them
+	bytesConsumed = pos;
+	nextRecSize = 0;
+	return batch.size ();
 }
 
 bool MyDB_PageRecIteratorAlt :: advance () {
@@ -23,6 +23,10 @@ void MyDB_RunQueueIteratorAlt :: getCurrent (MyDB_RecordPtr intoMe) {
 	myIter->getCurrent (intoMe);
 }
 
+void MyDB_RunQueueIteratorAlt :: getCurrentView (MyDB_RecordPtr intoMe) {
+	pq.top ()->getCurrentView (intoMe);
+}
+
 MyDB_RunQueueIteratorAlt :: MyDB_RunQueueIteratorAlt (function <bool ()> comparator, MyDB_RecordPtr lhs, MyDB_RecordPtr rhs) : 
 	pq (IteratorComparator (comparator, lhs, rhs)) {
 	firstTime = true;
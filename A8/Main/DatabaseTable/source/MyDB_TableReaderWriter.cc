@@ -29,6 +29,7 @@ using namespace std;
 MyDB_TableReaderWriter :: MyDB_TableReaderWriter (MyDB_TablePtr forMeIn, MyDB_BufferManagerPtr myBufferIn) {
 	forMe = forMeIn;
 	myBuffer = myBufferIn;
+	mapping = nullptr;
 
 	if (forMe->lastPage () == -1) {
 		forMe->setLastPage (0);
@@ -39,6 +40,40 @@ MyDB_TableReaderWriter :: MyDB_TableReaderWriter (MyDB_TablePtr forMeIn, MyDB_Bu
 	}
 }
 
+MyDB_TableReaderWriter :: MyDB_TableReaderWriter (MyDB_TablePtr forMeIn, MyDB_BufferManagerPtr myBufferIn,
+	MyDB_AccessPattern readOnlyPattern) {
+	forMe = forMeIn;
+	myBuffer = myBufferIn;
+
+	if (forMe->lastPage () == -1) {
+		cout << "Can't open table " << forMe->getName () << " read-only, since it has no pages.\n";
+		exit (1);
+	}
+
+	mapping = myBuffer->mapTable (forMe, readOnlyPattern);
+	lastPage = make_shared <MyDB_PageReaderWriter> (*this, forMe->lastPage ());	
+}
+
+bool MyDB_TableReaderWriter :: isMapped () {
+	return mapping != nullptr;
+}
+
+MyDB_PageHandle MyDB_TableReaderWriter :: getPage (long i, bool pinned, MyDB_ScanRingPtr ring) {
+	if (mapping != nullptr)
+		return myBuffer->getMappedPage (mapping, i);
+	else if (pinned)
+		return myBuffer->getPinnedPage (forMe, i);
+	else
+		return myBuffer->getPage (forMe, i, ring);
+}
+
+void MyDB_TableReaderWriter :: checkWritable () {
+	if (mapping != nullptr) {
+		cout << "Table " << forMe->getName () << " was opened read-only, and can't be changed.\n";
+		exit (1);
+	}
+}
+
 MyDB_BufferManagerPtr MyDB_TableReaderWriter :: getBufferMgr () {
 	return myBuffer;
 }
@@ -58,7 +93,9 @@ MyDB_PageReaderWriter MyDB_TableReaderWriter :: getPinned (size_t i) {
 MyDB_PageReaderWriter MyDB_TableReaderWriter :: operator [] (size_t i) {
 	
 	// see if we are going off of the end of the file... if so, then clear those pages
-	while (i > forMe->lastPage ()) {
+	if ((int) i > forMe->lastPage ())
+		checkWritable ();
+	while ((int) i > forMe->lastPage ()) {
 		forMe->setLastPage (forMe->lastPage () + 1);
 		lastPage = make_shared <MyDB_PageReaderWriter> (*this, forMe->lastPage ());
 		lastPage->clear ();	
@@ -82,6 +119,8 @@ MyDB_PageReaderWriter MyDB_TableReaderWriter :: last () {
 
 void MyDB_TableReaderWriter :: append (MyDB_RecordPtr appendMe) {
 
+	checkWritable ();
+
 	// try to append the record on the current page...
 	if (!lastPage->append (appendMe)) {
 
@@ -96,6 +135,7 @@ void MyDB_TableReaderWriter :: append (MyDB_RecordPtr appendMe) {
 pair <vector <size_t>, size_t>  MyDB_TableReaderWriter :: loadFromTextFile (string fName) {
 
 	// empty out the database file
+	checkWritable ();
 	forMe->setLastPage (0);
 	lastPage = make_shared <MyDB_PageReaderWriter> (*this, forMe->lastPage ());
 	lastPage->clear ();
@@ -161,16 +201,27 @@ pair <vector <size_t>, size_t>  MyDB_TableReaderWriter :: loadFromTextFile (stri
 	return make_pair (returnVal, counter);
 }
 
-MyDB_RecordIteratorPtr MyDB_TableReaderWriter :: getIterator (MyDB_RecordPtr iterateIntoMe) {
-	return make_shared <MyDB_TableRecIterator> (*this, forMe, iterateIntoMe);
+MyDB_ScanRingPtr MyDB_TableReaderWriter :: getScanRing (bool bigScan) {
+
+	// a scan of a mapped table does not use any buffer pages
+	if (!bigScan || mapping != nullptr)
+		return nullptr;
+
+	// the ring is sized for the whole table, since the pieces of a table that are
+	// scanned by different threads together make up a scan of the whole table
+	return myBuffer->getScanRing (getNumPages ());
+}
+
+MyDB_RecordIteratorPtr MyDB_TableReaderWriter :: getIterator (MyDB_RecordPtr iterateIntoMe, bool bigScan) {
+	return make_shared <MyDB_TableRecIterator> (*this, forMe, iterateIntoMe, getScanRing (bigScan));
 }
 
-MyDB_RecordIteratorAltPtr MyDB_TableReaderWriter :: getIteratorAlt () {
-	return make_shared <MyDB_TableRecIteratorAlt> (*this, forMe);
+MyDB_RecordIteratorAltPtr MyDB_TableReaderWriter :: getIteratorAlt (bool bigScan) {
+	return make_shared <MyDB_TableRecIteratorAlt> (*this, forMe, getScanRing (bigScan));
 }
 
-MyDB_RecordIteratorAltPtr MyDB_TableReaderWriter :: getIteratorAlt (int lowPage, int highPage) {
-	return make_shared <MyDB_TableRecIteratorAlt> (*this, forMe, lowPage, highPage);
+MyDB_RecordIteratorAltPtr MyDB_TableReaderWriter :: getIteratorAlt (int lowPage, int highPage, bool bigScan) {
+	return make_shared <MyDB_TableRecIteratorAlt> (*this, forMe, lowPage, highPage, getScanRing (bigScan));
 }
 
 void MyDB_TableReaderWriter :: writeIntoTextFile (string fName) {
@@ -25,23 +25,40 @@ void *MyDB_TableRecIterator :: getCurrentPointer () {
 }
 
 bool MyDB_TableRecIterator :: hasNext () {
-	if (myParent[curPage].getType () == MyDB_PageType :: RegularPage && myIter->hasNext ())
+	if (MyDB_PageReaderWriter (myParent, curPage, ring).getType () == MyDB_PageType :: RegularPage && myIter->hasNext ())
 		return true;
 
 	if (curPage == myTable->lastPage ())
 		return false;
 
 	curPage++;
-	myIter = myParent[curPage].getIterator (myRec);
+	myIter = MyDB_PageReaderWriter (myParent, curPage, ring).getIterator (myRec);
+	prefetchNext ();
 	return hasNext ();
 }
 
+void MyDB_TableRecIterator :: prefetchNext () {
+
+	// the kernel does the read-ahead for a mapped table
+	if (myParent.isMapped ())
+		return;
+
+	// the pages being read ahead are handed to the buffer manager as one batch
+	vector <MyDB_PageHandle> batch;
+	readAhead.moveTo (curPage, myTable->lastPage (), [&] (long i) {
+		batch.push_back (myParent.getBufferMgr ()->getPage (myTable, i));
+	});
+	myParent.getBufferMgr ()->prefetch (batch);
+}
+
 MyDB_TableRecIterator :: MyDB_TableRecIterator (MyDB_TableReaderWriter &myParent, MyDB_TablePtr myTableIn,
-	MyDB_RecordPtr myRecIn) : myParent (myParent) {
+	MyDB_RecordPtr myRecIn, MyDB_ScanRingPtr ringIn) : myParent (myParent) {
 	myTable = myTableIn;
 	myRec = myRecIn;
+	ring = ringIn;
 	curPage = 0;
-	myIter = myParent[curPage].getIterator (myRec);		
+	myIter = MyDB_PageReaderWriter (myParent, curPage, ring).getIterator (myRec);
+	prefetchNext ();
 }
 
 MyDB_TableRecIterator :: ~MyDB_TableRecIterator () {}
@@ -20,38 +20,81 @@ void MyDB_TableRecIteratorAlt :: getCurrent (MyDB_RecordPtr intoMe) {
 	myIter->getCurrent (intoMe);
 }
 
+void MyDB_TableRecIteratorAlt :: getCurrentView (MyDB_RecordPtr intoMe) {
+	myIter->getCurrentView (intoMe);
+}
+
 void *MyDB_TableRecIteratorAlt :: getCurrentPointer () {
 	return myIter->getCurrentPointer ();
 }
 
 bool MyDB_TableRecIteratorAlt :: advance () {
 
-	if (myParent[curPage].getType () == MyDB_PageType :: RegularPage && myIter->advance ())
+	if (MyDB_PageReaderWriter (myParent, curPage, ring).getType () == MyDB_PageType :: RegularPage && myIter->advance ())
 		return true;
 
 	if (curPage == myTable->lastPage () || curPage == highPage)
 		return false;
 
 	curPage++;
-	myIter = myParent[curPage].getIteratorAlt ();
+	myIter = MyDB_PageReaderWriter (myParent, curPage, ring).getIteratorAlt ();
+	prefetchNext ();
 	return advance ();
 }
 
+size_t MyDB_TableRecIteratorAlt :: getBatch (MyDB_RecordBatch &batch) {
+
+	while (true) {
+		if (MyDB_PageReaderWriter (myParent, curPage, ring).getType () == MyDB_PageType :: RegularPage &&
+			myIter->getBatch (batch) != 0)
+			return batch.size ();
+
+		if (curPage == myTable->lastPage () || curPage == highPage) {
+			batch.positions.clear ();
+			return 0;
+		}
+
+		curPage++;
+		myIter = MyDB_PageReaderWriter (myParent, curPage, ring).getIteratorAlt ();
+		prefetchNext ();
+	}
+}
+
+void MyDB_TableRecIteratorAlt :: prefetchNext () {
+
+	// the kernel does the read-ahead for a mapped table
+	if (myParent.isMapped ())
+		return;
+
+	long lastPage = myTable->lastPage () < highPage ? myTable->lastPage () : highPage;
+
+	// the pages being read ahead are handed to the buffer manager as one batch
+	vector <MyDB_PageHandle> batch;
+	readAhead.moveTo (curPage, lastPage, [&] (long i) {
+		batch.push_back (myParent.getBufferMgr ()->getPage (myTable, i));
+	});
+	myParent.getBufferMgr ()->prefetch (batch);
+}
+
 MyDB_TableRecIteratorAlt :: MyDB_TableRecIteratorAlt (MyDB_TableReaderWriter &myParent, MyDB_TablePtr myTableIn,
-	int lowPage, int highPageIn) :
+	int lowPage, int highPageIn, MyDB_ScanRingPtr ringIn) :
 	myParent (myParent) {
 	myTable = myTableIn;
+	ring = ringIn;
 	curPage = lowPage;
 	highPage = highPageIn;
-	myIter = myParent[curPage].getIteratorAlt ();		
+	myIter = MyDB_PageReaderWriter (myParent, curPage, ring).getIteratorAlt ();
+	prefetchNext ();
 }
 
-MyDB_TableRecIteratorAlt :: MyDB_TableRecIteratorAlt (MyDB_TableReaderWriter &myParent, MyDB_TablePtr myTableIn) :
-	myParent (myParent) {
+MyDB_TableRecIteratorAlt :: MyDB_TableRecIteratorAlt (MyDB_TableReaderWriter &myParent, MyDB_TablePtr myTableIn,
+	MyDB_ScanRingPtr ringIn) : myParent (myParent) {
 	myTable = myTableIn;
+	ring = ringIn;
 	curPage = 0;
 	highPage = 1999999999;
-	myIter = myParent[curPage].getIteratorAlt ();		
+	myIter = MyDB_PageReaderWriter (myParent, curPage, ring).getIteratorAlt ();
+	prefetchNext ();
 }
 
 MyDB_TableRecIteratorAlt :: ~MyDB_TableRecIteratorAlt () {}
@@ -0,0 +1,157 @@
+
+#ifndef EXPR_BENCH_C
+#define EXPR_BENCH_C
+
+#include <chrono>
+#include <iostream>
+#include "MyDB_BufferManager.h"
+#include "MyDB_ExprKernel.h"
+#include "MyDB_Record.h"
+#include "MyDB_RecordBatch.h"
+#include "MyDB_SimdKernels.h"
+#include "MyDB_Table.h"
+#include "MyDB_TableReaderWriter.h"
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+// the number of times that each predicate is run over the whole table
+#define BENCH_REPS 10
+
+// the supplier schema, with the given prefix on each attribute name
+MyDB_SchemaPtr supplierSchema (string prefix) {
+	MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema> ();
+	mySchema->appendAtt (make_pair (prefix + "suppkey", make_shared <MyDB_IntAttType> ()));
+	mySchema->appendAtt (make_pair (prefix + "name", make_shared <MyDB_StringAttType> ()));
+	mySchema->appendAtt (make_pair (prefix + "address", make_shared <MyDB_StringAttType> ()));
+	mySchema->appendAtt (make_pair (prefix + "nationkey", make_shared <MyDB_IntAttType> ()));
+	mySchema->appendAtt (make_pair (prefix + "phone", make_shared <MyDB_StringAttType> ()));
+	mySchema->appendAtt (make_pair (prefix + "acctbal", make_shared <MyDB_DoubleAttType> ()));
+	mySchema->appendAtt (make_pair (prefix + "comment", make_shared <MyDB_StringAttType> ()));
+	return mySchema;
+}
+
+// loads each of the records into myRec and runs the predicate, returning the number of
+// nanoseconds per record; the number of records accepted is put into count
+double timePredicate (vector <string> &records, MyDB_RecordPtr myRec, function <bool ()> pred, long &count) {
+	count = 0;
+	auto begin = chrono::high_resolution_clock::now ();
+	for (int i = 0; i < BENCH_REPS; i++) {
+		for (auto &r : records) {
+			myRec->fromBinary ((void *) r.data ());
+			count += pred ();
+		}
+	}
+	auto end = chrono::high_resolution_clock::now ();
+	return chrono::duration_cast <chrono::nanoseconds> (end - begin).count () / (double) (BENCH_REPS * records.size ());
+}
+
+// runs the kernel over the records a batch at a time, returning the number of nanoseconds
+// per record; the number of records accepted is put into count
+double timeKernel (vector <string> &records, MyDB_ExprKernel &kernel, long &count) {
+	vector <void *> positions;
+	for (auto &r : records)
+		positions.push_back ((void *) r.data ());
+	vector <int> selected (MYDB_BATCH_SIZE);
+
+	count = 0;
+	auto begin = chrono::high_resolution_clock::now ();
+	for (int i = 0; i < BENCH_REPS; i++) {
+		for (size_t j = 0; j < positions.size (); j += MYDB_BATCH_SIZE) {
+			size_t n = (positions.size () - j < MYDB_BATCH_SIZE) ? positions.size () - j : MYDB_BATCH_SIZE;
+			count += kernel.select (positions.data () + j, n, selected.data ());
+		}
+	}
+	auto end = chrono::high_resolution_clock::now ();
+	return chrono::duration_cast <chrono::nanoseconds> (end - begin).count () / (double) (BENCH_REPS * records.size ());
+}
+
+// compares the three ways of evaluating the selection predicates used by the rel op unit
+// tests: the original computations, the typed closures, the bytecode programs, and the
+// batch kernels, with the plain loops and with the best vector loops that the CPU has
+int main () {
+
+	// load up the supplier table, and copy all of its records into memory, so that the
+	// benchmark only measures loading records and running the predicates
+	MyDB_BufferManagerPtr myMgr = make_shared <MyDB_BufferManager> (131072, 128, "tempFile");
+	MyDB_TablePtr myTable = make_shared <MyDB_Table> ("supplier", "exprBench.bin", supplierSchema (""));
+	MyDB_TableReaderWriter supplierTable (myTable, myMgr);
+	supplierTable.loadFromTextFile ("supplierBig.tbl");
+
+	vector <string> records;
+	MyDB_RecordPtr temp = supplierTable.getEmptyRecord ();
+	MyDB_RecordIteratorAltPtr myIter = supplierTable.getIteratorAlt ();
+	while (myIter->advance ()) {
+		myIter->getCurrent (temp);
+		string bytes (temp->getBinarySize (), 0);
+		temp->toBinary (&bytes[0]);
+		records.push_back (bytes);
+	}
+
+	// the predicates, and the prefix on the attribute names that they use
+	vector <pair <string, string>> preds = {
+		{"l_", "== ([l_nationkey], int[1])"},
+		{"l_", "&& (== ([l_nationkey], int[1]), > ([l_name], string [Supplier#000009378]))"},
+		{"l_", "|| ( == ([l_nationkey], int[3]), == ([l_nationkey], int[4]))"},
+		{"r_", "== ([r_nationkey], int[3])"},
+		{"l_", "&& ( > ([l_name], string[Supplier#000002243]), < ([l_name], string[Supplier#000002303]))"},
+		{"r_", "&& (&& ( > ([r_address], string[aa]), < ([r_address], string[ab])), > ([r_name], string[Supplier#000009000]))"},
+		{"r_", "< ([r_suppkey], int[10])"},
+		{"l_", "&& (< ([l_acctbal], int[4500]), > ([l_acctbal], int[4450]))"},
+		{"l_", "< ([l_nationkey], int[2])"}};
+
+	cout << "ns per record (" << records.size () << " records)\n";
+	MyDB_SimdLevel best = MyDB_SimdKernels :: getBestLevel ();
+	cout << "vector loops: " << (best == SimdAVX2 ? "AVX2" : best == SimdSSE42 ? "SSE4.2" : "none") << "\n";
+	cout << "(computation and closures use the fast path for a predicate marked with a *)\n";
+	cout << "load only\tcomputation\tclosures\tbytecode\tbatch\t\tbatch simd\tinstrs\tpredicate\n";
+	for (auto &p : preds) {
+
+		MyDB_RecordPtr myRec = make_shared <MyDB_Record> (supplierSchema (p.first));
+		func computation = myRec->compileComputation (p.second);
+		function <bool ()> closures = myRec->compilePredicate (p.second);
+		function <bool ()> bytecode = myRec->compilePredicate (p.second, true);
+
+		// this is only used to see how long the program is
+		vector <MyDB_AttValPtr> noAtts;
+		MyDB_Expression expr (p.second, myRec->getSchema ());
+		MyDB_ExprProgram prog (expr, noAtts);
+
+		long loadCount, compCount, closureCount, bytecodeCount;
+		double loadTime = timePredicate (records, myRec, [] {return true;}, loadCount);
+		double compTime = timePredicate (records, myRec, [&computation] {return computation ()->toBool ();}, compCount);
+		double closureTime = timePredicate (records, myRec, closures, closureCount);
+		double bytecodeTime = timePredicate (records, myRec, bytecode, bytecodeCount);
+
+		// the kernels read the records' bytes themselves, so there is no loading to do
+		MyDB_ExprKernel kernel (p.second, myRec);
+		long plainCount, simdCount;
+		MyDB_SimdKernels :: setLevel (SimdScalar);
+		double plainTime = timeKernel (records, kernel, plainCount);
+		MyDB_SimdKernels :: setLevel (best);
+		double simdTime = timeKernel (records, kernel, simdCount);
+
+		if (compCount != closureCount || compCount != bytecodeCount || compCount != plainCount || compCount != simdCount) {
+			cout << "Got different answers for " << p.second << ": " << compCount << ", " << closureCount
+				<< ", " << bytecodeCount << ", " << plainCount << ", " << simdCount << "\n";
+			exit (1);
+		}
+
+		cout << loadTime << "\t\t" << compTime << "\t\t" << closureTime << "\t\t" << bytecodeTime << "\t\t"
+			<< plainTime << "\t\t" << simdTime << "\t\t" << prog.getNumInstructions () << "\t" << (MyDB_FastPredicate :: matches (expr.getRoot ()) ? "* " : "  ")
+			<< p.second << "\n";
+	}
+
+	// each predicate was compiled twice above, so this is the same as the fraction of them
+	size_t numTried = MyDB_FastPredicate :: getNumTried ();
+	size_t numFast = MyDB_FastPredicate :: getNumFast ();
+	cout << numFast << " of " << numTried << " predicates compiled (" << (100.0 * numFast) / numTried
+		<< "%) took a fast path\n";
+
+	unlink ("exprBench.bin");
+}
+
+#endif
+
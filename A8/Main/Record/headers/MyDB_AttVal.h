@@ -35,6 +35,14 @@ public:
 	virtual void serialize (char *&buffer, size_t &allocatedSize, size_t &totSize) = 0;
 	virtual ~MyDB_AttVal ();
 
+	// these are for the offset record format (see MyDB_Record.h).  getFixedSize () is the
+	// number of bytes in the attribute's slot, or -1 if the attribute has a variable size
+	// (in which case the slot holds the offset of the data from the start of the record).
+	// serializeAt () writes the attribute into its slot at buffer + slotPos, and puts any
+	// variable-sized data at the end of the buffer, growing it as needed
+	virtual int getFixedSize () = 0;
+	virtual void serializeAt (char *&buffer, size_t &allocatedSize, size_t slotPos, size_t &totSize) = 0;
+
 	// this gets a pointer to our data... useful because we can avoid deserializing the record
 	inline void *getDataPointer () {
 		return myData;
@@ -68,7 +76,8 @@ public:
 	inline char *fromBinary (char *fromHere) {
 
 		// this is the length
-		int myLen = *((short *) fromHere);
+		short myLen;
+		memcpy (&myLen, fromHere, sizeof (short));
 
 		// remember our data
 		setBuffered (fromHere + sizeof (short));
@@ -96,6 +105,8 @@ public:
 	size_t hash () override;
 	MyDB_AttValPtr getCopy () override;
 	void serialize (char *&buffer, size_t &allocatedSize, size_t &totSize) override;
+	int getFixedSize () override;
+	void serializeAt (char *&buffer, size_t &allocatedSize, size_t slotPos, size_t &totSize) override;
 	void set (int val);
 	MyDB_IntAttVal ();
 	~MyDB_IntAttVal ();
@@ -122,6 +133,8 @@ public:
 	void set (MyDB_AttValPtr toMe) override;
 	void fromString (string &fromMe) override;
 	void serialize (char *&buffer, size_t &allocatedSize, size_t &totSize) override;
+	int getFixedSize () override;
+	void serializeAt (char *&buffer, size_t &allocatedSize, size_t slotPos, size_t &totSize) override;
 	void set (double val);
 	MyDB_DoubleAttVal ();
 	~MyDB_DoubleAttVal ();
@@ -147,8 +160,17 @@ public:
 	size_t hash () override;
 	void set (MyDB_AttValPtr toMe) override;
 	void serialize (char *&buffer, size_t &allocatedSize, size_t &totSize) override;
+	int getFixedSize () override;
+	void serializeAt (char *&buffer, size_t &allocatedSize, size_t slotPos, size_t &totSize) override;
 	void fromInt (int fromMe) override;
 	void set (string val);
+
+	// the characters of the string, without copying them; good until the attribute changes
+	inline const char *getChars () {
+		void *dataPtr = getDataPointer ();
+		return (dataPtr == nullptr) ? value.c_str () : (const char *) dataPtr;
+	}
+
 	MyDB_StringAttVal ();
 	~MyDB_StringAttVal ();
 
@@ -174,6 +196,8 @@ public:
 	size_t hash () override;
 	void fromInt (int fromMe) override;
 	void serialize (char *&buffer, size_t &allocatedSize, size_t &totSize) override;
+	int getFixedSize () override;
+	void serializeAt (char *&buffer, size_t &allocatedSize, size_t slotPos, size_t &totSize) override;
 	void set (bool val);
 	MyDB_BoolAttVal ();
 	~MyDB_BoolAttVal ();
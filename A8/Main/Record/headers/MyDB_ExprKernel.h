@@ -0,0 +1,93 @@
+
+#ifndef EXPR_KERNEL_H
+#define EXPR_KERNEL_H
+
+#include "MyDB_Expression.h"
+#include "MyDB_Record.h"
+#include "MyDB_SimdKernels.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// a predicate that is run over a batch of records at a time, rather than over one record.
+// Each node of the predicate is run over the whole batch before the next one is, so that
+// the dispatching is done once per batch, and the inner loops are simple loops over arrays.
+// The result is a selection vector: the indexes of the records that the predicate accepts.
+// A comparison narrows down the selection vector, and an && runs its right side only over
+// the records that its left side accepted (and an || only over the ones that it did not).
+//
+// The attributes are read straight out of the records' bytes; a record that is in the old
+// format is loaded into the record that the kernel was built with, instead.  Comparisons
+// and arithmetic on ints and doubles are done by the vector loops in MyDB_SimdKernels
+class MyDB_ExprKernel {
+
+public:
+
+	// compiles the predicate; rec has the schema that the predicate is over
+	MyDB_ExprKernel (string predicate, MyDB_RecordPtr rec);
+
+	// runs the predicate over the n records at the given addresses (as written by
+	// MyDB_Record.toBinary ()); the indexes of the records that are accepted are put, in
+	// order, into selected, which must have room for n of them.  Returns how many there are
+	size_t select (void **positions, size_t n, int *selected);
+
+private:
+
+	// the space used for a node while the predicate runs over a batch: its values, space
+	// for converting them, the strings that it makes, and some selection vectors
+	struct Column {
+		vector <char> values;
+		vector <char> temp;
+		vector <string> scratch;
+		vector <int> yes;
+		vector <int> no;
+		vector <int> all;
+	};
+
+	// narrows down sel (which has n entries) to the records that node accepts, returning
+	// the number that are left
+	size_t filter (MyDB_ExprNodePtr node, int *sel, size_t n);
+
+	// does a comparison of the two nodes' values, as type T, narrowing down sel
+	template <class T>
+	size_t compare (MyDB_ExprOp op, MyDB_ExprNodePtr lhs, MyDB_ExprNodePtr rhs, int *sel, size_t n);
+
+	// narrows down sel to the entries k where lhs[k] op rhs[k] (or op rhs[0], if rhsIsConst);
+	// ints and doubles are compared into a bitmap by the vector loops, and the rest one at a time
+	template <class T>
+	size_t narrow (MyDB_ExprOp op, int *sel, size_t n, T *lhs, T *rhs, bool rhsIsConst);
+	size_t narrow (MyDB_ExprOp op, int *sel, size_t n, int *lhs, int *rhs, bool rhsIsConst);
+	size_t narrow (MyDB_ExprOp op, int *sel, size_t n, double *lhs, double *rhs, bool rhsIsConst);
+
+	// compute the node over each of the n records in sel, putting the results into out,
+	// converted to the type of out
+	void eval (MyDB_ExprNodePtr node, int *sel, size_t n, int *out);
+	void eval (MyDB_ExprNodePtr node, int *sel, size_t n, double *out);
+	void eval (MyDB_ExprNodePtr node, int *sel, size_t n, char *out);
+	void eval (MyDB_ExprNodePtr node, int *sel, size_t n, const char **out);
+
+	// gets the column for the node, with room for n records
+	Column &getColumn (MyDB_ExprNodePtr node, size_t n);
+
+	// gets room for n values of type T in the node's column (or in its space for conversions)
+	template <class T>
+	T *valuesOf (MyDB_ExprNodePtr node, size_t n, bool temp = false);
+
+	// the predicate, and the record used to find attributes
+	MyDB_Expression expr;
+	MyDB_RecordPtr rec;
+
+	// the columns for all of the nodes
+	unordered_map <MyDB_ExprNode *, Column> columns;
+
+	// the records in the batch that is being run
+	void **positions;
+
+	// the bitmap that the vector comparisons write
+	vector <uint64_t> bits;
+};
+
+#endif
+
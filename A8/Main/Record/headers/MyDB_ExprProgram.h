@@ -0,0 +1,124 @@
+
+#ifndef EXPR_PROGRAM_H
+#define EXPR_PROGRAM_H
+
+#include "MyDB_AttVal.h"
+#include "MyDB_Expression.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// the instructions that a program can run; each one works on registers of a single
+// type, which is given by its name
+enum MyDB_ExprOpCode {
+
+	// dest <- attribute number arg1 of the record
+	LoadIntAtt, LoadDoubleAtt, LoadBoolAtt, LoadStringAtt,
+
+	// dest <- converted arg1
+	IntToDouble, IntToString, DoubleToString, BoolToString,
+
+	// dest <- arg1 op arg2 (or op arg1, for the negations and Not)
+	AddInt, SubInt, MulInt, DivInt, NegInt,
+	AddDouble, SubDouble, MulDouble, DivDouble, NegDouble,
+	ConcatString,
+	GtInt, LtInt, EqInt, NeqInt,
+	GtDouble, LtDouble, EqDouble, NeqDouble,
+	EqBool, NeqBool, Not,
+	GtString, LtString, EqString, NeqString,
+
+	// dest <- arg1
+	MoveBool,
+
+	// go to instruction arg2 if bool register arg1 is false (or true)
+	JumpIfFalse, JumpIfTrue
+};
+
+// a single instruction
+struct MyDB_ExprInstr {
+	MyDB_ExprOpCode code;
+	int dest;
+	int arg1;
+	int arg2;
+};
+
+// create a smart pointer for programs
+class MyDB_ExprProgram;
+typedef shared_ptr <MyDB_ExprProgram> MyDB_ExprProgramPtr;
+
+// an expression (see MyDB_Expression.h), lowered to a list of instructions over typed
+// registers.  There is a separate register file for each type, and every node of the
+// expression tree gets its own register.  Parts of the expression that do not look at
+// the record are computed once, when the program is built, and literals are put into
+// their registers up front, so running the program only loads attributes and does the
+// operations.  An && or an || jumps over its right side when the left side decides it.
+//
+// Like the closures built by MyDB_Expression, a program looks at whatever the attributes
+// hold when it is run, and a string that it returns is good until it is next run.  Since
+// the registers live in the program, a program should only be run by one thread at a time
+class MyDB_ExprProgram {
+
+public:
+
+	// lower the expression; atts are the attributes of the record it is run over
+	MyDB_ExprProgram (MyDB_Expression &expr, vector <MyDB_AttValPtr> &atts);
+
+	// run the program, returning the result as the requested type; as with the closures,
+	// an int can become a double, and anything can become a string
+	bool runBool ();
+	int runInt ();
+	double runDouble ();
+	const char *runString ();
+
+	// the type of the result
+	MyDB_ExprType getType ();
+
+	// the number of instructions
+	size_t getNumInstructions ();
+
+private:
+
+	// runs the instructions
+	void run ();
+
+	// adds the instructions for the node, returning the register holding its result
+	int lower (MyDB_ExprNodePtr node);
+
+	// like lower (), but the result is converted to the given type
+	int lowerAs (MyDB_ExprNodePtr node, MyDB_ExprType type);
+
+	// adds an instruction to convert the register to the given type
+	int convert (int reg, MyDB_ExprType from, MyDB_ExprType to);
+
+	// gets a new register of the given type
+	int newRegister (MyDB_ExprType type);
+
+	// adds an instruction
+	int emit (MyDB_ExprOpCode code, int dest, int arg1, int arg2);
+
+	// replaces any part of the tree that does not look at the record with a literal
+	static MyDB_ExprNodePtr fold (MyDB_ExprNodePtr node);
+
+	// the program
+	vector <MyDB_ExprInstr> instrs;
+
+	// the registers; a string register points either into the record, or at its scratch string
+	vector <int> intRegs;
+	vector <double> doubleRegs;
+	vector <char> boolRegs;
+	vector <const char *> stringRegs;
+	vector <string> stringScratch;
+
+	// where the result is, and where runString () puts it if it is not a string
+	MyDB_ExprType resultType;
+	int resultReg;
+	string resultScratch;
+
+	// the record's attributes
+	vector <MyDB_AttValPtr> *atts;
+};
+
+#endif
+
@@ -0,0 +1,106 @@
+
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <functional>
+#include "MyDB_AttVal.h"
+#include "MyDB_Schema.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// the types that an expression over a record can have
+enum MyDB_ExprType {IntExpr, DoubleExpr, StringExpr, BoolExpr};
+
+// the operations in an expression
+enum MyDB_ExprOp {ExprAtt, ExprIntLit, ExprDoubleLit, ExprStringLit, ExprBoolLit, ExprPlus, ExprMinus, ExprTimes,
+	ExprDivide, ExprNegate, ExprGt, ExprLt, ExprEq, ExprNeq, ExprAnd, ExprOr, ExprNot};
+
+// create a smart pointer for expression nodes
+class MyDB_ExprNode;
+typedef shared_ptr <MyDB_ExprNode> MyDB_ExprNodePtr;
+
+// a node in a parsed expression; all of the types are worked out when the expression is parsed
+class MyDB_ExprNode {
+
+public:
+
+	MyDB_ExprOp op;
+
+	// the type of the result
+	MyDB_ExprType type;
+
+	// for arithmetic and comparisons, the type that both arguments are converted to first
+	MyDB_ExprType argType;
+
+	// the arguments; rhs is nullptr for the unary operations
+	MyDB_ExprNodePtr lhs;
+	MyDB_ExprNodePtr rhs;
+
+	// for an attribute, its position in the record; for a literal, its value
+	int whichAtt;
+	int intVal;
+	double doubleVal;
+	bool boolVal;
+	string stringVal;
+};
+
+// an expression in the prefix language taken by MyDB_Record.compileComputation (), such
+// as "+ ( [firstAtt], / ([secAtt], [secAtt]))".  The expression is parsed into a tree,
+// and the type of every node is resolved up front, using the same rules for promoting
+// ints to doubles (and anything to a string) that the record's computations use.  The
+// tree can then be compiled into typed closures: each node becomes a function that
+// returns a plain int, double, bool or C string, and that calls its children's functions
+// directly.  Attributes are read in place from the record's bytes, so evaluation does not
+// make any virtual calls or allocations, or copy any smart pointers
+class MyDB_Expression {
+
+public:
+
+	// parse the expression, looking up the attributes in the given schema
+	MyDB_Expression (string text, MyDB_SchemaPtr schema);
+
+	// the type of the expression's result, and the tree itself
+	MyDB_ExprType getType ();
+	MyDB_ExprNodePtr getRoot ();
+
+	// these build closures that compute the expression over the given attributes (a
+	// record's attributes, in the order of the schema); the closures look at whatever the
+	// attributes hold when they are called.  The result is converted to the requested
+	// type; an int can become a double, and anything can become a string.  A string
+	// that is returned is good until the closure is next called
+	function <bool ()> compileBool (vector <MyDB_AttValPtr> &atts);
+	function <int ()> compileInt (vector <MyDB_AttValPtr> &atts);
+	function <double ()> compileDouble (vector <MyDB_AttValPtr> &atts);
+	function <const char *()> compileString (vector <MyDB_AttValPtr> &atts);
+
+	// builds a closure that is true when lhs, over lhsAtts, is less than rhs, over rhsAtts
+	static function <bool ()> compileLessThan (MyDB_Expression &lhs, vector <MyDB_AttValPtr> &lhsAtts,
+		MyDB_Expression &rhs, vector <MyDB_AttValPtr> &rhsAtts);
+
+	// the type that both arguments of the operation are converted to, given their types;
+	// exits if the operation cannot be done on them
+	static MyDB_ExprType resolveArgType (MyDB_ExprOp op, MyDB_ExprType lhs, MyDB_ExprType rhs);
+
+	// the same closures as above, for any node of a tree
+	static function <bool ()> makeBool (MyDB_ExprNodePtr node, vector <MyDB_AttValPtr> &atts);
+	static function <int ()> makeInt (MyDB_ExprNodePtr node, vector <MyDB_AttValPtr> &atts);
+	static function <double ()> makeDouble (MyDB_ExprNodePtr node, vector <MyDB_AttValPtr> &atts);
+	static function <const char *()> makeString (MyDB_ExprNodePtr node, vector <MyDB_AttValPtr> &atts);
+
+private:
+
+	// the parser; these are just like the ones that the record uses for compileComputation ()
+	MyDB_ExprNodePtr parse (char *&vals);
+	MyDB_ExprNodePtr parseBinary (MyDB_ExprOp op, char *&vals);
+	MyDB_ExprNodePtr parseUnary (MyDB_ExprOp op, char *&vals);
+	char *findsymbol (char val, char *input);
+
+	MyDB_ExprNodePtr root;
+	MyDB_SchemaPtr schema;
+};
+
+#endif
+
@@ -0,0 +1,47 @@
+
+#ifndef FAST_PREDICATE_H
+#define FAST_PREDICATE_H
+
+#include <atomic>
+#include <functional>
+#include "MyDB_AttVal.h"
+#include "MyDB_Expression.h"
+#include <vector>
+
+using namespace std;
+
+// most predicates are a conjunction of comparisons between an attribute and a literal
+// (or another attribute of the same type), such as
+//
+// && (== ([l_nationkey], int[1]), > ([l_name], string [Supplier#000009378]))
+//
+// For those, there is a comparison that is specialized (by a template) for the type, the
+// operation, and whether the right side is a literal or an attribute; it reads the attribute
+// and compares it in one call, rather than calling a closure for each side.  Anything else
+// is left to the general path
+class MyDB_FastPredicate {
+
+public:
+
+	// if the expression has one of the shapes above, put a function that computes it over
+	// the given attributes (a record's attributes, in the order of the schema) into result,
+	// and return true; otherwise, return false.  Every predicate that is tried is counted
+	static bool compile (MyDB_Expression &expr, vector <MyDB_AttValPtr> &atts, function <bool ()> &result);
+
+	// true if the node has one of the shapes above
+	static bool matches (MyDB_ExprNodePtr node);
+
+	// the number of predicates that have been tried, and the number that took a fast path
+	static size_t getNumTried ();
+	static size_t getNumFast ();
+
+private:
+
+	// builds the function for a node that matches
+	static function <bool ()> build (MyDB_ExprNodePtr node, vector <MyDB_AttValPtr> &atts);
+
+	static atomic <size_t> numTried;
+	static atomic <size_t> numFast;
+};
+
+#endif
@@ -17,6 +17,7 @@ public:
 		values.push_back (myAtt);
 		values.push_back (make_shared <MyDB_IntAttVal> ());	
 		bufferOld = true;
+		layoutOld = true;
 	}
 
 	int getPtr () {
@@ -31,6 +32,7 @@ public:
 	void setKey (MyDB_AttValPtr toMe) {
 		values[0] = toMe;
 		bufferOld = true;
+		layoutOld = true;
 	}
 
 	MyDB_AttValPtr getKey () {
@@ -4,6 +4,10 @@
 
 #include <functional>
 #include "MyDB_AttVal.h"
+#include "MyDB_Expression.h"
+#include "MyDB_ExprProgram.h"
+#include "MyDB_FastPredicate.h"
+#include "MyDB_PageHandle.h"
 #include "MyDB_Schema.h"
 #include <memory>
 #include <string>
@@ -31,6 +35,12 @@ public:
 	// get the number of bytes required to store the record as a binary string
 	size_t getBinarySize ();
 
+	// get the number of bytes in the record that toBinary () wrote at the given address
+	static inline size_t getBinarySize (void *fromHere) {
+		short header = getHeader (fromHere);
+		return (header < 0) ? -header : header;
+	}
+
 	// makes it so that this record is a composite of the two input records
 	void buildFrom (MyDB_RecordPtr left, MyDB_RecordPtr right);
 
@@ -43,6 +53,14 @@ public:
 	// }
 	// 	
 	// would write 10 copies of the record to the location pointed to by startLoc
+	//
+	// records are written in the offset format: a short holding the negated size of the
+	// record, then a slot for each attribute (four bytes for an int, eight for a double,
+	// one for a bool, and for a string, a two-byte offset from the start of the record to
+	// the string's bytes), then the strings.  Since the slots are at the same place in
+	// every record with a given schema, attribute i can be found without looking at the
+	// attributes before it.  fromBinary () also reads the old format, where the short
+	// holds the (positive) size, and each attribute has its own two-byte length
 	void *toBinary (void *toHere);
 
 	// this method should be called whenever we want to write the record to a page, but
@@ -62,6 +80,31 @@ public:
 	// 	
 	void *fromBinary (void *startPos);
 
+	// like fromBinary (), except that the bytes are not copied: the record becomes a view
+	// of them, and its attributes are read in place.  If the bytes are on a page, the
+	// page should be given, and the record holds on to it so that the page object does
+	// not go away.  The view is good only until the page's bytes can move; that is, until
+	// the next call into the buffer manager that could evict the page, unless the page
+	// is pinned.  The record stops being a view when it is next loaded or written
+	void *viewBinary (void *startPos, const MyDB_PageHandle &onPage = MyDB_PageHandle ());
+
+	// if the record is a view, copy the bytes into the record, so that it no longer
+	// depends on the page; this is what to do before a view is kept across a call that
+	// could evict its page
+	void materialize ();
+
+	// the address of attribute i in the record that toBinary () wrote at the given address,
+	// without loading the record; for a string, this is the address of its characters.
+	// Returns a nullptr if the record is in the old format, where the attributes can only be
+	// found by loading it
+	inline char *getAttAddress (void *fromHere, size_t i) {
+		if (getHeader (fromHere) >= 0)
+			return nullptr;
+		if (layoutOld)
+			computeLayout ();
+		return findAtt ((char *) fromHere, i);
+	}
+
 	// parse the contents of this record from the given string
 	void fromString (string fromMe);
 
@@ -98,7 +141,20 @@ public:
 	// the entire file, computing the function after each new record is loaded, without
 	// recompiling the function.
 	//
-	func compileComputation (string fromMe);
+	// If asBytecode is true, the computation is lowered to a MyDB_ExprProgram, and the
+	// function runs that program; the result is the same either way.  Otherwise, a predicate
+	// that is a conjunction of comparisons between attributes and literals is compiled by
+	// MyDB_FastPredicate, and anything else is built by compileHelper ().
+	//
+	func compileComputation (string fromMe, bool asBytecode = false);
+
+	// like compileComputation, but for a computation that produces a bool (such as a
+	// selection predicate); the computation is compiled by MyDB_Expression into typed
+	// closures, so checking it does not allocate any MyDB_AttVal objects.  Exits if the
+	// computation does not produce a bool.  As with compileComputation, the common shapes of
+	// predicate go to MyDB_FastPredicate.  If asBytecode is true, the predicate is lowered to
+	// a MyDB_ExprProgram instead
+	function <bool ()> compilePredicate (string fromMe, bool asBytecode = false);
 
 	// builds a function that returns true if lhs < rhs; the comparison is done by running whatever computation is 
 	// encoded by the string "computation" on both lhs and rhs, and then compariing the results obtained using this
@@ -126,6 +182,19 @@ private:
 	// the amount of data in the record buffer
 	size_t recSize;
 
+	// the record is serialized here, and then this is swapped with the buffer
+	char *spare;
+	size_t spareSize;
+
+	// if the record is a view, the bytes that it is viewing (or nullptr), and the page
+	// that they are on
+	char *view;
+	size_t viewSize;
+	MyDB_PageHandle viewPage;
+
+	// the record is no longer a view
+	void endView ();
+
 	// helper function for the compilation
 	pair <func, MyDB_AttTypePtr> compileHelper (char * &vals);
 
@@ -153,6 +222,35 @@ private:
 	// true when the set of attributes don't match the attribute buffer
 	bool bufferOld;
 
+	// where each attribute's slot is in the offset format, and whether the slot holds the
+	// offset of the data (rather than the data itself); also, where the slots end
+	vector <pair <size_t, bool>> slots;
+	size_t slotsEnd;
+
+	// true when the slots need to be recomputed, because the attributes have changed
+	bool layoutOld;
+
+	// compute the slots from the types of the attributes
+	void computeLayout ();
+
+	// find attribute i in a record in the offset format
+	inline char *findAtt (char *rec, size_t i) {
+		char *slot = rec + slots[i].first;
+		if (!slots[i].second)
+			return slot;
+		unsigned short offset;
+		memcpy (&offset, slot, sizeof (unsigned short));
+		return rec + offset;
+	}
+
+	// the size (negated for the offset format) at the start of a record written by
+	// toBinary (); records are packed into pages, so it is not necessarily aligned
+	static inline short getHeader (void *fromHere) {
+		short header;
+		memcpy (&header, fromHere, sizeof (short));
+		return header;
+	}
+
 	// this is a subtype
 	friend class MyDB_INRecord;
 
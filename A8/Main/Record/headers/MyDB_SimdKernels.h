@@ -0,0 +1,47 @@
+
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include "MyDB_Expression.h"
+#include <stdint.h>
+#include <stddef.h>
+
+using namespace std;
+
+// the instruction sets that the kernels can be run with
+enum MyDB_SimdLevel {SimdScalar, SimdSSE42, SimdAVX2};
+
+// the inner loops of MyDB_ExprKernel, for int and double columns: the comparisons (==, !=,
+// <, >) and the arithmetic (+, -, *, /), each of a column against another column or against
+// a constant.  There is a version of each loop for AVX2, one for SSE4.2, and a plain one;
+// the best one that the CPU can run is picked when the program starts.  A comparison gives
+// a bitmap, with one bit per entry, that says which entries it holds for.
+//
+// An int divide is always done one entry at a time, since there is no vector instruction
+// for it, and dividing by zero should fail just like it does everywhere else
+class MyDB_SimdKernels {
+
+public:
+
+	// sets bit k of bits (bit k % 64 of word k / 64) to lhs[k] op rhs[k], or to lhs[k] op
+	// rhs[0] when rhsIsConst; bits must have room for (n + 63) / 64 words
+	static void compare (MyDB_ExprOp op, const int *lhs, const int *rhs, bool rhsIsConst, size_t n, uint64_t *bits);
+	static void compare (MyDB_ExprOp op, const double *lhs, const double *rhs, bool rhsIsConst, size_t n, uint64_t *bits);
+
+	// sets out[k] to lhs[k] op rhs[k], or to lhs[k] op rhs[0] when rhsIsConst; out can be
+	// the same as lhs
+	static void arith (MyDB_ExprOp op, const int *lhs, const int *rhs, bool rhsIsConst, size_t n, int *out);
+	static void arith (MyDB_ExprOp op, const double *lhs, const double *rhs, bool rhsIsConst, size_t n, double *out);
+
+	// the instruction set that the kernels are using
+	static MyDB_SimdLevel getLevel ();
+
+	// has the kernels use the given instruction set (or the best one that the CPU can run,
+	// if it cannot run that one); this is for comparing them against each other
+	static void setLevel (MyDB_SimdLevel level);
+
+	// the best instruction set that the CPU can run
+	static MyDB_SimdLevel getBestLevel ();
+};
+
+#endif
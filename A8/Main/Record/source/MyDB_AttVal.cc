@@ -15,8 +15,11 @@ int MyDB_IntAttVal :: toInt () {
 	void *dataPtr = getDataPointer ();
 	if (dataPtr == nullptr) 
 		return value;
-	else
-		return *((int *) dataPtr);
+
+	// the value may be anywhere in the record, so it is not necessarily aligned
+	int returnVal;
+	memcpy (&returnVal, dataPtr, sizeof (int));
+	return returnVal;
 }
 
 void MyDB_IntAttVal :: fromInt (int fromMe) {
@@ -25,19 +28,11 @@ void MyDB_IntAttVal :: fromInt (int fromMe) {
 }
 
 double MyDB_IntAttVal :: toDouble () {
-	void *dataPtr = getDataPointer ();
-	if (dataPtr == nullptr) 
-		return (double) value;
-	else
-		return (double) *((int *) dataPtr);
+	return (double) toInt ();
 }
 
 string MyDB_IntAttVal :: toString () {
-	void *dataPtr = getDataPointer ();
-	if (dataPtr == nullptr) 
-		return to_string (value);
-	else
-		return to_string (*((int *) dataPtr));
+	return to_string (toInt ());
 }
 
 void MyDB_IntAttVal :: set (MyDB_AttValPtr fromMe) {
@@ -90,12 +85,23 @@ void MyDB_IntAttVal :: serialize (char *&buffer, size_t &allocatedSize, size_t &
 
 	extendBuffer (buffer, allocatedSize, totSize, sizeof (int) + sizeof (short));
 
-	*((short *) (buffer + totSize)) = (short) (sizeof (short) + sizeof (int));
+	short len = (short) (sizeof (short) + sizeof (int));
+	int val = toInt ();
+	memcpy (buffer + totSize, &len, sizeof (short));
 	totSize += sizeof (short);
-	*((int *) (buffer + totSize)) = toInt ();
+	memcpy (buffer + totSize, &val, sizeof (int));
 	totSize += sizeof (int);
 }
 
+int MyDB_IntAttVal :: getFixedSize () {
+	return sizeof (int);
+}
+
+void MyDB_IntAttVal :: serializeAt (char *&buffer, size_t &, size_t slotPos, size_t &) {
+	int val = toInt ();
+	memcpy (buffer + slotPos, &val, sizeof (int));
+}
+
 void MyDB_IntAttVal :: set (int val) {
 	value = val;
 	setNotBuffered ();
@@ -109,11 +115,7 @@ MyDB_IntAttVal :: MyDB_IntAttVal () {
 MyDB_IntAttVal :: ~MyDB_IntAttVal () {}
 
 int MyDB_DoubleAttVal :: toInt () {
-	void *dataPtr = getDataPointer ();
-	if (dataPtr == nullptr) 
-		return (int) value;
-	else
-		return (int) *((double *) dataPtr);
+	return (int) toDouble ();
 }
 
 void MyDB_DoubleAttVal :: fromInt (int fromMe) {
@@ -130,16 +132,15 @@ double MyDB_DoubleAttVal :: toDouble () {
 	void *dataPtr = getDataPointer ();
 	if (dataPtr == nullptr) 
 		return value;
-	else
-		return *((double *) dataPtr);
+
+	// the value may be anywhere in the record, so it is not necessarily aligned
+	double returnVal;
+	memcpy (&returnVal, dataPtr, sizeof (double));
+	return returnVal;
 }
 
 string MyDB_DoubleAttVal :: toString () {
-	void *dataPtr = getDataPointer ();
-	if (dataPtr == nullptr) 
-		return to_string (value);
-	else
-		return to_string (*((double *) dataPtr));
+	return to_string (toDouble ());
 }
 
 bool MyDB_DoubleAttVal :: toBool () {
@@ -151,12 +152,23 @@ void MyDB_DoubleAttVal :: serialize (char *&buffer, size_t &allocatedSize, size_
 
 	extendBuffer (buffer, allocatedSize, totSize, sizeof (double) + sizeof (short));
 
-	*((short *) (buffer + totSize)) = (short) (sizeof (short) + sizeof (double));
+	short len = (short) (sizeof (short) + sizeof (double));
+	double val = toDouble ();
+	memcpy (buffer + totSize, &len, sizeof (short));
 	totSize += sizeof (short);
-	*((double *) (buffer + totSize)) = toDouble ();
+	memcpy (buffer + totSize, &val, sizeof (double));
 	totSize += sizeof (double);
 }
 
+int MyDB_DoubleAttVal :: getFixedSize () {
+	return sizeof (double);
+}
+
+void MyDB_DoubleAttVal :: serializeAt (char *&buffer, size_t &, size_t slotPos, size_t &) {
+	double val = toDouble ();
+	memcpy (buffer + slotPos, &val, sizeof (double));
+}
+
 void MyDB_DoubleAttVal :: set (double val) {
 	value = val;
 	setNotBuffered ();
@@ -211,12 +223,30 @@ void MyDB_StringAttVal :: serialize (char *&buffer, size_t &allocatedSize, size_
 
 	extendBuffer (buffer, allocatedSize, totSize, strlen (value.c_str ()) + 1 + sizeof (short));
 
-	*((short *) (buffer + totSize)) = (short) (sizeof (short) + strlen (value.c_str ()) + 1);
+	short len = (short) (sizeof (short) + strlen (value.c_str ()) + 1);
+	memcpy (buffer + totSize, &len, sizeof (short));
 	totSize += sizeof (short);
 	memcpy (buffer + totSize, value.c_str (), strlen (value.c_str ()) + 1);
 	totSize += strlen (value.c_str ()) + 1;
 }
 
+int MyDB_StringAttVal :: getFixedSize () {
+	return -1;
+}
+
+void MyDB_StringAttVal :: serializeAt (char *&buffer, size_t &allocatedSize, size_t slotPos, size_t &totSize) {
+
+	string value = toString ();
+	size_t len = strlen (value.c_str ()) + 1;
+
+	extendBuffer (buffer, allocatedSize, totSize, len);
+
+	unsigned short offset = (unsigned short) totSize;
+	memcpy (buffer + slotPos, &offset, sizeof (unsigned short));
+	memcpy (buffer + totSize, value.c_str (), len);
+	totSize += len;
+}
+
 void MyDB_StringAttVal :: set (string val) {
         value = val;
 	setNotBuffered ();
@@ -282,7 +312,8 @@ void MyDB_BoolAttVal :: serialize (char *&buffer, size_t &allocatedSize, size_t
 
 	extendBuffer (buffer, allocatedSize, totSize, sizeof (char) + sizeof (short));
 
-	*((short *) (buffer + totSize)) = (short) (sizeof (short) + sizeof (char));
+	short len = (short) (sizeof (short) + sizeof (char));
+	memcpy (buffer + totSize, &len, sizeof (short));
 	totSize += sizeof (short);
 	if (value) {
 		*(buffer + totSize) = 1;
@@ -292,6 +323,14 @@ void MyDB_BoolAttVal :: serialize (char *&buffer, size_t &allocatedSize, size_t
 	totSize += sizeof (char);
 }
 
+int MyDB_BoolAttVal :: getFixedSize () {
+	return sizeof (char);
+}
+
+void MyDB_BoolAttVal :: serializeAt (char *&buffer, size_t &, size_t slotPos, size_t &) {
+	*(buffer + slotPos) = toBool () ? 1 : 0;
+}
+
 void MyDB_BoolAttVal :: set (bool val) {
 	value = val;
 	setNotBuffered ();
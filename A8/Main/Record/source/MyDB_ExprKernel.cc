@@ -0,0 +1,450 @@
+
+#ifndef EXPR_KERNEL_CC
+#define EXPR_KERNEL_CC
+
+#include <iostream>
+#include "MyDB_ExprKernel.h"
+#include <string.h>
+
+using namespace std;
+
+MyDB_ExprKernel :: MyDB_ExprKernel (string predicate, MyDB_RecordPtr recIn) : expr (predicate, recIn->getSchema ()) {
+	rec = recIn;
+	positions = nullptr;
+	if (expr.getType () != BoolExpr) {
+		cout << "This is bad... the predicate " << predicate << " is not a bool.\n";
+		exit (1);
+	}
+}
+
+size_t MyDB_ExprKernel :: select (void **positionsIn, size_t n, int *selected) {
+	positions = positionsIn;
+	for (size_t k = 0; k < n; k++) {
+		selected[k] = k;
+	}
+	return filter (expr.getRoot (), selected, n);
+}
+
+MyDB_ExprKernel :: Column &MyDB_ExprKernel :: getColumn (MyDB_ExprNodePtr node, size_t n) {
+	Column &col = columns[node.get ()];
+	if (col.yes.size () < n) {
+		col.yes.resize (n);
+		col.no.resize (n);
+		col.all.resize (n);
+	}
+	return col;
+}
+
+template <class T>
+T *MyDB_ExprKernel :: valuesOf (MyDB_ExprNodePtr node, size_t n, bool temp) {
+	Column &col = columns[node.get ()];
+	vector <char> &space = temp ? col.temp : col.values;
+	if (space.size () < n * sizeof (T))
+		space.resize (n * sizeof (T));
+	return (T *) space.data ();
+}
+
+static bool isLiteral (MyDB_ExprNodePtr node) {
+	return node->op == ExprIntLit || node->op == ExprDoubleLit || node->op == ExprStringLit || node->op == ExprBoolLit;
+}
+
+// the comparisons; strings are compared by their characters
+template <class T> static inline bool isGreater (T lhs, T rhs) {return lhs > rhs;}
+template <class T> static inline bool isLess (T lhs, T rhs) {return lhs < rhs;}
+template <class T> static inline bool isEqual (T lhs, T rhs) {return lhs == rhs;}
+static inline bool isGreater (const char *lhs, const char *rhs) {return strcmp (lhs, rhs) > 0;}
+static inline bool isLess (const char *lhs, const char *rhs) {return strcmp (lhs, rhs) < 0;}
+static inline bool isEqual (const char *lhs, const char *rhs) {return strcmp (lhs, rhs) == 0;}
+
+// keeps the entries of sel for which lhs[k] op rhs[k * step] is true; a step of zero compares
+// every entry with the same value.  The loops do not branch on the result; each entry is
+// written, and the end of the list only moves past it when it is kept
+template <class T>
+size_t MyDB_ExprKernel :: narrow (MyDB_ExprOp op, int *sel, size_t n, T *lhs, T *rhs, bool rhsIsConst) {
+	size_t step = rhsIsConst ? 0 : 1;
+	size_t m = 0;
+	switch (op) {
+		case ExprGt:
+			for (size_t k = 0; k < n; k++) {
+				sel[m] = sel[k];
+				m += isGreater (lhs[k], rhs[k * step]);
+			}
+			break;
+		case ExprLt:
+			for (size_t k = 0; k < n; k++) {
+				sel[m] = sel[k];
+				m += isLess (lhs[k], rhs[k * step]);
+			}
+			break;
+		case ExprEq:
+			for (size_t k = 0; k < n; k++) {
+				sel[m] = sel[k];
+				m += isEqual (lhs[k], rhs[k * step]);
+			}
+			break;
+		case ExprNeq:
+			for (size_t k = 0; k < n; k++) {
+				sel[m] = sel[k];
+				m += !isEqual (lhs[k], rhs[k * step]);
+			}
+			break;
+		default:
+			cout << "This is bad... not a comparison.\n";
+			exit (1);
+	}
+	return m;
+}
+
+// keeps the entries of sel whose bits are set
+static size_t compact (int *sel, size_t n, uint64_t *bits) {
+	size_t m = 0;
+	for (size_t w = 0; w < (n + 63) / 64; w++) {
+		for (uint64_t word = bits[w]; word != 0; word &= word - 1) {
+			sel[m++] = sel[w * 64 + __builtin_ctzll (word)];
+		}
+	}
+	return m;
+}
+
+size_t MyDB_ExprKernel :: narrow (MyDB_ExprOp op, int *sel, size_t n, int *lhs, int *rhs, bool rhsIsConst) {
+	if (bits.size () < (n + 63) / 64)
+		bits.resize ((n + 63) / 64);
+	MyDB_SimdKernels :: compare (op, lhs, rhs, rhsIsConst, n, bits.data ());
+	return compact (sel, n, bits.data ());
+}
+
+size_t MyDB_ExprKernel :: narrow (MyDB_ExprOp op, int *sel, size_t n, double *lhs, double *rhs, bool rhsIsConst) {
+	if (bits.size () < (n + 63) / 64)
+		bits.resize ((n + 63) / 64);
+	MyDB_SimdKernels :: compare (op, lhs, rhs, rhsIsConst, n, bits.data ());
+	return compact (sel, n, bits.data ());
+}
+
+// the entries of sel (which has n entries) that are not in subset (which has numInSubset),
+// are put into rest; both lists are in order.  Returns how many there are
+static size_t difference (int *sel, size_t n, int *subset, size_t numInSubset, int *rest) {
+	size_t m = 0;
+	for (size_t k = 0, j = 0; k < n; k++) {
+		if (j < numInSubset && subset[j] == sel[k])
+			j++;
+		else
+			rest[m++] = sel[k];
+	}
+	return m;
+}
+
+template <class T>
+size_t MyDB_ExprKernel :: compare (MyDB_ExprOp op, MyDB_ExprNodePtr lhs, MyDB_ExprNodePtr rhs, int *sel, size_t n) {
+
+	T *lhsVals = valuesOf <T> (lhs, n);
+	eval (lhs, sel, n, lhsVals);
+
+	// a literal is computed once, and every record is compared with it
+	if (isLiteral (rhs)) {
+		T *rhsVal = valuesOf <T> (rhs, 1);
+		eval (rhs, sel, 1, rhsVal);
+		return narrow (op, sel, n, lhsVals, rhsVal, true);
+	}
+
+	T *rhsVals = valuesOf <T> (rhs, n);
+	eval (rhs, sel, n, rhsVals);
+	return narrow (op, sel, n, lhsVals, rhsVals, false);
+}
+
+size_t MyDB_ExprKernel :: filter (MyDB_ExprNodePtr node, int *sel, size_t n) {
+
+	if (n == 0)
+		return 0;
+
+	switch (node->op) {
+		case ExprBoolLit:
+			return node->boolVal ? n : 0;
+
+		// the right side only looks at the records that the left side accepted
+		case ExprAnd:
+			n = filter (node->lhs, sel, n);
+			return filter (node->rhs, sel, n);
+
+		// the right side only looks at the records that the left side did not accept
+		case ExprOr: {
+			Column &col = getColumn (node, n);
+			int *yes = col.yes.data ();
+			int *no = col.no.data ();
+			memcpy (yes, sel, n * sizeof (int));
+			size_t numYes = filter (node->lhs, yes, n);
+			size_t numNo = difference (sel, n, yes, numYes, no);
+			numNo = filter (node->rhs, no, numNo);
+
+			// and put the two lists back together, in order
+			size_t i = 0, j = 0, m = 0;
+			while (i < numYes || j < numNo) {
+				if (j == numNo || (i < numYes && yes[i] < no[j]))
+					sel[m++] = yes[i++];
+				else
+					sel[m++] = no[j++];
+			}
+			return m;
+		}
+
+		case ExprNot: {
+			Column &col = getColumn (node, n);
+			int *yes = col.yes.data ();
+			int *no = col.no.data ();
+			memcpy (yes, sel, n * sizeof (int));
+			size_t numYes = filter (node->lhs, yes, n);
+			size_t numNo = difference (sel, n, yes, numYes, no);
+			memcpy (sel, no, numNo * sizeof (int));
+			return numNo;
+		}
+
+		case ExprGt:
+		case ExprLt:
+		case ExprEq:
+		case ExprNeq: {
+
+			// put a literal on the right, so that it is the one compared against
+			MyDB_ExprNodePtr lhs = node->lhs, rhs = node->rhs;
+			MyDB_ExprOp op = node->op;
+			if (isLiteral (lhs) && !isLiteral (rhs)) {
+				swap (lhs, rhs);
+				if (op == ExprGt)
+					op = ExprLt;
+				else if (op == ExprLt)
+					op = ExprGt;
+			}
+
+			if (node->argType == IntExpr)
+				return compare <int> (op, lhs, rhs, sel, n);
+			else if (node->argType == DoubleExpr)
+				return compare <double> (op, lhs, rhs, sel, n);
+			else if (node->argType == BoolExpr)
+				return compare <char> (op, lhs, rhs, sel, n);
+			else
+				return compare <const char *> (op, lhs, rhs, sel, n);
+		}
+
+		// a bool attribute
+		default: {
+			char *vals = valuesOf <char> (node, n);
+			eval (node, sel, n, vals);
+			size_t m = 0;
+			for (size_t k = 0; k < n; k++) {
+				sel[m] = sel[k];
+				m += vals[k];
+			}
+			return m;
+		}
+	}
+}
+
+void MyDB_ExprKernel :: eval (MyDB_ExprNodePtr node, int *sel, size_t n, int *out) {
+
+	if (node->type != IntExpr) {
+		cout << "This is bad... not an int operation.\n";
+		exit (1);
+	}
+
+	switch (node->op) {
+		case ExprAtt: {
+			size_t whichAtt = node->whichAtt;
+			for (size_t k = 0; k < n; k++) {
+				char *att = rec->getAttAddress (positions[sel[k]], whichAtt);
+				if (att != nullptr) {
+					memcpy (&out[k], att, sizeof (int));
+				} else {
+					rec->viewBinary (positions[sel[k]]);
+					out[k] = rec->getAtt (whichAtt)->toInt ();
+				}
+			}
+			return;
+		}
+		case ExprIntLit:
+			for (size_t k = 0; k < n; k++)
+				out[k] = node->intVal;
+			return;
+		case ExprNegate:
+			eval (node->lhs, sel, n, out);
+			for (size_t k = 0; k < n; k++)
+				out[k] = -out[k];
+			return;
+		default:
+			break;
+	}
+
+	// the rest are arithmetic on two ints; a literal on the right is only computed once
+	int *lhs = valuesOf <int> (node->lhs, n);
+	int *rhs = valuesOf <int> (node->rhs, n);
+	bool rhsIsConst = isLiteral (node->rhs);
+	eval (node->lhs, sel, n, lhs);
+	eval (node->rhs, sel, rhsIsConst ? 1 : n, rhs);
+	MyDB_SimdKernels :: arith (node->op, lhs, rhs, rhsIsConst, n, out);
+}
+
+void MyDB_ExprKernel :: eval (MyDB_ExprNodePtr node, int *sel, size_t n, double *out) {
+
+	// an int is computed as an int, and then converted
+	if (node->type == IntExpr) {
+		int *vals = valuesOf <int> (node, n, true);
+		eval (node, sel, n, vals);
+		for (size_t k = 0; k < n; k++)
+			out[k] = vals[k];
+		return;
+	}
+
+	if (node->type != DoubleExpr) {
+		cout << "This is bad... not a double operation.\n";
+		exit (1);
+	}
+
+	switch (node->op) {
+		case ExprAtt: {
+			size_t whichAtt = node->whichAtt;
+			for (size_t k = 0; k < n; k++) {
+				char *att = rec->getAttAddress (positions[sel[k]], whichAtt);
+				if (att != nullptr) {
+					memcpy (&out[k], att, sizeof (double));
+				} else {
+					rec->viewBinary (positions[sel[k]]);
+					out[k] = rec->getAtt (whichAtt)->toDouble ();
+				}
+			}
+			return;
+		}
+		case ExprDoubleLit:
+			for (size_t k = 0; k < n; k++)
+				out[k] = node->doubleVal;
+			return;
+		case ExprNegate:
+			eval (node->lhs, sel, n, out);
+			for (size_t k = 0; k < n; k++)
+				out[k] = -out[k];
+			return;
+		default:
+			break;
+	}
+
+	// the rest are arithmetic on two doubles; a literal on the right is only computed once
+	double *lhs = valuesOf <double> (node->lhs, n);
+	double *rhs = valuesOf <double> (node->rhs, n);
+	bool rhsIsConst = isLiteral (node->rhs);
+	eval (node->lhs, sel, n, lhs);
+	eval (node->rhs, sel, rhsIsConst ? 1 : n, rhs);
+	MyDB_SimdKernels :: arith (node->op, lhs, rhs, rhsIsConst, n, out);
+}
+
+void MyDB_ExprKernel :: eval (MyDB_ExprNodePtr node, int *sel, size_t n, char *out) {
+
+	if (node->type != BoolExpr) {
+		cout << "This is bad... not a bool operation.\n";
+		exit (1);
+	}
+
+	switch (node->op) {
+		case ExprAtt: {
+			size_t whichAtt = node->whichAtt;
+			for (size_t k = 0; k < n; k++) {
+				char *att = rec->getAttAddress (positions[sel[k]], whichAtt);
+				if (att != nullptr) {
+					out[k] = (*att == 1);
+				} else {
+					rec->viewBinary (positions[sel[k]]);
+					out[k] = rec->getAtt (whichAtt)->toBool ();
+				}
+			}
+			return;
+		}
+		case ExprBoolLit:
+			for (size_t k = 0; k < n; k++)
+				out[k] = node->boolVal;
+			return;
+		default:
+			break;
+	}
+
+	// for anything else, find the records that it accepts, and mark them
+	Column &col = getColumn (node, n);
+	int *accepted = col.all.data ();
+	memcpy (accepted, sel, n * sizeof (int));
+	size_t numAccepted = filter (node, accepted, n);
+	for (size_t k = 0, j = 0; k < n; k++) {
+		out[k] = (j < numAccepted && accepted[j] == sel[k]);
+		j += out[k];
+	}
+}
+
+void MyDB_ExprKernel :: eval (MyDB_ExprNodePtr node, int *sel, size_t n, const char **out) {
+
+	// anything can be converted to a string
+	if (node->type != StringExpr) {
+		Column &col = getColumn (node, n);
+		if (col.scratch.size () < n)
+			col.scratch.resize (n);
+		if (node->type == IntExpr) {
+			int *vals = valuesOf <int> (node, n, true);
+			eval (node, sel, n, vals);
+			for (size_t k = 0; k < n; k++) {
+				col.scratch[k] = to_string (vals[k]);
+				out[k] = col.scratch[k].c_str ();
+			}
+		} else if (node->type == DoubleExpr) {
+			double *vals = valuesOf <double> (node, n, true);
+			eval (node, sel, n, vals);
+			for (size_t k = 0; k < n; k++) {
+				col.scratch[k] = to_string (vals[k]);
+				out[k] = col.scratch[k].c_str ();
+			}
+		} else {
+			char *vals = valuesOf <char> (node, n, true);
+			eval (node, sel, n, vals);
+			for (size_t k = 0; k < n; k++)
+				out[k] = vals[k] ? "true" : "false";
+		}
+		return;
+	}
+
+	switch (node->op) {
+
+		// the characters are in the record, with a null on the end
+		case ExprAtt: {
+			size_t whichAtt = node->whichAtt;
+			for (size_t k = 0; k < n; k++) {
+				char *att = rec->getAttAddress (positions[sel[k]], whichAtt);
+				if (att != nullptr) {
+					out[k] = att;
+				} else {
+					Column &col = getColumn (node, n);
+					if (col.scratch.size () < n)
+						col.scratch.resize (n);
+					rec->viewBinary (positions[sel[k]]);
+					col.scratch[k] = rec->getAtt (whichAtt)->toString ();
+					out[k] = col.scratch[k].c_str ();
+				}
+			}
+			return;
+		}
+		case ExprStringLit:
+			for (size_t k = 0; k < n; k++)
+				out[k] = node->stringVal.c_str ();
+			return;
+		case ExprPlus: {
+			Column &col = getColumn (node, n);
+			if (col.scratch.size () < n)
+				col.scratch.resize (n);
+			const char **lhs = valuesOf <const char *> (node->lhs, n);
+			const char **rhs = valuesOf <const char *> (node->rhs, n);
+			eval (node->lhs, sel, n, lhs);
+			eval (node->rhs, sel, n, rhs);
+			for (size_t k = 0; k < n; k++) {
+				col.scratch[k] = lhs[k];
+				col.scratch[k] += rhs[k];
+				out[k] = col.scratch[k].c_str ();
+			}
+			return;
+		}
+		default:
+			cout << "This is bad... not a string operation.\n";
+			exit (1);
+	}
+}
+
+#endif
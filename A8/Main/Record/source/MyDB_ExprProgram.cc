@@ -0,0 +1,377 @@
+
+#ifndef EXPR_PROGRAM_CC
+#define EXPR_PROGRAM_CC
+
+#include <iostream>
+#include "MyDB_ExprProgram.h"
+#include <string.h>
+
+using namespace std;
+
+MyDB_ExprProgram :: MyDB_ExprProgram (MyDB_Expression &expr, vector <MyDB_AttValPtr> &attsIn) {
+	atts = &attsIn;
+	resultType = expr.getType ();
+	resultReg = lower (fold (expr.getRoot ()));
+
+	// the string literals are in the scratch strings, which do not move any more
+	for (size_t i = 0; i < stringRegs.size (); i++) {
+		stringRegs[i] = stringScratch[i].c_str ();
+	}
+}
+
+MyDB_ExprType MyDB_ExprProgram :: getType () {
+	return resultType;
+}
+
+size_t MyDB_ExprProgram :: getNumInstructions () {
+	return instrs.size ();
+}
+
+static bool isLiteral (MyDB_ExprNodePtr node) {
+	return node->op == ExprIntLit || node->op == ExprDoubleLit || node->op == ExprStringLit || node->op == ExprBoolLit;
+}
+
+MyDB_ExprNodePtr MyDB_ExprProgram :: fold (MyDB_ExprNodePtr node) {
+
+	// attributes and literals are left alone
+	if (node->lhs == nullptr)
+		return node;
+
+	// the expression's own tree is not changed
+	MyDB_ExprNodePtr res = make_shared <MyDB_ExprNode> (*node);
+	res->lhs = fold (node->lhs);
+	if (node->rhs != nullptr)
+		res->rhs = fold (node->rhs);
+
+	// see if the left side of an && or an || decides it
+	if ((res->op == ExprAnd || res->op == ExprOr) && isLiteral (res->lhs) && res->lhs->boolVal == (res->op == ExprOr)) {
+		return res->lhs;
+	}
+
+	if (!isLiteral (res->lhs) || (res->rhs != nullptr && !isLiteral (res->rhs)))
+		return res;
+
+	// everything below is a literal, so the closures can compute it without a record
+	vector <MyDB_AttValPtr> noAtts;
+	if (res->type == IntExpr) {
+		res->intVal = MyDB_Expression :: makeInt (res, noAtts) ();
+		res->op = ExprIntLit;
+	} else if (res->type == DoubleExpr) {
+		res->doubleVal = MyDB_Expression :: makeDouble (res, noAtts) ();
+		res->op = ExprDoubleLit;
+	} else if (res->type == BoolExpr) {
+		res->boolVal = MyDB_Expression :: makeBool (res, noAtts) ();
+		res->op = ExprBoolLit;
+	} else {
+		res->stringVal = MyDB_Expression :: makeString (res, noAtts) ();
+		res->op = ExprStringLit;
+	}
+	res->lhs = nullptr;
+	res->rhs = nullptr;
+	return res;
+}
+
+int MyDB_ExprProgram :: newRegister (MyDB_ExprType type) {
+	if (type == IntExpr) {
+		intRegs.push_back (0);
+		return intRegs.size () - 1;
+	} else if (type == DoubleExpr) {
+		doubleRegs.push_back (0);
+		return doubleRegs.size () - 1;
+	} else if (type == BoolExpr) {
+		boolRegs.push_back (0);
+		return boolRegs.size () - 1;
+	} else {
+		stringRegs.push_back (nullptr);
+		stringScratch.push_back ("");
+		return stringRegs.size () - 1;
+	}
+}
+
+int MyDB_ExprProgram :: emit (MyDB_ExprOpCode code, int dest, int arg1, int arg2) {
+	instrs.push_back ({code, dest, arg1, arg2});
+	return instrs.size () - 1;
+}
+
+int MyDB_ExprProgram :: convert (int reg, MyDB_ExprType from, MyDB_ExprType to) {
+
+	if (from == to)
+		return reg;
+
+	int dest = newRegister (to);
+	if (from == IntExpr && to == DoubleExpr)
+		emit (IntToDouble, dest, reg, 0);
+	else if (from == IntExpr && to == StringExpr)
+		emit (IntToString, dest, reg, 0);
+	else if (from == DoubleExpr && to == StringExpr)
+		emit (DoubleToString, dest, reg, 0);
+	else if (from == BoolExpr && to == StringExpr)
+		emit (BoolToString, dest, reg, 0);
+	else {
+		cout << "This is bad... cannot do that conversion.\n";
+		exit (1);
+	}
+	return dest;
+}
+
+int MyDB_ExprProgram :: lowerAs (MyDB_ExprNodePtr node, MyDB_ExprType type) {
+
+	// a literal is converted now, rather than every time the program is run
+	if (isLiteral (node) && node->type != type) {
+		vector <MyDB_AttValPtr> noAtts;
+		MyDB_ExprNodePtr converted = make_shared <MyDB_ExprNode> (*node);
+		converted->type = type;
+		if (type == DoubleExpr) {
+			converted->doubleVal = MyDB_Expression :: makeDouble (node, noAtts) ();
+			converted->op = ExprDoubleLit;
+		} else {
+			converted->stringVal = MyDB_Expression :: makeString (node, noAtts) ();
+			converted->op = ExprStringLit;
+		}
+		return lower (converted);
+	}
+
+	return convert (lower (node), node->type, type);
+}
+
+int MyDB_ExprProgram :: lower (MyDB_ExprNodePtr node) {
+
+	int dest;
+	switch (node->op) {
+
+		// the literals go right into their registers
+		case ExprIntLit:
+			dest = newRegister (IntExpr);
+			intRegs[dest] = node->intVal;
+			return dest;
+		case ExprDoubleLit:
+			dest = newRegister (DoubleExpr);
+			doubleRegs[dest] = node->doubleVal;
+			return dest;
+		case ExprBoolLit:
+			dest = newRegister (BoolExpr);
+			boolRegs[dest] = node->boolVal;
+			return dest;
+		case ExprStringLit:
+			dest = newRegister (StringExpr);
+			stringScratch[dest] = node->stringVal;
+			return dest;
+
+		case ExprAtt: {
+			static const MyDB_ExprOpCode loads[] = {LoadIntAtt, LoadDoubleAtt, LoadStringAtt, LoadBoolAtt};
+			dest = newRegister (node->type);
+			emit (loads[node->type], dest, node->whichAtt, 0);
+			return dest;
+		}
+
+		case ExprPlus:
+		case ExprMinus:
+		case ExprTimes:
+		case ExprDivide:
+		case ExprGt:
+		case ExprLt:
+		case ExprEq:
+		case ExprNeq: {
+
+			// the op codes for each operation, for each of the argument types
+			static const MyDB_ExprOpCode ints[] = {AddInt, SubInt, MulInt, DivInt, GtInt, LtInt, EqInt, NeqInt};
+			static const MyDB_ExprOpCode doubles[] = {AddDouble, SubDouble, MulDouble, DivDouble, GtDouble, LtDouble, EqDouble, NeqDouble};
+			static const MyDB_ExprOpCode strings[] = {ConcatString, ConcatString, ConcatString, ConcatString, GtString, LtString, EqString, NeqString};
+			static const MyDB_ExprOpCode bools[] = {EqBool, EqBool, EqBool, EqBool, EqBool, EqBool, EqBool, NeqBool};
+			int which = (node->op >= ExprGt) ? node->op - ExprGt + 4 : node->op - ExprPlus;
+
+			int lhs = lowerAs (node->lhs, node->argType);
+			int rhs = lowerAs (node->rhs, node->argType);
+			dest = newRegister (node->type);
+			if (node->argType == IntExpr)
+				emit (ints[which], dest, lhs, rhs);
+			else if (node->argType == DoubleExpr)
+				emit (doubles[which], dest, lhs, rhs);
+			else if (node->argType == StringExpr)
+				emit (strings[which], dest, lhs, rhs);
+			else
+				emit (bools[which], dest, lhs, rhs);
+			return dest;
+		}
+
+		case ExprNegate: {
+			int lhs = lower (node->lhs);
+			dest = newRegister (node->type);
+			emit (node->type == IntExpr ? NegInt : NegDouble, dest, lhs, 0);
+			return dest;
+		}
+
+		case ExprNot: {
+			int lhs = lower (node->lhs);
+			dest = newRegister (BoolExpr);
+			emit (Not, dest, lhs, 0);
+			return dest;
+		}
+
+		// for these, the right side is skipped if the left side decides it
+		case ExprAnd:
+		case ExprOr: {
+			dest = newRegister (BoolExpr);
+			emit (MoveBool, dest, lower (node->lhs), 0);
+			int jump = emit (node->op == ExprAnd ? JumpIfFalse : JumpIfTrue, 0, dest, 0);
+			emit (MoveBool, dest, lower (node->rhs), 0);
+			instrs[jump].arg2 = instrs.size ();
+			return dest;
+		}
+
+		default:
+			cout << "This is bad... cannot lower that operation.\n";
+			exit (1);
+	}
+}
+
+void MyDB_ExprProgram :: run () {
+
+	size_t numInstrs = instrs.size ();
+	MyDB_ExprInstr *prog = instrs.data ();
+	int *ints = intRegs.data ();
+	double *doubles = doubleRegs.data ();
+	char *bools = boolRegs.data ();
+	const char **strings = stringRegs.data ();
+
+	for (size_t pc = 0; pc < numInstrs; pc++) {
+
+		MyDB_ExprInstr &i = prog[pc];
+		switch (i.code) {
+
+			case LoadIntAtt: {
+				MyDB_AttVal *att = (*atts)[i.arg1].get ();
+				void *data = att->getDataPointer ();
+				if (data != nullptr)
+					memcpy (&ints[i.dest], data, sizeof (int));
+				else
+					ints[i.dest] = att->toInt ();
+				break;
+			}
+			case LoadDoubleAtt: {
+				MyDB_AttVal *att = (*atts)[i.arg1].get ();
+				void *data = att->getDataPointer ();
+				if (data != nullptr)
+					memcpy (&doubles[i.dest], data, sizeof (double));
+				else
+					doubles[i.dest] = att->toDouble ();
+				break;
+			}
+			case LoadBoolAtt: {
+				MyDB_AttVal *att = (*atts)[i.arg1].get ();
+				void *data = att->getDataPointer ();
+				bools[i.dest] = (data != nullptr) ? (*((char *) data) == 1) : att->toBool ();
+				break;
+			}
+			case LoadStringAtt:
+				strings[i.dest] = ((MyDB_StringAttVal *) (*atts)[i.arg1].get ())->getChars ();
+				break;
+
+			case IntToDouble: doubles[i.dest] = ints[i.arg1]; break;
+			case IntToString:
+				stringScratch[i.dest] = to_string (ints[i.arg1]);
+				strings[i.dest] = stringScratch[i.dest].c_str ();
+				break;
+			case DoubleToString:
+				stringScratch[i.dest] = to_string (doubles[i.arg1]);
+				strings[i.dest] = stringScratch[i.dest].c_str ();
+				break;
+			case BoolToString: strings[i.dest] = bools[i.arg1] ? "true" : "false"; break;
+
+			case AddInt: ints[i.dest] = ints[i.arg1] + ints[i.arg2]; break;
+			case SubInt: ints[i.dest] = ints[i.arg1] - ints[i.arg2]; break;
+			case MulInt: ints[i.dest] = ints[i.arg1] * ints[i.arg2]; break;
+			case DivInt: ints[i.dest] = ints[i.arg1] / ints[i.arg2]; break;
+			case NegInt: ints[i.dest] = -ints[i.arg1]; break;
+
+			case AddDouble: doubles[i.dest] = doubles[i.arg1] + doubles[i.arg2]; break;
+			case SubDouble: doubles[i.dest] = doubles[i.arg1] - doubles[i.arg2]; break;
+			case MulDouble: doubles[i.dest] = doubles[i.arg1] * doubles[i.arg2]; break;
+			case DivDouble: doubles[i.dest] = doubles[i.arg1] / doubles[i.arg2]; break;
+			case NegDouble: doubles[i.dest] = -doubles[i.arg1]; break;
+
+			case ConcatString:
+				stringScratch[i.dest] = strings[i.arg1];
+				stringScratch[i.dest] += strings[i.arg2];
+				strings[i.dest] = stringScratch[i.dest].c_str ();
+				break;
+
+			case GtInt: bools[i.dest] = ints[i.arg1] > ints[i.arg2]; break;
+			case LtInt: bools[i.dest] = ints[i.arg1] < ints[i.arg2]; break;
+			case EqInt: bools[i.dest] = ints[i.arg1] == ints[i.arg2]; break;
+			case NeqInt: bools[i.dest] = ints[i.arg1] != ints[i.arg2]; break;
+
+			case GtDouble: bools[i.dest] = doubles[i.arg1] > doubles[i.arg2]; break;
+			case LtDouble: bools[i.dest] = doubles[i.arg1] < doubles[i.arg2]; break;
+			case EqDouble: bools[i.dest] = doubles[i.arg1] == doubles[i.arg2]; break;
+			case NeqDouble: bools[i.dest] = doubles[i.arg1] != doubles[i.arg2]; break;
+
+			case EqBool: bools[i.dest] = bools[i.arg1] == bools[i.arg2]; break;
+			case NeqBool: bools[i.dest] = bools[i.arg1] != bools[i.arg2]; break;
+			case Not: bools[i.dest] = !bools[i.arg1]; break;
+
+			case GtString: bools[i.dest] = strcmp (strings[i.arg1], strings[i.arg2]) > 0; break;
+			case LtString: bools[i.dest] = strcmp (strings[i.arg1], strings[i.arg2]) < 0; break;
+			case EqString: bools[i.dest] = strcmp (strings[i.arg1], strings[i.arg2]) == 0; break;
+			case NeqString: bools[i.dest] = strcmp (strings[i.arg1], strings[i.arg2]) != 0; break;
+
+			case MoveBool: bools[i.dest] = bools[i.arg1]; break;
+
+			// the loop adds one to the program counter
+			case JumpIfFalse:
+				if (!bools[i.arg1])
+					pc = i.arg2 - 1;
+				break;
+			case JumpIfTrue:
+				if (bools[i.arg1])
+					pc = i.arg2 - 1;
+				break;
+		}
+	}
+}
+
+bool MyDB_ExprProgram :: runBool () {
+	if (resultType != BoolExpr) {
+		cout << "This is bad... cannot convert to a bool.\n";
+		exit (1);
+	}
+	run ();
+	return boolRegs[resultReg];
+}
+
+int MyDB_ExprProgram :: runInt () {
+	if (resultType != IntExpr) {
+		cout << "This is bad... cannot convert to an int.\n";
+		exit (1);
+	}
+	run ();
+	return intRegs[resultReg];
+}
+
+double MyDB_ExprProgram :: runDouble () {
+	if (resultType == IntExpr)
+		return runInt ();
+	if (resultType != DoubleExpr) {
+		cout << "This is bad... cannot convert to a double.\n";
+		exit (1);
+	}
+	run ();
+	return doubleRegs[resultReg];
+}
+
+const char *MyDB_ExprProgram :: runString () {
+	run ();
+	if (resultType == IntExpr) {
+		resultScratch = to_string (intRegs[resultReg]);
+	} else if (resultType == DoubleExpr) {
+		resultScratch = to_string (doubleRegs[resultReg]);
+	} else if (resultType == BoolExpr) {
+		return boolRegs[resultReg] ? "true" : "false";
+	} else {
+		return stringRegs[resultReg];
+	}
+	return resultScratch.c_str ();
+}
+
+#endif
+
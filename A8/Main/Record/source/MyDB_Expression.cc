@@ -0,0 +1,475 @@
+
+#ifndef EXPRESSION_CC
+#define EXPRESSION_CC
+
+#include <iostream>
+#include "MyDB_Expression.h"
+#include <string.h>
+
+using namespace std;
+
+// the expression type for an attribute type
+static MyDB_ExprType typeOf (MyDB_AttTypePtr attType) {
+	if (attType->isBool ())
+		return BoolExpr;
+	if (attType->promotableToInt ())
+		return IntExpr;
+	if (attType->promotableToDouble ())
+		return DoubleExpr;
+	return StringExpr;
+}
+
+MyDB_Expression :: MyDB_Expression (string text, MyDB_SchemaPtr schemaIn) {
+	schema = schemaIn;
+	char *str = (char *) text.c_str ();
+	root = parse (str);
+}
+
+MyDB_ExprType MyDB_Expression :: getType () {
+	return root->type;
+}
+
+MyDB_ExprNodePtr MyDB_Expression :: getRoot () {
+	return root;
+}
+
+char *MyDB_Expression :: findsymbol (char val, char *input) {
+	while (*input != val) {
+		input++;
+	}
+	return input + 1;
+}
+
+MyDB_ExprNodePtr MyDB_Expression :: parseBinary (MyDB_ExprOp op, char *&vals) {
+
+	MyDB_ExprNodePtr returnVal = make_shared <MyDB_ExprNode> ();
+	returnVal->op = op;
+
+	// the two arguments are in parens, separated by a comma
+	vals = findsymbol ('(', vals);
+	returnVal->lhs = parse (vals);
+	vals = findsymbol (',', vals);
+	returnVal->rhs = parse (vals);
+	vals = findsymbol (')', vals);
+
+	// and figure out the types
+	returnVal->argType = resolveArgType (op, returnVal->lhs->type, returnVal->rhs->type);
+	if (op == ExprPlus || op == ExprMinus || op == ExprTimes || op == ExprDivide)
+		returnVal->type = returnVal->argType;
+	else
+		returnVal->type = BoolExpr;
+
+	return returnVal;
+}
+
+MyDB_ExprNodePtr MyDB_Expression :: parseUnary (MyDB_ExprOp op, char *&vals) {
+
+	MyDB_ExprNodePtr returnVal = make_shared <MyDB_ExprNode> ();
+	returnVal->op = op;
+
+	vals = findsymbol ('(', vals);
+	returnVal->lhs = parse (vals);
+	vals = findsymbol (')', vals);
+
+	returnVal->argType = resolveArgType (op, returnVal->lhs->type, returnVal->lhs->type);
+	returnVal->type = returnVal->argType;
+	return returnVal;
+}
+
+MyDB_ExprNodePtr MyDB_Expression :: parse (char *&vals) {
+
+	// search for one of the infix symbols; these are checked in the same order as in
+	// MyDB_Record.compileHelper ()
+	while (true) {
+
+		if (vals[0] == 0) {
+			cout << "Reached end of string while parsing.\n";
+			exit (1);
+		}
+
+		if (vals[0] == '!' && vals[1] == '=') {
+			return parseBinary (ExprNeq, vals);
+		} else if (vals[0] == '!') {
+			return parseUnary (ExprNot, vals);
+		} else if (vals[0] == '|' && vals[1] == '|') {
+			return parseBinary (ExprOr, vals);
+		} else if (vals[0] == '+') {
+			return parseBinary (ExprPlus, vals);
+		} else if (vals[0] == '&' && vals[1] == '&') {
+			return parseBinary (ExprAnd, vals);
+		} else if (vals[0] == '=' && vals[1] == '=') {
+			return parseBinary (ExprEq, vals);
+		} else if (vals[0] == '>') {
+			return parseBinary (ExprGt, vals);
+		} else if (vals[0] == '<') {
+			return parseBinary (ExprLt, vals);
+		} else if (vals[0] == '*') {
+			return parseBinary (ExprTimes, vals);
+		} else if (vals[0] == '/') {
+			return parseBinary (ExprDivide, vals);
+		} else if (vals[0] == '-') {
+			return parseBinary (ExprMinus, vals);
+		} else if (vals[0] == 'u' && vals[1] == 'm') {
+			return parseUnary (ExprNegate, vals);
+
+		} else if (vals[0] == '[') {
+
+			// the name runs up to the right bracket
+			vals++;
+			int cnt = 0;
+			for (; vals[cnt] != ']'; cnt++);
+			string name (vals, cnt);
+			vals = findsymbol (']', vals);
+
+			auto whichAtt = schema->getAttByName (name);
+			MyDB_ExprNodePtr returnVal = make_shared <MyDB_ExprNode> ();
+			returnVal->op = ExprAtt;
+			returnVal->whichAtt = whichAtt.first;
+			returnVal->type = typeOf (whichAtt.second);
+			return returnVal;
+
+		} else if (strncmp (vals, "int", 3) == 0) {
+
+			vals = findsymbol ('[', vals);
+			MyDB_ExprNodePtr returnVal = make_shared <MyDB_ExprNode> ();
+			returnVal->op = ExprIntLit;
+			returnVal->type = IntExpr;
+			returnVal->intVal = stoi (vals);
+			vals = findsymbol (']', vals);
+			return returnVal;
+
+		} else if (strncmp (vals, "double", 6) == 0) {
+
+			vals = findsymbol ('[', vals);
+			MyDB_ExprNodePtr returnVal = make_shared <MyDB_ExprNode> ();
+			returnVal->op = ExprDoubleLit;
+			returnVal->type = DoubleExpr;
+			returnVal->doubleVal = stod (vals);
+			vals = findsymbol (']', vals);
+			return returnVal;
+
+		} else if (strncmp (vals, "bool", 4) == 0) {
+
+			vals = findsymbol ('[', vals);
+			MyDB_ExprNodePtr returnVal = make_shared <MyDB_ExprNode> ();
+			returnVal->op = ExprBoolLit;
+			returnVal->type = BoolExpr;
+			returnVal->boolVal = (strncmp (vals, "true", 4) == 0);
+			vals = findsymbol (']', vals);
+			return returnVal;
+
+		} else if (strncmp (vals, "string", 6) == 0) {
+
+			vals = findsymbol ('[', vals);
+			int cnt = 0;
+			for (; vals[cnt] != ']'; cnt++);
+			MyDB_ExprNodePtr returnVal = make_shared <MyDB_ExprNode> ();
+			returnVal->op = ExprStringLit;
+			returnVal->type = StringExpr;
+			returnVal->stringVal = string (vals, cnt);
+			vals = findsymbol (']', vals);
+			return returnVal;
+
+		} else {
+			vals++;
+		}
+	}
+}
+
+MyDB_ExprType MyDB_Expression :: resolveArgType (MyDB_ExprOp op, MyDB_ExprType lhs, MyDB_ExprType rhs) {
+
+	bool bothInt = (lhs == IntExpr && rhs == IntExpr);
+	bool bothNumeric = (lhs == IntExpr || lhs == DoubleExpr) && (rhs == IntExpr || rhs == DoubleExpr);
+	bool bothBool = (lhs == BoolExpr && rhs == BoolExpr);
+
+	switch (op) {
+
+		// anything can be made into a string, so a plus can always be done
+		case ExprPlus:
+		case ExprGt:
+		case ExprLt:
+			return bothInt ? IntExpr : (bothNumeric ? DoubleExpr : StringExpr);
+
+		case ExprEq:
+		case ExprNeq:
+			return bothInt ? IntExpr : (bothNumeric ? DoubleExpr : (bothBool ? BoolExpr : StringExpr));
+
+		case ExprMinus:
+		case ExprTimes:
+		case ExprDivide:
+		case ExprNegate:
+			if (bothNumeric)
+				return bothInt ? IntExpr : DoubleExpr;
+			cout << "This is bad... cannot do arithmetic on a non-number.\n";
+			exit (1);
+
+		case ExprAnd:
+		case ExprOr:
+		case ExprNot:
+			if (bothBool)
+				return BoolExpr;
+			cout << "This is bad... cannot do a logical operation on non booleans.\n";
+			exit (1);
+
+		default:
+			cout << "This is bad... unknown operation.\n";
+			exit (1);
+	}
+}
+
+function <bool ()> MyDB_Expression :: compileBool (vector <MyDB_AttValPtr> &atts) {
+	return makeBool (root, atts);
+}
+
+function <int ()> MyDB_Expression :: compileInt (vector <MyDB_AttValPtr> &atts) {
+	return makeInt (root, atts);
+}
+
+function <double ()> MyDB_Expression :: compileDouble (vector <MyDB_AttValPtr> &atts) {
+	return makeDouble (root, atts);
+}
+
+function <const char *()> MyDB_Expression :: compileString (vector <MyDB_AttValPtr> &atts) {
+	return makeString (root, atts);
+}
+
+function <int ()> MyDB_Expression :: makeInt (MyDB_ExprNodePtr node, vector <MyDB_AttValPtr> &atts) {
+
+	if (node->type != IntExpr) {
+		cout << "This is bad... cannot convert to an int.\n";
+		exit (1);
+	}
+
+	vector <MyDB_AttValPtr> *where = &atts;
+	int whichAtt = node->whichAtt;
+	int val = node->intVal;
+	function <int ()> lhs, rhs;
+	if (node->lhs != nullptr)
+		lhs = makeInt (node->lhs, atts);
+	if (node->rhs != nullptr)
+		rhs = makeInt (node->rhs, atts);
+
+	switch (node->op) {
+		case ExprAtt:
+			return [where, whichAtt] {
+				MyDB_AttVal *att = (*where)[whichAtt].get ();
+				void *data = att->getDataPointer ();
+				int val;
+				if (data != nullptr)
+					memcpy (&val, data, sizeof (int));
+				else
+					val = att->toInt ();
+				return val;
+			};
+		case ExprIntLit:
+			return [val] {return val;};
+		case ExprPlus:
+			return [lhs, rhs] {return lhs () + rhs ();};
+		case ExprMinus:
+			return [lhs, rhs] {return lhs () - rhs ();};
+		case ExprTimes:
+			return [lhs, rhs] {return lhs () * rhs ();};
+		case ExprDivide:
+			return [lhs, rhs] {return lhs () / rhs ();};
+		case ExprNegate:
+			return [lhs] {return -lhs ();};
+		default:
+			cout << "This is bad... not an int operation.\n";
+			exit (1);
+	}
+}
+
+function <double ()> MyDB_Expression :: makeDouble (MyDB_ExprNodePtr node, vector <MyDB_AttValPtr> &atts) {
+
+	// an int is promoted
+	if (node->type == IntExpr) {
+		function <int ()> asInt = makeInt (node, atts);
+		return [asInt] {return (double) asInt ();};
+	}
+
+	if (node->type != DoubleExpr) {
+		cout << "This is bad... cannot convert to a double.\n";
+		exit (1);
+	}
+
+	vector <MyDB_AttValPtr> *where = &atts;
+	int whichAtt = node->whichAtt;
+	double val = node->doubleVal;
+	function <double ()> lhs, rhs;
+	if (node->lhs != nullptr)
+		lhs = makeDouble (node->lhs, atts);
+	if (node->rhs != nullptr)
+		rhs = makeDouble (node->rhs, atts);
+
+	switch (node->op) {
+		case ExprAtt:
+			return [where, whichAtt] {
+				MyDB_AttVal *att = (*where)[whichAtt].get ();
+				void *data = att->getDataPointer ();
+				double val;
+				if (data != nullptr)
+					memcpy (&val, data, sizeof (double));
+				else
+					val = att->toDouble ();
+				return val;
+			};
+		case ExprDoubleLit:
+			return [val] {return val;};
+		case ExprPlus:
+			return [lhs, rhs] {return lhs () + rhs ();};
+		case ExprMinus:
+			return [lhs, rhs] {return lhs () - rhs ();};
+		case ExprTimes:
+			return [lhs, rhs] {return lhs () * rhs ();};
+		case ExprDivide:
+			return [lhs, rhs] {return lhs () / rhs ();};
+		case ExprNegate:
+			return [lhs] {return -lhs ();};
+		default:
+			cout << "This is bad... not a double operation.\n";
+			exit (1);
+	}
+}
+
+function <const char *()> MyDB_Expression :: makeString (MyDB_ExprNodePtr node, vector <MyDB_AttValPtr> &atts) {
+
+	// other types are converted just as their toString () would do it
+	if (node->type == IntExpr) {
+		function <int ()> asInt = makeInt (node, atts);
+		shared_ptr <string> scratch = make_shared <string> ();
+		return [asInt, scratch] {*scratch = to_string (asInt ()); return scratch->c_str ();};
+
+	} else if (node->type == DoubleExpr) {
+		function <double ()> asDouble = makeDouble (node, atts);
+		shared_ptr <string> scratch = make_shared <string> ();
+		return [asDouble, scratch] {*scratch = to_string (asDouble ()); return scratch->c_str ();};
+
+	} else if (node->type == BoolExpr) {
+		function <bool ()> asBool = makeBool (node, atts);
+		return [asBool] {return asBool () ? "true" : "false";};
+	}
+
+	vector <MyDB_AttValPtr> *where = &atts;
+	int whichAtt = node->whichAtt;
+	shared_ptr <string> scratch = make_shared <string> (node->stringVal);
+
+	switch (node->op) {
+		case ExprAtt:
+			return [where, whichAtt] {
+				return ((MyDB_StringAttVal *) (*where)[whichAtt].get ())->getChars ();
+			};
+		case ExprStringLit:
+			return [scratch] {return scratch->c_str ();};
+		case ExprPlus: {
+			function <const char *()> lhs = makeString (node->lhs, atts);
+			function <const char *()> rhs = makeString (node->rhs, atts);
+			return [lhs, rhs, scratch] {
+				*scratch = lhs ();
+				*scratch += rhs ();
+				return scratch->c_str ();
+			};
+		}
+		default:
+			cout << "This is bad... not a string operation.\n";
+			exit (1);
+	}
+}
+
+// builds a comparison of two closures of the same type
+template <class T>
+static function <bool ()> makeCompare (MyDB_ExprOp op, function <T ()> lhs, function <T ()> rhs) {
+	switch (op) {
+		case ExprGt:
+			return [lhs, rhs] {return lhs () > rhs ();};
+		case ExprLt:
+			return [lhs, rhs] {return lhs () < rhs ();};
+		case ExprEq:
+			return [lhs, rhs] {return lhs () == rhs ();};
+		default:
+			return [lhs, rhs] {return lhs () != rhs ();};
+	}
+}
+
+// strings are compared in place, the same way that std :: string compares them
+template <>
+function <bool ()> makeCompare <const char *> (MyDB_ExprOp op, function <const char *()> lhs, function <const char *()> rhs) {
+	switch (op) {
+		case ExprGt:
+			return [lhs, rhs] {return strcmp (lhs (), rhs ()) > 0;};
+		case ExprLt:
+			return [lhs, rhs] {return strcmp (lhs (), rhs ()) < 0;};
+		case ExprEq:
+			return [lhs, rhs] {return strcmp (lhs (), rhs ()) == 0;};
+		default:
+			return [lhs, rhs] {return strcmp (lhs (), rhs ()) != 0;};
+	}
+}
+
+function <bool ()> MyDB_Expression :: makeBool (MyDB_ExprNodePtr node, vector <MyDB_AttValPtr> &atts) {
+
+	if (node->type != BoolExpr) {
+		cout << "This is bad... cannot convert to a bool.\n";
+		exit (1);
+	}
+
+	vector <MyDB_AttValPtr> *where = &atts;
+	int whichAtt = node->whichAtt;
+	bool val = node->boolVal;
+
+	switch (node->op) {
+		case ExprAtt:
+			return [where, whichAtt] {
+				MyDB_AttVal *att = (*where)[whichAtt].get ();
+				void *data = att->getDataPointer ();
+				return (data != nullptr) ? (*((char *) data) == 1) : att->toBool ();
+			};
+		case ExprBoolLit:
+			return [val] {return val;};
+
+		case ExprGt:
+		case ExprLt:
+		case ExprEq:
+		case ExprNeq:
+			if (node->argType == IntExpr)
+				return makeCompare <int> (node->op, makeInt (node->lhs, atts), makeInt (node->rhs, atts));
+			else if (node->argType == DoubleExpr)
+				return makeCompare <double> (node->op, makeDouble (node->lhs, atts), makeDouble (node->rhs, atts));
+			else if (node->argType == BoolExpr)
+				return makeCompare <bool> (node->op, makeBool (node->lhs, atts), makeBool (node->rhs, atts));
+			else
+				return makeCompare <const char *> (node->op, makeString (node->lhs, atts), makeString (node->rhs, atts));
+
+		case ExprAnd: {
+			function <bool ()> lhs = makeBool (node->lhs, atts);
+			function <bool ()> rhs = makeBool (node->rhs, atts);
+			return [lhs, rhs] {return lhs () && rhs ();};
+		}
+		case ExprOr: {
+			function <bool ()> lhs = makeBool (node->lhs, atts);
+			function <bool ()> rhs = makeBool (node->rhs, atts);
+			return [lhs, rhs] {return lhs () || rhs ();};
+		}
+		case ExprNot: {
+			function <bool ()> lhs = makeBool (node->lhs, atts);
+			return [lhs] {return !lhs ();};
+		}
+		default:
+			cout << "This is bad... not a boolean operation.\n";
+			exit (1);
+	}
+}
+
+function <bool ()> MyDB_Expression :: compileLessThan (MyDB_Expression &lhs, vector <MyDB_AttValPtr> &lhsAtts,
+	MyDB_Expression &rhs, vector <MyDB_AttValPtr> &rhsAtts) {
+
+	MyDB_ExprType argType = resolveArgType (ExprLt, lhs.getType (), rhs.getType ());
+	if (argType == IntExpr)
+		return makeCompare <int> (ExprLt, lhs.compileInt (lhsAtts), rhs.compileInt (rhsAtts));
+	else if (argType == DoubleExpr)
+		return makeCompare <double> (ExprLt, lhs.compileDouble (lhsAtts), rhs.compileDouble (rhsAtts));
+	else
+		return makeCompare <const char *> (ExprLt, lhs.compileString (lhsAtts), rhs.compileString (rhsAtts));
+}
+
+#endif
+
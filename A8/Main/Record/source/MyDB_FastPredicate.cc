@@ -0,0 +1,209 @@
+
+#ifndef FAST_PREDICATE_CC
+#define FAST_PREDICATE_CC
+
+#include "MyDB_FastPredicate.h"
+#include <string.h>
+
+using namespace std;
+
+atomic <size_t> MyDB_FastPredicate :: numTried (0);
+atomic <size_t> MyDB_FastPredicate :: numFast (0);
+
+// reads an attribute in place, just like the closures do; the value is copied out, since
+// it is not necessarily aligned
+template <class T> static inline T readAtt (MyDB_AttVal *att);
+
+template <> inline int readAtt <int> (MyDB_AttVal *att) {
+	void *data = att->getDataPointer ();
+	int val;
+	if (data != nullptr)
+		memcpy (&val, data, sizeof (int));
+	else
+		val = att->toInt ();
+	return val;
+}
+
+template <> inline double readAtt <double> (MyDB_AttVal *att) {
+	void *data = att->getDataPointer ();
+	double val;
+	if (data != nullptr)
+		memcpy (&val, data, sizeof (double));
+	else
+		val = att->toDouble ();
+	return val;
+}
+
+template <> inline const char *readAtt <const char *> (MyDB_AttVal *att) {
+	return ((MyDB_StringAttVal *) att)->getChars ();
+}
+
+// a literal, converted to the type that it is compared as
+template <class T> struct FastLiteral;
+
+template <> struct FastLiteral <int> {
+	int val;
+	FastLiteral (MyDB_ExprNodePtr node) : val (node->intVal) {}
+	inline int get () const {return val;}
+};
+
+template <> struct FastLiteral <double> {
+	double val;
+	FastLiteral (MyDB_ExprNodePtr node) : val (node->op == ExprIntLit ? node->intVal : node->doubleVal) {}
+	inline double get () const {return val;}
+};
+
+template <> struct FastLiteral <const char *> {
+	string val;
+	FastLiteral (MyDB_ExprNodePtr node) : val (node->stringVal) {}
+	inline const char *get () const {return val.c_str ();}
+};
+
+// the comparisons; the operation is a template argument, so each one is a single instruction
+template <MyDB_ExprOp op, class T>
+static inline bool holds (T lhs, T rhs) {
+	return op == ExprGt ? lhs > rhs : op == ExprLt ? lhs < rhs : op == ExprEq ? lhs == rhs : lhs != rhs;
+}
+
+template <MyDB_ExprOp op>
+static inline bool holds (const char *lhs, const char *rhs) {
+	int res = strcmp (lhs, rhs);
+	return op == ExprGt ? res > 0 : op == ExprLt ? res < 0 : op == ExprEq ? res == 0 : res != 0;
+}
+
+// [att] op literal
+template <class T, MyDB_ExprOp op>
+struct AttLitTerm {
+	vector <MyDB_AttValPtr> *atts;
+	int whichAtt;
+	FastLiteral <T> lit;
+
+	bool operator () () const {
+		return holds <op> (readAtt <T> ((*atts)[whichAtt].get ()), lit.get ());
+	}
+};
+
+// [att] op [att]
+template <class T, MyDB_ExprOp op>
+struct AttAttTerm {
+	vector <MyDB_AttValPtr> *atts;
+	int lhsAtt;
+	int rhsAtt;
+
+	bool operator () () const {
+		return holds <op> (readAtt <T> ((*atts)[lhsAtt].get ()), readAtt <T> ((*atts)[rhsAtt].get ()));
+	}
+};
+
+// picks the comparison for the operation; lhs is an attribute
+template <class T>
+static function <bool ()> makeTerm (MyDB_ExprOp op, vector <MyDB_AttValPtr> *atts, MyDB_ExprNodePtr lhs,
+	MyDB_ExprNodePtr rhs) {
+
+	if (rhs->op == ExprAtt) {
+		switch (op) {
+			case ExprGt:
+				return AttAttTerm <T, ExprGt> {atts, lhs->whichAtt, rhs->whichAtt};
+			case ExprLt:
+				return AttAttTerm <T, ExprLt> {atts, lhs->whichAtt, rhs->whichAtt};
+			case ExprEq:
+				return AttAttTerm <T, ExprEq> {atts, lhs->whichAtt, rhs->whichAtt};
+			default:
+				return AttAttTerm <T, ExprNeq> {atts, lhs->whichAtt, rhs->whichAtt};
+		}
+	}
+
+	FastLiteral <T> lit (rhs);
+	switch (op) {
+		case ExprGt:
+			return AttLitTerm <T, ExprGt> {atts, lhs->whichAtt, lit};
+		case ExprLt:
+			return AttLitTerm <T, ExprLt> {atts, lhs->whichAtt, lit};
+		case ExprEq:
+			return AttLitTerm <T, ExprEq> {atts, lhs->whichAtt, lit};
+		default:
+			return AttLitTerm <T, ExprNeq> {atts, lhs->whichAtt, lit};
+	}
+}
+
+static bool isLiteral (MyDB_ExprNodePtr node) {
+	return node->op == ExprIntLit || node->op == ExprDoubleLit || node->op == ExprStringLit || node->op == ExprBoolLit;
+}
+
+// true if the node is an attribute or a literal that can be compared as the given type
+// without converting it at run time
+static bool fitsType (MyDB_ExprNodePtr node, MyDB_ExprType argType) {
+	if (node->op == ExprAtt)
+		return node->type == argType;
+	if (argType == IntExpr)
+		return node->op == ExprIntLit;
+	if (argType == DoubleExpr)
+		return node->op == ExprDoubleLit || node->op == ExprIntLit;
+	if (argType == StringExpr)
+		return node->op == ExprStringLit;
+	return false;
+}
+
+bool MyDB_FastPredicate :: matches (MyDB_ExprNodePtr node) {
+
+	if (node->op == ExprAnd)
+		return matches (node->lhs) && matches (node->rhs);
+
+	if (node->op != ExprGt && node->op != ExprLt && node->op != ExprEq && node->op != ExprNeq)
+		return false;
+
+	// one side is an attribute, and the other is an attribute or a literal
+	return fitsType (node->lhs, node->argType) && fitsType (node->rhs, node->argType) &&
+		(node->lhs->op == ExprAtt || node->rhs->op == ExprAtt);
+}
+
+function <bool ()> MyDB_FastPredicate :: build (MyDB_ExprNodePtr node, vector <MyDB_AttValPtr> &atts) {
+
+	if (node->op == ExprAnd) {
+		function <bool ()> lhs = build (node->lhs, atts);
+		function <bool ()> rhs = build (node->rhs, atts);
+		return [lhs, rhs] {return lhs () && rhs ();};
+	}
+
+	// put the attribute on the left
+	MyDB_ExprNodePtr lhs = node->lhs, rhs = node->rhs;
+	MyDB_ExprOp op = node->op;
+	if (isLiteral (lhs)) {
+		swap (lhs, rhs);
+		if (op == ExprGt)
+			op = ExprLt;
+		else if (op == ExprLt)
+			op = ExprGt;
+	}
+
+	if (node->argType == IntExpr)
+		return makeTerm <int> (op, &atts, lhs, rhs);
+	else if (node->argType == DoubleExpr)
+		return makeTerm <double> (op, &atts, lhs, rhs);
+	else
+		return makeTerm <const char *> (op, &atts, lhs, rhs);
+}
+
+bool MyDB_FastPredicate :: compile (MyDB_Expression &expr, vector <MyDB_AttValPtr> &atts, function <bool ()> &result) {
+
+	if (expr.getType () != BoolExpr)
+		return false;
+
+	numTried++;
+	if (!matches (expr.getRoot ()))
+		return false;
+
+	numFast++;
+	result = build (expr.getRoot (), atts);
+	return true;
+}
+
+size_t MyDB_FastPredicate :: getNumTried () {
+	return numTried;
+}
+
+size_t MyDB_FastPredicate :: getNumFast () {
+	return numFast;
+}
+
+#endif
@@ -16,9 +16,42 @@ char *MyDB_Record :: findsymbol (char val, char *input) {
 	return input + 1;
 }
 
-func MyDB_Record :: compileComputation (string compileMe) {
-	char *str = (char *) compileMe.c_str ();
-	return compileHelper (str).first;
+func MyDB_Record :: compileComputation (string compileMe, bool asBytecode) {
+
+	MyDB_Expression expr (compileMe, mySchema);
+	if (!asBytecode) {
+
+		// a conjunction of comparisons with literals skips the helpers and their scratch attributes
+		function <bool ()> fast;
+		if (MyDB_FastPredicate :: compile (expr, values, fast)) {
+			MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
+			scratch.push_back (temp);
+			return [fast, temp] {temp->set (fast ()); return temp;};
+		}
+
+		char *str = (char *) compileMe.c_str ();
+		return compileHelper (str).first;
+	}
+
+	// run the program, and put its result into a scratch attribute of the right type
+	MyDB_ExprProgramPtr prog = make_shared <MyDB_ExprProgram> (expr, values);
+	if (expr.getType () == IntExpr) {
+		MyDB_IntAttValPtr temp = make_shared <MyDB_IntAttVal> ();
+		scratch.push_back (temp);
+		return [prog, temp] {temp->set (prog->runInt ()); return temp;};
+	} else if (expr.getType () == DoubleExpr) {
+		MyDB_DoubleAttValPtr temp = make_shared <MyDB_DoubleAttVal> ();
+		scratch.push_back (temp);
+		return [prog, temp] {temp->set (prog->runDouble ()); return temp;};
+	} else if (expr.getType () == BoolExpr) {
+		MyDB_BoolAttValPtr temp = make_shared <MyDB_BoolAttVal> ();
+		scratch.push_back (temp);
+		return [prog, temp] {temp->set (prog->runBool ()); return temp;};
+	} else {
+		MyDB_StringAttValPtr temp = make_shared <MyDB_StringAttVal> ();
+		scratch.push_back (temp);
+		return [prog, temp] {temp->set (string (prog->runString ())); return temp;};
+	}
 }
 
 pair <func, MyDB_AttTypePtr> MyDB_Record :: compileHelper(char * &vals) {
@@ -754,13 +787,49 @@ void MyDB_Record :: recordContentHasChanged () {
 	bufferOld = true;
 }
 
-void MyDB_Record :: writeAttsToBuffer () {
-	recSize = sizeof (short);
+void MyDB_Record :: computeLayout () {
+	slots.clear ();
+	slotsEnd = sizeof (short);
 	for (MyDB_AttValPtr temp : values) {
-		temp->serialize (buffer, allocatedSize, recSize);
+		int size = temp->getFixedSize ();
+		slots.push_back (make_pair (slotsEnd, size == -1));
+		slotsEnd += (size == -1) ? sizeof (unsigned short) : size;
+	}
+	layoutOld = false;
+}
+
+void MyDB_Record :: writeAttsToBuffer () {
+
+	if (layoutOld)
+		computeLayout ();
+
+	// some of the attributes may still be reading from the buffer (and it may be in the
+	// old format), so the record is written to the spare buffer; the slots go first
+	if (slotsEnd > spareSize) {
+		delete [] spare;
+		spare = new char[slotsEnd * 2];
+		spareSize = slotsEnd * 2;
+	}
+
+	recSize = slotsEnd;
+	for (size_t i = 0; i < values.size (); i++) {
+		values[i]->serializeAt (spare, spareSize, slots[i].first, recSize);
 	}		
-	*((short *) buffer) = (short) recSize;
+	short header = (short) -recSize;
+	memcpy (spare, &header, sizeof (short));
+
+	// any attribute that was reading from the old buffer (or the bytes that the record
+	// was viewing) now reads from the new one
+	for (size_t i = 0; i < values.size (); i++) {
+		char *data = (char *) values[i]->getDataPointer ();
+		if ((data >= buffer && data < buffer + allocatedSize) || (view != nullptr && data >= view && data < view + viewSize))
+			values[i]->setBuffered (findAtt (spare, i));
+	}
+
+	swap (buffer, spare);
+	swap (allocatedSize, spareSize);
 	bufferOld = false;
+	endView ();
 }
 
 void *MyDB_Record :: toBinary (void *toHere) {
@@ -769,13 +838,64 @@ void *MyDB_Record :: toBinary (void *toHere) {
 	if (bufferOld) {
 		writeAttsToBuffer ();
 	} 
-	memcpy (toHere, buffer, recSize);
+	memcpy (toHere, (view != nullptr) ? view : buffer, recSize);
 	return ((char *) toHere) + recSize;
 }
 
+void *MyDB_Record :: viewBinary (void *fromHere, const MyDB_PageHandle &onPage) {
+
+	// a negative size means that the record is in the offset format
+	char *rec = (char *) fromHere;
+	short header = getHeader (rec);
+	recSize = (header < 0) ? -header : header;
+
+	// set up the attributes to read straight from the bytes
+	if (header < 0) {
+		if (layoutOld)
+			computeLayout ();
+		for (size_t i = 0; i < values.size (); i++) {
+			values[i]->setBuffered (findAtt (rec, i));
+		}
+	} else {
+		char *recLoc = rec + sizeof (short);
+		for (MyDB_AttValPtr &temp : values) {
+			recLoc = temp->fromBinary (recLoc);
+		}		
+	}
+
+	// usually, the next record is on the same page, so the handle does not change
+	view = rec;
+	viewSize = recSize;
+	if (!(viewPage == onPage))
+		viewPage = onPage;
+	bufferOld = false;
+
+	return rec + recSize;
+}
+
+void MyDB_Record :: materialize () {
+
+	if (view == nullptr)
+		return;
+
+	// if the attributes have changed, writing them out copies everything we need
+	if (bufferOld)
+		writeAttsToBuffer ();
+	else
+		fromBinary (view);
+}
+
+void MyDB_Record :: endView () {
+	view = nullptr;
+	if (viewPage != nullptr)
+		viewPage = nullptr;
+}
+
 void *MyDB_Record :: fromBinary (void *fromHere) {
 
-	recSize = *((short *) fromHere);
+	// a negative size means that the record is in the offset format
+	short header = getHeader (fromHere);
+	recSize = (header < 0) ? -header : header;
 
 	// if our buffer is not large enough, reallocate
 	if (recSize > allocatedSize) {
@@ -788,14 +908,28 @@ void *MyDB_Record :: fromBinary (void *fromHere) {
 	// copy over
 	memcpy (buffer, fromHere, recSize);
 
-	// and set up the attributes
-	char *recLoc = buffer + sizeof (short);
-	for (MyDB_AttValPtr temp : values) {
-		recLoc = temp->fromBinary (recLoc);
-	}		
+	// and set up the attributes; in the offset format, each one is found from its slot,
+	// and its value is not decoded until it is asked for
+	if (header < 0) {
+		if (layoutOld)
+			computeLayout ();
+		for (size_t i = 0; i < values.size (); i++) {
+			values[i]->setBuffered (findAtt (buffer, i));
+		}
+
+	// in the old format, we have to walk the attributes to find each one
+	} else {
+		char *recLoc = buffer + sizeof (short);
+		for (MyDB_AttValPtr temp : values) {
+			recLoc = temp->fromBinary (recLoc);
+		}		
+	}
 
 	bufferOld = false;
 
+	// the bytes have been copied, so the record no longer depends on what it was viewing
+	endView ();
+
 	return ((char *) fromHere) + recSize;
 
 }
@@ -827,18 +961,29 @@ std::ostream& operator<<(std::ostream& os, const MyDB_RecordPtr printMe) {
 
 function <bool ()> buildRecordComparator (MyDB_RecordPtr lhs,  MyDB_RecordPtr rhs, string computation) {
 
-	// compile a computation over the LHS and over the RHS
-	char *str = (char *) computation.c_str ();
-	pair <func, MyDB_AttTypePtr> lhsFunc = lhs->compileHelper (str);
+	// compile the computation over the LHS and over the RHS, and compare the results
+	MyDB_Expression lhsExpr (computation, lhs->mySchema);
+	MyDB_Expression rhsExpr (computation, rhs->mySchema);
+	return MyDB_Expression :: compileLessThan (lhsExpr, lhs->values, rhsExpr, rhs->values);
+}
 
-	str = (char *) computation.c_str ();
-	pair <func, MyDB_AttTypePtr> rhsFunc = rhs->compileHelper (str);
+function <bool ()> MyDB_Record :: compilePredicate (string fromMe, bool asBytecode) {
 
-	// and then build a lambda that performs the computatation
-	auto res = lhs->lt (lhsFunc, rhsFunc);
-	func temp = res.first;
-	return [=] {return temp ()->toBool ();};
-	
+	MyDB_Expression expr (fromMe, mySchema);
+	if (expr.getType () != BoolExpr) {
+		cout << "This is bad... the predicate " << fromMe << " does not produce a bool.\n";
+		exit (1);
+	}
+
+	if (asBytecode) {
+		MyDB_ExprProgramPtr prog = make_shared <MyDB_ExprProgram> (expr, values);
+		return [prog] {return prog->runBool ();};
+	}
+
+	function <bool ()> fast;
+	if (MyDB_FastPredicate :: compile (expr, values, fast))
+		return fast;
+	return expr.compileBool (values);
 }
 
 MyDB_Record :: MyDB_Record (MyDB_SchemaPtr mySchemaIn) {
@@ -846,8 +991,13 @@ MyDB_Record :: MyDB_Record (MyDB_SchemaPtr mySchemaIn) {
 
 	buffer = new char[256];
 	allocatedSize = 256;
+	spare = nullptr;
+	spareSize = 0;
+	view = nullptr;
+	viewSize = 0;
 	recSize = 0;
 	bufferOld = true;
+	layoutOld = true;
 
 	if (mySchemaIn == nullptr)
 		return;
@@ -874,10 +1024,12 @@ void MyDB_Record :: buildFrom (MyDB_RecordPtr left, MyDB_RecordPtr right) {
                 newValues.push_back (v);
         }
         values = newValues;
+	layoutOld = true;
 }
 
 MyDB_Record :: ~MyDB_Record () {
 	delete [] buffer;
+	delete [] spare;
 }
 
 #endif
@@ -0,0 +1,355 @@
+
+#ifndef SIMD_KERNELS_CC
+#define SIMD_KERNELS_CC
+
+#include <iostream>
+#include "MyDB_SimdKernels.h"
+#include <string.h>
+
+#if defined (__x86_64__) || defined (__i386__)
+#define MYDB_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// the plain loops; these do entries start through n - 1, and are used for whatever is left
+// over at the end of the vector loops, as well as on a CPU without the vector instructions
+template <class T>
+static void compareScalar (MyDB_ExprOp op, const T *lhs, const T *rhs, bool rhsIsConst, size_t start, size_t n,
+	uint64_t *bits) {
+
+	size_t step = rhsIsConst ? 0 : 1;
+	switch (op) {
+		case ExprEq:
+			for (size_t k = start; k < n; k++)
+				bits[k / 64] |= ((uint64_t) (lhs[k] == rhs[k * step])) << (k % 64);
+			return;
+		case ExprNeq:
+			for (size_t k = start; k < n; k++)
+				bits[k / 64] |= ((uint64_t) (lhs[k] != rhs[k * step])) << (k % 64);
+			return;
+		case ExprLt:
+			for (size_t k = start; k < n; k++)
+				bits[k / 64] |= ((uint64_t) (lhs[k] < rhs[k * step])) << (k % 64);
+			return;
+		case ExprGt:
+			for (size_t k = start; k < n; k++)
+				bits[k / 64] |= ((uint64_t) (lhs[k] > rhs[k * step])) << (k % 64);
+			return;
+		default:
+			cout << "This is bad... not a comparison.\n";
+			exit (1);
+	}
+}
+
+template <class T>
+static void arithScalar (MyDB_ExprOp op, const T *lhs, const T *rhs, bool rhsIsConst, size_t start, size_t n, T *out) {
+
+	size_t step = rhsIsConst ? 0 : 1;
+	switch (op) {
+		case ExprPlus:
+			for (size_t k = start; k < n; k++)
+				out[k] = lhs[k] + rhs[k * step];
+			return;
+		case ExprMinus:
+			for (size_t k = start; k < n; k++)
+				out[k] = lhs[k] - rhs[k * step];
+			return;
+		case ExprTimes:
+			for (size_t k = start; k < n; k++)
+				out[k] = lhs[k] * rhs[k * step];
+			return;
+		case ExprDivide:
+			for (size_t k = start; k < n; k++)
+				out[k] = lhs[k] / rhs[k * step];
+			return;
+		default:
+			cout << "This is bad... not an arithmetic operation.\n";
+			exit (1);
+	}
+}
+
+#ifdef MYDB_X86
+
+// the vector loops; each one does as many entries as fit in whole vectors, and returns how
+// many that was.  The operation is a template argument, so that each loop has no branches
+
+template <MyDB_ExprOp op>
+__attribute__ ((target ("avx2")))
+static size_t compareAVX2 (const int *lhs, const int *rhs, bool rhsIsConst, size_t n, uint64_t *bits) {
+	__m256i c = _mm256_set1_epi32 (rhs[0]);
+	size_t k = 0;
+	for (; k + 8 <= n; k += 8) {
+		__m256i l = _mm256_loadu_si256 ((const __m256i *) (lhs + k));
+		__m256i r = rhsIsConst ? c : _mm256_loadu_si256 ((const __m256i *) (rhs + k));
+
+		// there is only == and >, so != is a flipped ==, and < is a > the other way around
+		__m256i res = (op == ExprEq || op == ExprNeq) ? _mm256_cmpeq_epi32 (l, r) :
+			(op == ExprGt) ? _mm256_cmpgt_epi32 (l, r) : _mm256_cmpgt_epi32 (r, l);
+		uint64_t mask = _mm256_movemask_ps (_mm256_castsi256_ps (res));
+		if (op == ExprNeq)
+			mask ^= 0xff;
+		bits[k / 64] |= mask << (k % 64);
+	}
+	return k;
+}
+
+template <MyDB_ExprOp op>
+__attribute__ ((target ("avx2")))
+static size_t compareAVX2 (const double *lhs, const double *rhs, bool rhsIsConst, size_t n, uint64_t *bits) {
+	__m256d c = _mm256_set1_pd (rhs[0]);
+	size_t k = 0;
+	for (; k + 4 <= n; k += 4) {
+		__m256d l = _mm256_loadu_pd (lhs + k);
+		__m256d r = rhsIsConst ? c : _mm256_loadu_pd (rhs + k);
+
+		// a NaN is not ==, <, or > anything, and is != everything, just as in C++
+		__m256d res = _mm256_cmp_pd (l, r, op == ExprEq ? _CMP_EQ_OQ : op == ExprNeq ? _CMP_NEQ_UQ :
+			op == ExprGt ? _CMP_GT_OQ : _CMP_LT_OQ);
+		uint64_t mask = _mm256_movemask_pd (res);
+		bits[k / 64] |= mask << (k % 64);
+	}
+	return k;
+}
+
+template <MyDB_ExprOp op>
+__attribute__ ((target ("avx2")))
+static size_t arithAVX2 (const int *lhs, const int *rhs, bool rhsIsConst, size_t n, int *out) {
+	__m256i c = _mm256_set1_epi32 (rhs[0]);
+	size_t k = 0;
+	for (; k + 8 <= n; k += 8) {
+		__m256i l = _mm256_loadu_si256 ((const __m256i *) (lhs + k));
+		__m256i r = rhsIsConst ? c : _mm256_loadu_si256 ((const __m256i *) (rhs + k));
+		__m256i res = op == ExprPlus ? _mm256_add_epi32 (l, r) : op == ExprMinus ? _mm256_sub_epi32 (l, r) :
+			_mm256_mullo_epi32 (l, r);
+		_mm256_storeu_si256 ((__m256i *) (out + k), res);
+	}
+	return k;
+}
+
+template <MyDB_ExprOp op>
+__attribute__ ((target ("avx2")))
+static size_t arithAVX2 (const double *lhs, const double *rhs, bool rhsIsConst, size_t n, double *out) {
+	__m256d c = _mm256_set1_pd (rhs[0]);
+	size_t k = 0;
+	for (; k + 4 <= n; k += 4) {
+		__m256d l = _mm256_loadu_pd (lhs + k);
+		__m256d r = rhsIsConst ? c : _mm256_loadu_pd (rhs + k);
+		__m256d res = op == ExprPlus ? _mm256_add_pd (l, r) : op == ExprMinus ? _mm256_sub_pd (l, r) :
+			op == ExprTimes ? _mm256_mul_pd (l, r) : _mm256_div_pd (l, r);
+		_mm256_storeu_pd (out + k, res);
+	}
+	return k;
+}
+
+template <MyDB_ExprOp op>
+__attribute__ ((target ("sse4.2")))
+static size_t compareSSE42 (const int *lhs, const int *rhs, bool rhsIsConst, size_t n, uint64_t *bits) {
+	__m128i c = _mm_set1_epi32 (rhs[0]);
+	size_t k = 0;
+	for (; k + 4 <= n; k += 4) {
+		__m128i l = _mm_loadu_si128 ((const __m128i *) (lhs + k));
+		__m128i r = rhsIsConst ? c : _mm_loadu_si128 ((const __m128i *) (rhs + k));
+		__m128i res = (op == ExprEq || op == ExprNeq) ? _mm_cmpeq_epi32 (l, r) :
+			(op == ExprGt) ? _mm_cmpgt_epi32 (l, r) : _mm_cmpgt_epi32 (r, l);
+		uint64_t mask = _mm_movemask_ps (_mm_castsi128_ps (res));
+		if (op == ExprNeq)
+			mask ^= 0xf;
+		bits[k / 64] |= mask << (k % 64);
+	}
+	return k;
+}
+
+template <MyDB_ExprOp op>
+__attribute__ ((target ("sse4.2")))
+static size_t compareSSE42 (const double *lhs, const double *rhs, bool rhsIsConst, size_t n, uint64_t *bits) {
+	__m128d c = _mm_set1_pd (rhs[0]);
+	size_t k = 0;
+	for (; k + 2 <= n; k += 2) {
+		__m128d l = _mm_loadu_pd (lhs + k);
+		__m128d r = rhsIsConst ? c : _mm_loadu_pd (rhs + k);
+		__m128d res = op == ExprEq ? _mm_cmpeq_pd (l, r) : op == ExprNeq ? _mm_cmpneq_pd (l, r) :
+			op == ExprGt ? _mm_cmpgt_pd (l, r) : _mm_cmplt_pd (l, r);
+		uint64_t mask = _mm_movemask_pd (res);
+		bits[k / 64] |= mask << (k % 64);
+	}
+	return k;
+}
+
+template <MyDB_ExprOp op>
+__attribute__ ((target ("sse4.2")))
+static size_t arithSSE42 (const int *lhs, const int *rhs, bool rhsIsConst, size_t n, int *out) {
+	__m128i c = _mm_set1_epi32 (rhs[0]);
+	size_t k = 0;
+	for (; k + 4 <= n; k += 4) {
+		__m128i l = _mm_loadu_si128 ((const __m128i *) (lhs + k));
+		__m128i r = rhsIsConst ? c : _mm_loadu_si128 ((const __m128i *) (rhs + k));
+		__m128i res = op == ExprPlus ? _mm_add_epi32 (l, r) : op == ExprMinus ? _mm_sub_epi32 (l, r) :
+			_mm_mullo_epi32 (l, r);
+		_mm_storeu_si128 ((__m128i *) (out + k), res);
+	}
+	return k;
+}
+
+template <MyDB_ExprOp op>
+__attribute__ ((target ("sse4.2")))
+static size_t arithSSE42 (const double *lhs, const double *rhs, bool rhsIsConst, size_t n, double *out) {
+	__m128d c = _mm_set1_pd (rhs[0]);
+	size_t k = 0;
+	for (; k + 2 <= n; k += 2) {
+		__m128d l = _mm_loadu_pd (lhs + k);
+		__m128d r = rhsIsConst ? c : _mm_loadu_pd (rhs + k);
+		__m128d res = op == ExprPlus ? _mm_add_pd (l, r) : op == ExprMinus ? _mm_sub_pd (l, r) :
+			op == ExprTimes ? _mm_mul_pd (l, r) : _mm_div_pd (l, r);
+		_mm_storeu_pd (out + k, res);
+	}
+	return k;
+}
+
+#endif
+
+static MyDB_SimdLevel detectLevel () {
+#ifdef MYDB_X86
+	__builtin_cpu_init ();
+	if (__builtin_cpu_supports ("avx2"))
+		return SimdAVX2;
+	if (__builtin_cpu_supports ("sse4.2"))
+		return SimdSSE42;
+#endif
+	return SimdScalar;
+}
+
+static MyDB_SimdLevel bestLevel = detectLevel ();
+static MyDB_SimdLevel level = bestLevel;
+
+MyDB_SimdLevel MyDB_SimdKernels :: getLevel () {
+	return level;
+}
+
+MyDB_SimdLevel MyDB_SimdKernels :: getBestLevel () {
+	return bestLevel;
+}
+
+void MyDB_SimdKernels :: setLevel (MyDB_SimdLevel levelIn) {
+	level = (levelIn < bestLevel) ? levelIn : bestLevel;
+}
+
+void MyDB_SimdKernels :: compare (MyDB_ExprOp op, const int *lhs, const int *rhs, bool rhsIsConst, size_t n,
+	uint64_t *bits) {
+
+	if (n == 0)
+		return;
+	memset (bits, 0, ((n + 63) / 64) * sizeof (uint64_t));
+
+	// do what we can with the vector instructions, and the rest one at a time
+	size_t done = 0;
+#ifdef MYDB_X86
+	if (level == SimdAVX2) {
+		switch (op) {
+			case ExprEq: done = compareAVX2 <ExprEq> (lhs, rhs, rhsIsConst, n, bits); break;
+			case ExprNeq: done = compareAVX2 <ExprNeq> (lhs, rhs, rhsIsConst, n, bits); break;
+			case ExprLt: done = compareAVX2 <ExprLt> (lhs, rhs, rhsIsConst, n, bits); break;
+			case ExprGt: done = compareAVX2 <ExprGt> (lhs, rhs, rhsIsConst, n, bits); break;
+			default: break;
+		}
+	} else if (level == SimdSSE42) {
+		switch (op) {
+			case ExprEq: done = compareSSE42 <ExprEq> (lhs, rhs, rhsIsConst, n, bits); break;
+			case ExprNeq: done = compareSSE42 <ExprNeq> (lhs, rhs, rhsIsConst, n, bits); break;
+			case ExprLt: done = compareSSE42 <ExprLt> (lhs, rhs, rhsIsConst, n, bits); break;
+			case ExprGt: done = compareSSE42 <ExprGt> (lhs, rhs, rhsIsConst, n, bits); break;
+			default: break;
+		}
+	}
+#endif
+	compareScalar (op, lhs, rhs, rhsIsConst, done, n, bits);
+}
+
+void MyDB_SimdKernels :: compare (MyDB_ExprOp op, const double *lhs, const double *rhs, bool rhsIsConst, size_t n,
+	uint64_t *bits) {
+
+	if (n == 0)
+		return;
+	memset (bits, 0, ((n + 63) / 64) * sizeof (uint64_t));
+
+	size_t done = 0;
+#ifdef MYDB_X86
+	if (level == SimdAVX2) {
+		switch (op) {
+			case ExprEq: done = compareAVX2 <ExprEq> (lhs, rhs, rhsIsConst, n, bits); break;
+			case ExprNeq: done = compareAVX2 <ExprNeq> (lhs, rhs, rhsIsConst, n, bits); break;
+			case ExprLt: done = compareAVX2 <ExprLt> (lhs, rhs, rhsIsConst, n, bits); break;
+			case ExprGt: done = compareAVX2 <ExprGt> (lhs, rhs, rhsIsConst, n, bits); break;
+			default: break;
+		}
+	} else if (level == SimdSSE42) {
+		switch (op) {
+			case ExprEq: done = compareSSE42 <ExprEq> (lhs, rhs, rhsIsConst, n, bits); break;
+			case ExprNeq: done = compareSSE42 <ExprNeq> (lhs, rhs, rhsIsConst, n, bits); break;
+			case ExprLt: done = compareSSE42 <ExprLt> (lhs, rhs, rhsIsConst, n, bits); break;
+			case ExprGt: done = compareSSE42 <ExprGt> (lhs, rhs, rhsIsConst, n, bits); break;
+			default: break;
+		}
+	}
+#endif
+	compareScalar (op, lhs, rhs, rhsIsConst, done, n, bits);
+}
+
+void MyDB_SimdKernels :: arith (MyDB_ExprOp op, const int *lhs, const int *rhs, bool rhsIsConst, size_t n, int *out) {
+
+	if (n == 0)
+		return;
+
+	// an int divide is always done by the plain loop
+	size_t done = 0;
+#ifdef MYDB_X86
+	if (level == SimdAVX2) {
+		switch (op) {
+			case ExprPlus: done = arithAVX2 <ExprPlus> (lhs, rhs, rhsIsConst, n, out); break;
+			case ExprMinus: done = arithAVX2 <ExprMinus> (lhs, rhs, rhsIsConst, n, out); break;
+			case ExprTimes: done = arithAVX2 <ExprTimes> (lhs, rhs, rhsIsConst, n, out); break;
+			default: break;
+		}
+	} else if (level == SimdSSE42) {
+		switch (op) {
+			case ExprPlus: done = arithSSE42 <ExprPlus> (lhs, rhs, rhsIsConst, n, out); break;
+			case ExprMinus: done = arithSSE42 <ExprMinus> (lhs, rhs, rhsIsConst, n, out); break;
+			case ExprTimes: done = arithSSE42 <ExprTimes> (lhs, rhs, rhsIsConst, n, out); break;
+			default: break;
+		}
+	}
+#endif
+	arithScalar (op, lhs, rhs, rhsIsConst, done, n, out);
+}
+
+void MyDB_SimdKernels :: arith (MyDB_ExprOp op, const double *lhs, const double *rhs, bool rhsIsConst, size_t n,
+	double *out) {
+
+	if (n == 0)
+		return;
+
+	size_t done = 0;
+#ifdef MYDB_X86
+	if (level == SimdAVX2) {
+		switch (op) {
+			case ExprPlus: done = arithAVX2 <ExprPlus> (lhs, rhs, rhsIsConst, n, out); break;
+			case ExprMinus: done = arithAVX2 <ExprMinus> (lhs, rhs, rhsIsConst, n, out); break;
+			case ExprTimes: done = arithAVX2 <ExprTimes> (lhs, rhs, rhsIsConst, n, out); break;
+			case ExprDivide: done = arithAVX2 <ExprDivide> (lhs, rhs, rhsIsConst, n, out); break;
+			default: break;
+		}
+	} else if (level == SimdSSE42) {
+		switch (op) {
+			case ExprPlus: done = arithSSE42 <ExprPlus> (lhs, rhs, rhsIsConst, n, out); break;
+			case ExprMinus: done = arithSSE42 <ExprMinus> (lhs, rhs, rhsIsConst, n, out); break;
+			case ExprTimes: done = arithSSE42 <ExprTimes> (lhs, rhs, rhsIsConst, n, out); break;
+			case ExprDivide: done = arithSSE42 <ExprDivide> (lhs, rhs, rhsIsConst, n, out); break;
+			default: break;
+		}
+	}
+#endif
+	arithScalar (op, lhs, rhs, rhsIsConst, done, n, out);
+}
+
+#endif
@@ -5,13 +5,19 @@
 #include "MyDB_AttType.h"  
 #include "MyDB_BufferManager.h"
 #include "MyDB_Catalog.h"  
+#include "MyDB_Expression.h"
+#include "MyDB_ExprKernel.h"
+#include "MyDB_FastPredicate.h"
 #include "MyDB_Page.h"
 #include "MyDB_PageReaderWriter.h"
 #include "MyDB_Record.h"
 #include "MyDB_Table.h"
 #include "MyDB_TableReaderWriter.h"
 #include "MyDB_Schema.h"
+#include "MyDB_SimdKernels.h"
 #include "QUnit.h"
+#include <cmath>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <time.h>
@@ -50,10 +56,177 @@ void initialize() {
 	cout << "finish initialization..." << flush;
 }
 
+// the schema for the record format tests; the strings are first, last, and next to each
+// other, so that each one starts right where the slots (or the string before it) end
+MyDB_SchemaPtr getFormatSchema () {
+	MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema> ();
+	mySchema->appendAtt (make_pair ("first", make_shared <MyDB_StringAttType> ()));
+	mySchema->appendAtt (make_pair ("second", make_shared <MyDB_StringAttType> ()));
+	mySchema->appendAtt (make_pair ("num", make_shared <MyDB_IntAttType> ()));
+	mySchema->appendAtt (make_pair ("bal", make_shared <MyDB_DoubleAttType> ()));
+	mySchema->appendAtt (make_pair ("last", make_shared <MyDB_StringAttType> ()));
+	return mySchema;
+}
+
+// loads the given values into the record
+void setAtts (MyDB_RecordPtr rec, vector <string> &vals) {
+	for (size_t i = 0; i < vals.size (); i++)
+		rec->getAtt (i)->fromString (vals[i]);
+	rec->recordContentHasChanged ();
+}
+
+// the record's attributes, as strings
+vector <string> getAtts (MyDB_RecordPtr rec) {
+	vector <string> returnVal;
+	for (size_t i = 0; i < rec->getSchema ()->getAtts ().size (); i++)
+		returnVal.push_back (rec->getAtt (i)->toString ());
+	return returnVal;
+}
+
+// writes the record in the old format, where the short holds the (positive) size of the
+// record, and each attribute has its own two-byte length; the caller deletes the bytes
+char *toOldFormat (MyDB_RecordPtr rec, size_t &size) {
+	size_t allocatedSize = sizeof (short);
+	char *bytes = new char[allocatedSize];
+	size = sizeof (short);
+	for (size_t i = 0; i < rec->getSchema ()->getAtts ().size (); i++)
+		rec->getAtt (i)->serialize (bytes, allocatedSize, size);
+	*((short *) bytes) = (short) size;
+	return bytes;
+}
+
+// the schema for the agreement test
+MyDB_SchemaPtr getAgreeSchema () {
+	MyDB_SchemaPtr mySchema = make_shared <MyDB_Schema> ();
+	mySchema->appendAtt (make_pair ("i", make_shared <MyDB_IntAttType> ()));
+	mySchema->appendAtt (make_pair ("j", make_shared <MyDB_IntAttType> ()));
+	mySchema->appendAtt (make_pair ("d", make_shared <MyDB_DoubleAttType> ()));
+	mySchema->appendAtt (make_pair ("e", make_shared <MyDB_DoubleAttType> ()));
+	mySchema->appendAtt (make_pair ("s", make_shared <MyDB_StringAttType> ()));
+	mySchema->appendAtt (make_pair ("t", make_shared <MyDB_StringAttType> ()));
+	return mySchema;
+}
+
+// row r of the data for the agreement test; j and e are never zero, so that they can be
+// divided by, and some of the d's are not numbers
+#define NUM_AGREE_ROWS 420
+vector <string> getAgreeRow (int row) {
+	vector <string> js = {"-2", "-1", "1", "2"};
+	vector <string> ds = {"-1.5", "0", "0.5", "2", "3", "nan"};
+	vector <string> es = {"-1.5", "0.5", "1", "2", "3"};
+	vector <string> strings = {"", "a", "ab", "b", "Supplier#1"};
+	return {to_string (row % 7 - 3), js[(row / 7) % 4], ds[row % 6], es[(row / 3) % 5], strings[row % 5],
+		strings[(row / 5) % 5]};
+}
+
+// a value, as a string that is the same no matter how it was computed
+string showDouble (double val) {
+	return isnan (val) ? "nan" : to_string (val);
+}
+
+string showAtt (MyDB_ExprType type, MyDB_AttValPtr att) {
+	if (type == DoubleExpr)
+		return showDouble (att->toDouble ());
+	if (type == BoolExpr)
+		return att->toBool () ? "true" : "false";
+	return att->toString ();
+}
+
+// the typed closures for the expression, with the result shown as above
+function <string ()> compileShown (MyDB_Expression &expr, vector <MyDB_AttValPtr> &atts) {
+	if (expr.getType () == IntExpr) {
+		function <int ()> f = expr.compileInt (atts);
+		return [f] {return to_string (f ());};
+	} else if (expr.getType () == DoubleExpr) {
+		function <double ()> f = expr.compileDouble (atts);
+		return [f] {return showDouble (f ());};
+	} else if (expr.getType () == BoolExpr) {
+		function <bool ()> f = expr.compileBool (atts);
+		return [f] {return string (f () ? "true" : "false");};
+	} else {
+		function <const char *()> f = expr.compileString (atts);
+		return [f] {return string (f ());};
+	}
+}
+
+// checks that one way of computing comp gave the same results as the helpers did
+void checkAgree (QUnit::UnitTest &qunit, string comp, string how, vector <string> &expected, vector <string> &got) {
+	if (expected != got)
+		cout << how << " differ on " << comp << "..." << flush;
+	QUNIT_IS_TRUE (expected == got);
+}
+
+// the right answers for the SIMD kernels, one entry at a time
+template <class T>
+bool compareOne (MyDB_ExprOp op, T lhs, T rhs) {
+	return op == ExprEq ? lhs == rhs : op == ExprNeq ? lhs != rhs : op == ExprLt ? lhs < rhs : lhs > rhs;
+}
+
+template <class T>
+T arithOne (MyDB_ExprOp op, T lhs, T rhs) {
+	return op == ExprPlus ? lhs + rhs : op == ExprMinus ? lhs - rhs : op == ExprTimes ? lhs * rhs : lhs / rhs;
+}
+
+bool sameValue (int lhs, int rhs) {
+	return lhs == rhs;
+}
+
+bool sameValue (double lhs, double rhs) {
+	return (isnan (lhs) && isnan (rhs)) || lhs == rhs;
+}
+
+// runs every comparison and arithmetic operation over the first n entries of lhs and rhs (or
+// lhs and rhs[0], if rhsIsConst) with the kernels at the given level, and checks the results
+// against the plain loops, and against the kernels at SimdScalar.  The bitmaps have an extra
+// word, and the outputs an extra entry, that should not be touched
+template <class T>
+void checkSimd (QUnit::UnitTest &qunit, MyDB_SimdLevel level, vector <T> &lhs, vector <T> &rhs, size_t n, bool rhsIsConst) {
+
+	for (MyDB_ExprOp op : {ExprEq, ExprNeq, ExprLt, ExprGt}) {
+		vector <uint64_t> expected ((n + 63) / 64 + 1, 0);
+		for (size_t k = 0; k < n; k++) {
+			if (compareOne (op, lhs[k], rhsIsConst ? rhs[0] : rhs[k]))
+				expected[k / 64] |= ((uint64_t) 1) << (k % 64);
+		}
+		expected.back () = 12345;
+
+		vector <uint64_t> scalar (expected.size (), 0), got (expected.size (), 0);
+		scalar.back () = got.back () = 12345;
+		MyDB_SimdKernels :: setLevel (SimdScalar);
+		MyDB_SimdKernels :: compare (op, lhs.data (), rhs.data (), rhsIsConst, n, scalar.data ());
+		MyDB_SimdKernels :: setLevel (level);
+		MyDB_SimdKernels :: compare (op, lhs.data (), rhs.data (), rhsIsConst, n, got.data ());
+		QUNIT_IS_TRUE (scalar == expected);
+		QUNIT_IS_TRUE (got == scalar);
+	}
+
+	for (MyDB_ExprOp op : {ExprPlus, ExprMinus, ExprTimes, ExprDivide}) {
+		vector <T> expected (n + 1, 7);
+		for (size_t k = 0; k < n; k++)
+			expected[k] = arithOne (op, lhs[k], rhsIsConst ? rhs[0] : rhs[k]);
+
+		// the last run writes over its lhs
+		vector <T> scalar (n + 1, 7), got (n + 1, 7), inPlace (lhs.begin (), lhs.begin () + n);
+		inPlace.push_back (7);
+		MyDB_SimdKernels :: setLevel (SimdScalar);
+		MyDB_SimdKernels :: arith (op, lhs.data (), rhs.data (), rhsIsConst, n, scalar.data ());
+		MyDB_SimdKernels :: setLevel (level);
+		MyDB_SimdKernels :: arith (op, lhs.data (), rhs.data (), rhsIsConst, n, got.data ());
+		MyDB_SimdKernels :: arith (op, inPlace.data (), rhs.data (), rhsIsConst, n, inPlace.data ());
+
+		bool allSame = true;
+		for (size_t k = 0; k <= n; k++) {
+			allSame = allSame && sameValue (scalar[k], expected[k]) && sameValue (got[k], scalar[k]) &&
+				sameValue (inPlace[k], scalar[k]);
+		}
+		QUNIT_IS_TRUE (allSame);
+	}
+}
+
 int main(int argc, char *argv[]) {
 	int start = 1;
 	if (argc > 1 && argv[1][0] >= '0' && argv[1][0] <= '9') {
-		start = argv[1][0] - '0';
+		start = atoi (argv[1]);
 	}
 	cout << "start from test " << start << endl << flush;
 
@@ -463,6 +636,267 @@ int main(int argc, char *argv[]) {
 		QUNIT_IS_FALSE(result);
 	}
 	FALLTHROUGH_INTENDED;
+	case 11:
+	{
+		// records in the offset format and in the old format, with empty and long strings
+		// at the slot boundaries, and records written after reading the old format
+		cout << "TEST 11..." << flush;
+		int errorsBefore = qunit.errors ();
+		{
+			MyDB_RecordPtr rec = make_shared <MyDB_Record> (getFormatSchema ());
+			MyDB_RecordPtr other = make_shared <MyDB_Record> (getFormatSchema ());
+
+			// the long strings push the strings after them past an offset of 255
+			string longOne (1000, 'x');
+			vector <vector <string>> allVals = {
+				{"", "", "0", "0", ""},
+				{"a", "", "-1", "2.5", ""},
+				{"", "b", "7", "-3.25", "c"},
+				{longOne, "", "12", "1e10", longOne + "y"},
+				{"", longOne, "2147483647", "0.125", ""}};
+
+			size_t slotsEnd = sizeof (short) + 3 * sizeof (unsigned short) + sizeof (int) + sizeof (double);
+			for (vector <string> &vals : allVals) {
+
+				setAtts (rec, vals);
+				vector <string> expected = getAtts (rec);
+
+				cout << "offset format..." << flush;
+				size_t size = rec->getBinarySize ();
+				QUNIT_IS_EQUAL (size, slotsEnd + vals[0].size () + vals[1].size () + vals[4].size () + 3);
+				vector <char> bytes (size + 1, 'z');
+				char *start = bytes.data ();
+				QUNIT_IS_TRUE (rec->toBinary (start) == start + size);
+				QUNIT_IS_EQUAL (*((short *) start), -(int) size);
+				QUNIT_IS_EQUAL (MyDB_Record :: getBinarySize (start), size);
+				QUNIT_IS_EQUAL ((int) bytes[size - 1], 0);
+				QUNIT_IS_TRUE (bytes[size] == 'z');
+
+				// the strings are packed right after the slots, in order
+				QUNIT_IS_TRUE (rec->getAttAddress (start, 0) == start + slotsEnd);
+				QUNIT_IS_TRUE (rec->getAttAddress (start, 1) == start + slotsEnd + vals[0].size () + 1);
+				QUNIT_IS_TRUE (rec->getAttAddress (start, 4) == start + slotsEnd + vals[0].size () + vals[1].size () + 2);
+				QUNIT_IS_TRUE (rec->getAttAddress (start, 2) == start + sizeof (short) + 2 * sizeof (unsigned short));
+				QUNIT_IS_EQUAL (string (rec->getAttAddress (start, 4)), vals[4]);
+
+				QUNIT_IS_TRUE (other->fromBinary (start) == start + size);
+				QUNIT_IS_TRUE (getAtts (other) == expected);
+				QUNIT_IS_TRUE (other->viewBinary (start) == start + size);
+				QUNIT_IS_TRUE (getAtts (other) == expected);
+
+				cout << "old format..." << flush;
+				size_t oldSize;
+				char *old = toOldFormat (rec, oldSize);
+				QUNIT_IS_EQUAL (oldSize, size + 2 * sizeof (short));
+				QUNIT_IS_EQUAL (MyDB_Record :: getBinarySize (old), oldSize);
+				QUNIT_IS_TRUE (rec->getAttAddress (old, 0) == nullptr);
+				for (int useView = 0; useView < 2; useView++) {
+
+					char *end = (char *) (useView ? other->viewBinary (old) : other->fromBinary (old));
+					QUNIT_IS_TRUE (end == old + oldSize);
+					QUNIT_IS_TRUE (getAtts (other) == expected);
+
+					// writing it out as it is gives back the same record
+					QUNIT_IS_EQUAL (other->getBinarySize (), oldSize);
+					vector <char> again (oldSize);
+					other->toBinary (again.data ());
+					rec->fromBinary (again.data ());
+					QUNIT_IS_TRUE (getAtts (rec) == expected);
+
+					// after a change, it is written in the offset format; the strings that were
+					// read from the old format come along
+					other->getAtt (2)->fromInt (99);
+					other->recordContentHasChanged ();
+					QUNIT_IS_EQUAL (other->getBinarySize (), size);
+					vector <char> changed (size);
+					other->toBinary (changed.data ());
+					QUNIT_IS_EQUAL (*((short *) changed.data ()), -(int) size);
+					rec->viewBinary (changed.data ());
+					vector <string> expectedNow = expected;
+					expectedNow[2] = "99";
+					QUNIT_IS_TRUE (getAtts (rec) == expectedNow);
+					QUNIT_IS_TRUE (getAtts (other) == expectedNow);
+
+					// and again, now that the strings are read from the buffer that it wrote
+					other->getAtt (2)->fromInt (100);
+					other->recordContentHasChanged ();
+					other->toBinary (changed.data ());
+					rec->fromBinary (changed.data ());
+					expectedNow[2] = "100";
+					QUNIT_IS_TRUE (getAtts (rec) == expectedNow);
+				}
+				delete [] old;
+			}
+		}
+		if (qunit.errors () == errorsBefore) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+	}
+	FALLTHROUGH_INTENDED;
+	case 12:
+	{
+		// every way of compiling a computation gives the same results: the comparisons,
+		// with ints promoted to doubles and literals on either side, the logical operations,
+		// and the arithmetic.  The helpers are the reference
+		cout << "TEST 12..." << flush;
+		int errorsBefore = qunit.errors ();
+		{
+			MyDB_SchemaPtr mySchema = getAgreeSchema ();
+			MyDB_RecordPtr rec = make_shared <MyDB_Record> (mySchema);
+			vector <MyDB_AttValPtr> atts;
+			for (size_t i = 0; i < mySchema->getAtts ().size (); i++)
+				atts.push_back (rec->getAtt (i));
+
+			// the rows, written out one after another
+			vector <char> bytes;
+			vector <size_t> offsets;
+			for (int row = 0; row < NUM_AGREE_ROWS; row++) {
+				vector <string> vals = getAgreeRow (row);
+				setAtts (rec, vals);
+				offsets.push_back (bytes.size ());
+				bytes.resize (bytes.size () + rec->getBinarySize ());
+				rec->toBinary (bytes.data () + offsets.back ());
+			}
+
+			// each computation, and whether MyDB_FastPredicate takes it; the ones with a literal
+			// on the left have their comparison flipped
+			vector <pair <string, bool>> comps = {
+				{"== ([i], [j])", true},
+				{"!= ([i], int[2])", true},
+				{"< ([i], [d])", false},
+				{"> ([e], [i])", false},
+				{"> (int[1], [i])", true},
+				{"< (double[0.5], [d])", true},
+				{"> (int[1], [d])", true},
+				{"== (double[2], [i])", false},
+				{"== (string[a], [s])", true},
+				{"!= (string[ab], [s])", true},
+				{"< ([s], [t])", true},
+				{"> ([s], string[a])", true},
+				{"< (string[ab], [t])", true},
+				{"&& (> ([i], int[-1]), < (double[0.5], [d]))", true},
+				{"|| (== ([i], [j]), < ([s], [t]))", false},
+				{"! (> ([d], [e]))", false},
+				{"&& (! (== ([s], string[b])), || (< ([i], int[0]), > ([e], double[1.0])))", false},
+				{"> (+ ([i], [j]), * ([d], int[2]))", false},
+				{"== (- ([i], [j]), int[1])", false},
+				{"< (/ ([i], [j]), int[0])", false},
+				{"> (/ ([d], [e]), double[0.5])", false},
+				{"== (+ ([s], [t]), string[ab])", false},
+				{"+ ([i], [j])", false},
+				{"- ([i], [d])", false},
+				{"* ([i], double[2.5])", false},
+				{"/ ([i], [j])", false},
+				{"/ ([d], [j])", false},
+				{"- (int[3], [i])", false},
+				{"* (- ([i], [j]), + ([e], int[1]))", false},
+				{"+ ([s], [t])", false}};
+
+			vector <void *> positions;
+			for (size_t offset : offsets)
+				positions.push_back (bytes.data () + offset);
+
+			for (pair <string, bool> &compAndFast : comps) {
+
+				string comp = compAndFast.first;
+				// a bool is wrapped in two nots, which keeps it off of the fast path, so that
+				// the whole thing goes through the helpers
+				MyDB_Expression expr (comp, mySchema);
+				MyDB_ExprType type = expr.getType ();
+				func helpers = rec->compileComputation (type == BoolExpr ? "! (! (" + comp + "))" : comp);
+				function <string ()> closures = compileShown (expr, atts);
+				func bytecode = rec->compileComputation (comp, true);
+				function <bool ()> bytecodePred, pred, fast;
+				if (type == BoolExpr) {
+					bytecodePred = rec->compilePredicate (comp, true);
+					pred = rec->compilePredicate (comp);
+				}
+				func computation = rec->compileComputation (comp);
+				bool isFast = MyDB_FastPredicate :: compile (expr, atts, fast);
+				QUNIT_IS_EQUAL (isFast, compAndFast.second);
+
+				vector <string> fromHelpers, fromClosures, fromBytecode, fromBytecodePred, fromComputation, fromPred, fromFast;
+				for (size_t offset : offsets) {
+					rec->fromBinary (bytes.data () + offset);
+					fromHelpers.push_back (showAtt (type, helpers ()));
+					fromClosures.push_back (closures ());
+					fromBytecode.push_back (showAtt (type, bytecode ()));
+					fromComputation.push_back (showAtt (type, computation ()));
+					if (type == BoolExpr) {
+						fromBytecodePred.push_back (bytecodePred () ? "true" : "false");
+						fromPred.push_back (pred () ? "true" : "false");
+					}
+					if (isFast)
+						fromFast.push_back (fast () ? "true" : "false");
+				}
+				checkAgree (qunit, comp, "closures", fromHelpers, fromClosures);
+				checkAgree (qunit, comp, "bytecode", fromHelpers, fromBytecode);
+				checkAgree (qunit, comp, "computations", fromHelpers, fromComputation);
+				if (type == BoolExpr) {
+					checkAgree (qunit, comp, "bytecode predicates", fromHelpers, fromBytecodePred);
+					checkAgree (qunit, comp, "predicates", fromHelpers, fromPred);
+				}
+				if (isFast)
+					checkAgree (qunit, comp, "fast predicates", fromHelpers, fromFast);
+
+				// the batch kernel picks out the same rows, straight from the bytes
+				if (type == BoolExpr) {
+					MyDB_ExprKernel kernel (comp, rec);
+					vector <int> selected (positions.size ());
+					selected.resize (kernel.select (positions.data (), positions.size (), selected.data ()));
+					vector <string> fromKernel (positions.size (), "false");
+					for (int which : selected)
+						fromKernel[which] = "true";
+					checkAgree (qunit, comp, "kernels", fromHelpers, fromKernel);
+				}
+			}
+		}
+		if (qunit.errors () == errorsBefore) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+	}
+	FALLTHROUGH_INTENDED;
+	case 13:
+	{
+		// the SIMD kernels at each level that the CPU can run, over lengths that are empty,
+		// shorter than a vector, right at one, just past one, and long, with NaNs in the
+		// doubles, and with a constant on the right (a number, and a NaN)
+		cout << "TEST 13..." << flush;
+		int errorsBefore = qunit.errors ();
+		{
+			size_t maxN = 1025;
+			vector <int> intLhs, intRhs;
+			vector <double> doubleLhs, doubleRhs, nanRhs;
+			for (size_t k = 0; k < maxN; k++) {
+
+				// there are no zeros in intRhs, since an int divide by zero fails
+				int rhs = (int) ((k * 5) % 9) - 4;
+				intLhs.push_back ((int) ((k * 7) % 11) - 5);
+				intRhs.push_back (rhs == 0 ? 3 : rhs);
+				doubleLhs.push_back (k % 13 == 5 ? NAN : intLhs.back () * 0.5);
+				doubleRhs.push_back (k % 17 == 16 ? NAN : ((int) (k % 5) - 2) * 0.25);
+				nanRhs.push_back (k == 0 ? NAN : doubleRhs.back ());
+			}
+
+			MyDB_SimdLevel before = MyDB_SimdKernels :: getLevel ();
+			for (MyDB_SimdLevel level : {SimdScalar, SimdSSE42, SimdAVX2}) {
+				if (level > MyDB_SimdKernels :: getBestLevel ()) {
+					cout << "level " << level << " can't run here..." << flush;
+					continue;
+				}
+				cout << "level " << level << "..." << flush;
+				for (size_t n : {0, 1, 7, 8, 9, 1025}) {
+					for (bool rhsIsConst : {false, true}) {
+						checkSimd (qunit, level, intLhs, intRhs, n, rhsIsConst);
+						checkSimd (qunit, level, doubleLhs, doubleRhs, n, rhsIsConst);
+					}
+					checkSimd (qunit, level, doubleLhs, nanRhs, n, true);
+				}
+			}
+			MyDB_SimdKernels :: setLevel (before);
+		}
+		if (qunit.errors () == errorsBefore) cout << "CORRECT" << endl << flush;
+		else cout << "***FAIL***" << endl << flush;
+	}
+	FALLTHROUGH_INTENDED;
 	default:
 		break;
 	}
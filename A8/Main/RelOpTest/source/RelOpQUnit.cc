@@ -25,12 +25,104 @@
 #include "RegularSelectionMultiThread.h"
 #include "ScanJoin.h"
 #include "SortMergeJoin.h"
+#include <algorithm>
 #include <iostream>
+#include <sstream>
+#include <thread>
 #include <vector>
 #include <utility>
 
 using namespace std;
 
+// the page size and the number of pages for the buffers that operators get only a few frames
+// of; a 6-page buffer lets an operator reserve just one frame
+#define SMALL_PAGE_SIZE 16384
+#define TINY_BUFFER_PAGES 6
+#define SMALL_BUFFER_PAGES 24
+
+// the records of a table, written out and sorted, so that the outputs of two runs can be compared
+vector <string> getContents (MyDB_TableReaderWriterPtr table) {
+	vector <string> contents;
+	MyDB_RecordPtr temp = table->getEmptyRecord ();
+	MyDB_RecordIteratorAltPtr myIter = table->getIteratorAlt ();
+	while (myIter->advance ()) {
+		myIter->getCurrent (temp);
+		ostringstream out;
+		out << temp;
+		contents.push_back (out.str ());
+	}
+	sort (contents.begin (), contents.end ());
+	return contents;
+}
+
+// loads supplier.tbl into a table in the given buffer manager
+MyDB_TableReaderWriterPtr loadSupplier (MyDB_BufferManagerPtr myMgr, MyDB_SchemaPtr mySchema, string name) {
+	MyDB_TablePtr myTable = make_shared <MyDB_Table> (name, name + ".bin", mySchema);
+	MyDB_TableReaderWriterPtr returnVal = make_shared <MyDB_TableReaderWriter> (myTable, myMgr);
+	returnVal->loadFromTextFile ("supplier.tbl");
+	return returnVal;
+}
+
+// this basically runs:
+//
+// SELECT l_suppkey, SUM (l_acctbal), COUNT (0)
+// FROM input
+// GROUP BY l_suppkey
+//
+// there is a group for every record, so unless the buffer is big, the groups do not all fit
+MyDB_TableReaderWriterPtr runManyGroups (MyDB_BufferManagerPtr myMgr, MyDB_TableReaderWriterPtr input, string name) {
+
+	vector <pair <MyDB_AggType, string>> aggsToCompute;
+	aggsToCompute.push_back (make_pair (MyDB_AggType :: sum, "[l_acctbal]"));
+	aggsToCompute.push_back (make_pair (MyDB_AggType :: cnt, "int[0]"));
+
+	vector <string> groupings;
+	groupings.push_back ("[l_suppkey]");
+
+	MyDB_SchemaPtr mySchemaOut = make_shared <MyDB_Schema> ();
+	mySchemaOut->appendAtt (make_pair ("l_suppkey", make_shared <MyDB_IntAttType> ()));
+	mySchemaOut->appendAtt (make_pair ("l_acctbal_sum", make_shared <MyDB_DoubleAttType> ()));
+	mySchemaOut->appendAtt (make_pair ("l_cnt", make_shared <MyDB_IntAttType> ()));
+	MyDB_TablePtr aggTable = make_shared <MyDB_Table> (name, name + ".bin", mySchemaOut);
+	MyDB_TableReaderWriterPtr output = make_shared <MyDB_TableReaderWriter> (aggTable, myMgr);
+
+	Aggregate myOp (input, output, aggsToCompute, groupings, "bool[true]");
+	myOp.run ();
+	return output;
+}
+
+// this basically runs:
+//
+// SELECT l_name, r_name, l_acctbal * r_acctbal
+// FROM left, right
+// WHERE l_suppkey = r_suppkey AND l_nationkey < 10 AND r_acctbal > 0
+//
+// the left table is hashed a chunk at a time, so unless the buffer is big, the right
+// table is scanned many times
+MyDB_TableReaderWriterPtr runSuppkeyJoin (MyDB_BufferManagerPtr myMgr, MyDB_TableReaderWriterPtr left,
+	MyDB_TableReaderWriterPtr right, string name) {
+
+	vector <pair <string, string>> hashAtts;
+	hashAtts.push_back (make_pair (string ("[l_suppkey]"), string ("[r_suppkey]")));
+
+	vector <string> projections;
+	projections.push_back ("[l_name]");
+	projections.push_back ("[r_name]");
+	projections.push_back ("* ([l_acctbal], [r_acctbal])");
+
+	MyDB_SchemaPtr mySchemaOut = make_shared <MyDB_Schema> ();
+	mySchemaOut->appendAtt (make_pair ("l_name", make_shared <MyDB_StringAttType> ()));
+	mySchemaOut->appendAtt (make_pair ("r_name", make_shared <MyDB_StringAttType> ()));
+	mySchemaOut->appendAtt (make_pair ("acctbal_product", make_shared <MyDB_DoubleAttType> ()));
+	MyDB_TablePtr joinTable = make_shared <MyDB_Table> (name, name + ".bin", mySchemaOut);
+	MyDB_TableReaderWriterPtr output = make_shared <MyDB_TableReaderWriter> (joinTable, myMgr);
+
+	ScanJoin myOp (left, right, output, "== ([l_suppkey], [r_suppkey])", projections, hashAtts,
+		"< ([l_nationkey], int[10])", "> ([r_acctbal], int[0])");
+	myOp.run ();
+	return output;
+}
+
 int main () {
 
 	QUnit::UnitTest qunit(cerr, QUnit::verbose);
@@ -650,6 +742,59 @@ int main () {
                 }
 	}
 
+	{
+		// run an aggregation and a join with a buffer that is big enough to do each of them
+		// in one pass; this is what they should give with less RAM, too
+		cout << "\nRunning the aggregate and the join in one pass.\n";
+		MyDB_BufferManagerPtr bigMgr = make_shared <MyDB_BufferManager> (SMALL_PAGE_SIZE, 1024, "tempFileBig");
+		MyDB_TableReaderWriterPtr bigL = loadSupplier (bigMgr, mySchemaL, "bigLeft");
+		MyDB_TableReaderWriterPtr bigR = loadSupplier (bigMgr, mySchemaR, "bigRight");
+		vector <string> aggExpected = getContents (runManyGroups (bigMgr, bigL, "bigAggOut"));
+		vector <string> joinExpected = getContents (runSuppkeyJoin (bigMgr, bigL, bigR, "bigJoinOut"));
+		cout << "The aggregate has " << aggExpected.size () << " groups, and the join has " << joinExpected.size () << " records.\n";
+		QUNIT_IS_EQUAL (aggExpected.size (), 10000);
+		QUNIT_IS_TRUE (joinExpected.size () > 0);
+
+		// with a tiny buffer, each operator is granted a single frame, so the aggregate
+		// needs a pass for every page of groups, and the join scans the right table once
+		// for every page of the left table
+		{
+			cout << "Running them with a " << TINY_BUFFER_PAGES << "-page buffer.\n";
+			MyDB_BufferManagerPtr tinyMgr = make_shared <MyDB_BufferManager> (SMALL_PAGE_SIZE, TINY_BUFFER_PAGES, "tempFileTiny");
+			QUNIT_IS_EQUAL (tinyMgr->reserveFrames (1000), 1);
+			tinyMgr->releaseFrames (1);
+
+			MyDB_TableReaderWriterPtr tinyL = loadSupplier (tinyMgr, mySchemaL, "tinyLeft");
+			MyDB_TableReaderWriterPtr tinyR = loadSupplier (tinyMgr, mySchemaR, "tinyRight");
+			QUNIT_IS_TRUE (getContents (runManyGroups (tinyMgr, tinyL, "tinyAggOut")) == aggExpected);
+			QUNIT_IS_TRUE (getContents (runSuppkeyJoin (tinyMgr, tinyL, tinyR, "tinyJoinOut")) == joinExpected);
+			QUNIT_IS_EQUAL (tinyMgr->getNumUnreserved (), tinyMgr->getNumPages ());
+		}
+
+		// two operators at once, in a buffer that is too small for either of them to get all
+		// the frames it asks for; the reservations never add up to more than the buffer can
+		// spare, so one of them waits for the other
+		{
+			cout << "Running them at the same time with a " << SMALL_BUFFER_PAGES << "-page buffer.\n";
+			MyDB_BufferManagerPtr smallMgr = make_shared <MyDB_BufferManager> (SMALL_PAGE_SIZE, SMALL_BUFFER_PAGES, "tempFileSmall");
+			MyDB_TableReaderWriterPtr smallL = loadSupplier (smallMgr, mySchemaL, "smallLeft");
+			MyDB_TableReaderWriterPtr smallR = loadSupplier (smallMgr, mySchemaR, "smallRight");
+
+			vector <string> aggGot, joinGot;
+			thread aggThread ([&] {
+				aggGot = getContents (runManyGroups (smallMgr, smallL, "smallAggOut"));
+			});
+			thread joinThread ([&] {
+				joinGot = getContents (runSuppkeyJoin (smallMgr, smallL, smallR, "smallJoinOut"));
+			});
+			aggThread.join ();
+			joinThread.join ();
+
+			QUNIT_IS_TRUE (aggGot == aggExpected);
+			QUNIT_IS_TRUE (joinGot == joinExpected);
+			QUNIT_IS_EQUAL (smallMgr->getNumUnreserved (), smallMgr->getNumPages ());
+		}
+	}
 }
 
 #endif
@@ -7,9 +7,9 @@
 #include <utility>
 #include <vector>
 
-// This class encapulates a simple, hash-based aggregation + group by.  It does not
-// need to work when there is not enough space in the buffer manager to store all of
-// the groups.
+// This class encapulates a simple, hash-based aggregation + group by.  If there is
+// not enough space in the buffer manager to store all of the groups, the input
+// records for the groups that do not fit are spilled, and aggregated in another pass.
 
 enum MyDB_AggType {sum, avg, cnt};
 
@@ -9,8 +9,9 @@
 
 // This class encapulates a scan join, where one table is hashed, and then the 
 // other is scanned and joined with the hashed table.  If the smaller table is
-// too large to be stored in the buffer manager in its entirity, then the join
-// will fail.
+// too large to be stored in the buffer manager in its entirity (or if other
+// queries have reserved too much of the buffer), then it is hashed a chunk at
+// a time, and the other table is scanned once for each chunk.
 //
 class ScanJoin {
 
@@ -4,6 +4,7 @@
 
 #include "MyDB_Record.h"
 #include "MyDB_PageReaderWriter.h"
+#include "MyDB_Reservation.h"
 #include "MyDB_TableReaderWriter.h"
 #include "Aggregate.h"
 #include <unordered_map>
@@ -56,16 +57,6 @@ void Aggregate :: run () {
 	MyDB_RecordPtr combinedRec = make_shared <MyDB_Record> (combinedSchema);
 	combinedRec->buildFrom (inputRec, aggRec);
 	
-	// this is the current page where we are writing aggregate records
-	MyDB_PageReaderWriter lastPage (true, *(input->getBufferMgr ()));
-
-	// this is the list all of the pages used to store aggregate records
-	vector <MyDB_PageReaderWriter> allPages;
-	allPages.push_back (lastPage);
-
-	// this is the hash index for all of the aggregate records
-	unordered_map <size_t, vector <void *>> myHash;
-
 	// this will compute each of the groupings
 	vector <func> groupingComps;
 	for (auto &s : groupings) {
@@ -73,7 +64,7 @@ void Aggregate :: run () {
 	}
 
 	// and this will verify that each of the groupings match up
-	func checkGroups;
+	function <bool ()> checkGroups;
 	string groupCheck;
 	i = 0;
 
@@ -89,7 +80,7 @@ void Aggregate :: run () {
 		}
 		i++;
 	}
-	checkGroups = combinedRec->compileComputation (groupCheck);	
+	checkGroups = combinedRec->compilePredicate (groupCheck);	
 
 	// this will compute each of the aggregates for updating the aggregate record
 	vector <func> aggComps;
@@ -116,105 +107,152 @@ void Aggregate :: run () {
 	aggComps.push_back (combinedRec->compileComputation ("+ ( int[1], [MyDB_CntAtt])"));
 
 	// and this runs the selection on the input records
-	func inputPred = inputRec->compileComputation (selectionPredicate);
+	function <bool ()> inputPred = inputRec->compilePredicate (selectionPredicate);
+
+	// the aggregate records are kept in pinned pages, as many as we could reserve frames
+	// for.  If the groups do not all fit, then the input records for the groups that do
+	// not fit are spilled to anonymous pages, and once the groups that do fit have been
+	// output, the spilled records are aggregated in another pass
+	MyDB_Reservation frames (input->getBufferMgr (), input->getNumPages () + 1);
 
-	// at this point, we are ready to go!!
-	MyDB_RecordIteratorPtr myIter = input->getIterator (inputRec);
+	// at this point, we are ready to go!!  The input is only scanned once, so don't let it flush the buffer
+	MyDB_RecordIteratorAltPtr myIter = input->getIteratorAlt (true);
 	MyDB_AttValPtr zero = make_shared <MyDB_IntAttVal> ();
-	while (myIter->hasNext ()) {
+	while (true) {
 
-		myIter->getNext ();
+		// this is the current page where we are writing aggregate records
+		MyDB_PageReaderWriter lastPage (true, *(input->getBufferMgr ()));
 
-		// see if it is accepted by the preicate
-		if (!inputPred ()->toBool ()) {
-			continue;
-		}
+		// this is the list all of the pages used to store aggregate records
+		vector <MyDB_PageReaderWriter> allPages;
+		allPages.push_back (lastPage);
 
-		// hash the current record
-		size_t hashVal = 0;
-		for (auto &f : groupingComps) {
-			hashVal ^= f ()->hash ();
-		}
+		// this is the hash index for all of the aggregate records
+		unordered_map <size_t, vector <void *>> myHash;
 
-		// if there is a match, then get the list of matches
-		vector <void *> &potentialMatches = myHash [hashVal];
-		void *loc = nullptr;
+		// these are the pages holding the input records that did not fit in this pass
+		vector <MyDB_PageReaderWriter> spilled;
 
-		// and iterate though the potential matches, checking each of them
-		for (auto &v : potentialMatches) {	
+		while (myIter->advance ()) {
 
-			aggRec->fromBinary (v);
+			// the input record is viewed on its page; it is copied below if it has to
+			// be kept across anything that could evict the page
+			myIter->getCurrentView (inputRec);
 
-			// check to see if it matches
-			if (!checkGroups ()->toBool ()) {
+			// see if it is accepted by the preicate
+			if (!inputPred ()) {
 				continue;
 			}
 
-			loc = v;
-			break;
-		}
-
-		// if we did not find a match...
-		if (loc == nullptr) {
-
-			// set up the record...
-			i = 0;
+			// hash the current record
+			size_t hashVal = 0;
 			for (auto &f : groupingComps) {
-				aggRec->getAtt (i++)->set (f ());
-			}
-			for (int j = 0; j < aggComps.size (); j++) {
-				aggRec->getAtt (i++)->set (zero);
+				hashVal ^= f ()->hash ();
 			}
-		}
 
-		// update each of the aggregates
-		i = 0;
-		for (auto &f : aggComps) {
-			aggRec->getAtt (numGroups + i++)->set (f ());
-		}
+			// if there is a match, then get the list of matches
+			vector <void *> &potentialMatches = myHash [hashVal];
+			void *loc = nullptr;
+
+			// and iterate though the potential matches, checking each of them
+			for (auto &v : potentialMatches) {	
+
+				// the aggregate pages are pinned
+				aggRec->viewBinary (v);
 
-		// if we did not find a match, write to a new location...
-		aggRec->recordContentHasChanged ();
-		if (loc == nullptr) {
-			loc = lastPage.appendAndReturnLocation (aggRec);
+				// check to see if it matches
+				if (!checkGroups ()) {
+					continue;
+				}
 
-			// if we could not write, then the page was full
+				loc = v;
+				break;
+			}
+
+			// if we did not find a match...
 			if (loc == nullptr) {
-				MyDB_PageReaderWriter nextPage (true, *(input->getBufferMgr ()));
-				lastPage = nextPage;
-				allPages.push_back (lastPage);
-				loc = lastPage.appendAndReturnLocation (aggRec);	
+
+				// set up the record...
+				i = 0;
+				for (auto &f : groupingComps) {
+					aggRec->getAtt (i++)->set (f ());
+				}
+				for (int j = 0; j < aggComps.size (); j++) {
+					aggRec->getAtt (i++)->set (zero);
+				}
+			}
+
+			// update each of the aggregates
+			i = 0;
+			for (auto &f : aggComps) {
+				aggRec->getAtt (numGroups + i++)->set (f ());
 			}
 
-			aggRec->fromBinary (loc);
-			myHash [hashVal].push_back (loc);
+			// if we did not find a match, write to a new location...
+			aggRec->recordContentHasChanged ();
+			if (loc == nullptr) {
 
-		// otherwise, re-write to the old location
-		} else {
-			aggRec->toBinary (loc);
+				// getting a new page could evict the input record's page
+				inputRec->materialize ();
+
+				// once we have started to spill, no new groups are started in this pass,
+				// so that all of the records for a group are aggregated in the same pass
+				if (spilled.size () == 0)
+					loc = lastPage.appendAndReturnLocation (aggRec);
+
+				// if we could not write, then the page was full
+				if (loc == nullptr && spilled.size () == 0 && allPages.size () < frames.size ()) {
+					MyDB_PageReaderWriter nextPage (true, *(input->getBufferMgr ()));
+					lastPage = nextPage;
+					allPages.push_back (lastPage);
+					loc = lastPage.appendAndReturnLocation (aggRec);	
+				}
+
+				// if we are out of frames, this record has to wait for the next pass
+				if (loc == nullptr) {
+					if (spilled.size () == 0 || !spilled.back ().append (inputRec)) {
+						spilled.push_back (MyDB_PageReaderWriter (*(input->getBufferMgr ())));
+						spilled.back ().append (inputRec);
+					}
+					continue;
+				}
+
+				aggRec->viewBinary (loc);
+				myHash [hashVal].push_back (loc);
+
+			// otherwise, re-write to the old location
+			} else {
+				aggRec->toBinary (loc);
+			}
 		}
-	}
 
-	// now, we have processed all of the database records... so we can output the aggregates
-	MyDB_RecordIteratorAltPtr myIterAgain = getIteratorAlt (allPages);	
+		// now, we have processed all of the records... so we can output the aggregates
+		MyDB_RecordIteratorAltPtr myIterAgain = getIteratorAlt (allPages);	
 
-	// loop through all of the aggregate records
-	MyDB_RecordPtr outRec = output->getEmptyRecord ();
-	while (myIterAgain->advance ()) {
+		// loop through all of the aggregate records
+		MyDB_RecordPtr outRec = output->getEmptyRecord ();
+		while (myIterAgain->advance ()) {
 
-		myIterAgain->getCurrent (aggRec);
+			// the aggregate pages are pinned
+			myIterAgain->getCurrentView (aggRec);
 
-		// set the grouping atts
-		for (i = 0; i < numGroups; i++) {
-			outRec->getAtt (i)->set (aggRec->getAtt (i));
-		}
+			// set the grouping atts
+			for (i = 0; i < numGroups; i++) {
+				outRec->getAtt (i)->set (aggRec->getAtt (i));
+			}
 
-		// set the aggregate atts
-		for (auto &a : finalAggComps) {
-			outRec->getAtt (i++)->set (a ());
+			// set the aggregate atts
+			for (auto &a : finalAggComps) {
+				outRec->getAtt (i++)->set (a ());
+			}
+			outRec->recordContentHasChanged ();
+			output->append (outRec);
 		}
-		outRec->recordContentHasChanged ();
-		output->append (outRec);
+
+		// if everything fit, we are done; otherwise, go and do the spilled records
+		if (spilled.size () == 0)
+			break;
+		myIter = getIteratorAlt (spilled);
 	}
 }
 
@@ -85,7 +85,7 @@ void AggregateMultiThread :: execThread (int low, int high) {
     }
 
     // and this will verify that each of the groupings match up
-    func checkGroups;
+    function <bool ()> checkGroups;
     string groupCheck;
     i = 0;
 
@@ -101,7 +101,7 @@ void AggregateMultiThread :: execThread (int low, int high) {
         }
         i++;
     }
-    checkGroups = combinedRec->compileComputation (groupCheck);
+    checkGroups = combinedRec->compilePredicate (groupCheck);
 
     // this will compute each of the aggregates for updating the aggregate record
     vector <func> aggComps;
@@ -128,12 +128,12 @@ void AggregateMultiThread :: execThread (int low, int high) {
     aggComps.push_back (combinedRec->compileComputation ("+ ( int[1], [MyDB_CntAtt])"));
 
     // and this runs the selection on the input records
-    func inputPred = inputRec->compileComputation (selectionPredicate);
+    function <bool ()> inputPred = inputRec->compilePredicate (selectionPredicate);
 
 
 
     // at this point, we are ready to go!!
-    MyDB_RecordIteratorPtr myIter = input->getIterator (inputRec);
+    MyDB_RecordIteratorPtr myIter = input->getIterator (inputRec, true);
 
     MyDB_AttValPtr zero = make_shared <MyDB_IntAttVal> ();
     while (myIter->hasNext ()) {
@@ -141,7 +141,7 @@ void AggregateMultiThread :: execThread (int low, int high) {
         myIter->getNext ();
 
         // see if it is accepted by the preicate
-        if (!inputPred ()->toBool ()) {
+        if (!inputPred ()) {
             continue;
         }
 
@@ -161,7 +161,7 @@ void AggregateMultiThread :: execThread (int low, int high) {
             aggRec->fromBinary (v);
 
             // check to see if it matches
-            if (!checkGroups ()->toBool ()) {
+            if (!checkGroups ()) {
                 continue;
             }
 
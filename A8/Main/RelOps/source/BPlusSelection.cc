@@ -3,6 +3,7 @@
 #define BPLUS_SELECTION_C
 
 #include "BPlusSelection.h"
+#include "MyDB_ExprKernel.h"
 
 BPlusSelection :: BPlusSelection (MyDB_BPlusTreeReaderWriterPtr inputIn, MyDB_TableReaderWriterPtr outputIn,
                 MyDB_AttValPtr lowIn, MyDB_AttValPtr highIn,
@@ -20,7 +21,7 @@ void BPlusSelection :: run () {
 	MyDB_RecordPtr outputRec = output->getEmptyRecord();
 
 	// now, get the final predicate over it
-	func finalPredicate = inputRec->compileComputation (selectionPredicate);
+	MyDB_ExprKernel finalPredicate (selectionPredicate, inputRec);
 
 	// and get the final set of computatoins that will be used to buld the output record
 	vector <func> finalComputations;
@@ -28,22 +29,27 @@ void BPlusSelection :: run () {
 		finalComputations.push_back (inputRec->compileComputation (s));
 	}
 
+	// the predicate is run over a batch of the records in the range at a time
 	MyDB_RecordIteratorAltPtr myIter = input->getRangeIteratorAlt(low, high);
-	while(myIter->advance()) {
-		myIter->getCurrent (inputRec);
+	MyDB_RecordBatch batch;
+	vector <int> selected (MYDB_BATCH_SIZE);
+	while(myIter->getBatch (batch) != 0) {
+		size_t numSelected = finalPredicate.select (batch.positions.data (), batch.size (), selected.data ());
 
-		if (!finalPredicate()->toBool()) {
-			continue;
-		}
+		for (size_t k = 0; k < numSelected; k++) {
 
-		// run all of the computations
-		int i = 0;
-		for (auto &f : finalComputations) {
-			outputRec->getAtt (i++)->set (f());
-		}
+			// the record is done with before anything is written, so it can be a view
+			inputRec->viewBinary (batch.get (selected[k]), batch.page);
 
-		outputRec->recordContentHasChanged ();
-		output->append (outputRec);	
+			// run all of the computations
+			int i = 0;
+			for (auto &f : finalComputations) {
+				outputRec->getAtt (i++)->set (f());
+			}
+
+			outputRec->recordContentHasChanged ();
+			output->append (outputRec);	
+		}
 	}
 }
 
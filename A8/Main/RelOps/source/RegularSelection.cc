@@ -2,6 +2,7 @@
 #ifndef REG_SELECTION_C                                        
 #define REG_SELECTION_C
 
+#include "MyDB_ExprKernel.h"
 #include "RegularSelection.h"
 
 RegularSelection :: RegularSelection (MyDB_TableReaderWriterPtr inputIn, MyDB_TableReaderWriterPtr outputIn,
@@ -23,27 +24,33 @@ void RegularSelection :: run () {
 	for (string s : projections) {
 		finalComputations.push_back (inputRec->compileComputation (s));
 	}
-	func pred = inputRec->compileComputation (selectionPredicate);
+	MyDB_ExprKernel pred (selectionPredicate, inputRec);
 
-	// now, iterate through the B+-tree query results
-	MyDB_RecordIteratorAltPtr myIter = input->getIteratorAlt ();
-	while (myIter->advance ()) {
+	// now, iterate through the input a batch at a time; this is a one-time scan, so don't
+	// let it flush the buffer
+	MyDB_RecordIteratorAltPtr myIter = input->getIteratorAlt (true);
+	MyDB_RecordBatch batch;
+	vector <int> selected (MYDB_BATCH_SIZE);
+	while (myIter->getBatch (batch) != 0) {
 
-		myIter->getCurrent (inputRec);
+		// run the predicate over the whole batch
+		size_t numSelected = pred.select (batch.positions.data (), batch.size (), selected.data ());
 
-		// see if it is accepted by the predicate
-		if (!pred()->toBool ()) {
-			continue;
-		}
+		// and the projections over the records that it accepted
+		for (size_t k = 0; k < numSelected; k++) {
 
-		// execute all of the computations
-		int i = 0;
-		for (auto &f : finalComputations) {
-			outputRec->getAtt (i++)->set (f());
-		}
+			// the record is done with before anything is written, so it can be a view
+			inputRec->viewBinary (batch.get (selected[k]), batch.page);
 
-		outputRec->recordContentHasChanged ();
-		output->append (outputRec);
+			// execute all of the computations
+			int i = 0;
+			for (auto &f : finalComputations) {
+				outputRec->getAtt (i++)->set (f());
+			}
+
+			outputRec->recordContentHasChanged ();
+			output->append (outputRec);
+		}
 	}
 }
 
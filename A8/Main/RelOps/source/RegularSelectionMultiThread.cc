@@ -41,17 +41,18 @@ void RegularSelectionMultiThread :: execThread(int low, int high) {
     for (string s : projections) {
         finalComputations.push_back (inputRec->compileComputation (s));
     }
-    func pred = inputRec->compileComputation (selectionPredicate);
+    function <bool ()> pred = inputRec->compilePredicate (selectionPredicate);
 
     // now, iterate through the B+-tree query results
 //    MyDB_RecordIteratorAltPtr myIter = input->getIteratorAlt ();
-    MyDB_RecordIteratorAltPtr myIter = input->getIteratorAlt (low, high);
+    MyDB_RecordIteratorAltPtr myIter = input->getIteratorAlt (low, high, true);
     while (myIter->advance ()) {
 
-        myIter->getCurrent (inputRec);
+        // the record is done with before anything is written, so it can be a view
+        myIter->getCurrentView (inputRec);
 
         // see if it is accepted by the predicate
-        if (!pred()->toBool ()) {
+        if (!pred ()) {
             continue;
         }
 
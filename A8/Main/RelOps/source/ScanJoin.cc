@@ -2,8 +2,10 @@
 #ifndef SCAN_JOIN_C
 #define SCAN_JOIN_C
 
+#include "MyDB_ExprKernel.h"
 #include "MyDB_Record.h"
 #include "MyDB_PageReaderWriter.h"
+#include "MyDB_Reservation.h"
 #include "MyDB_TableReaderWriter.h"
 #include "ScanJoin.h"
 #include <unordered_map>
@@ -51,19 +53,6 @@ ScanJoin :: ScanJoin (MyDB_TableReaderWriterPtr leftInputIn, MyDB_TableReaderWri
 
 void ScanJoin :: run () {
 
-	// this is the hash map we'll use to look up data... the key is the hashed value
-	// of all of the records' join keys, and the value is a list of pointers were all
-	// of the records with that hsah value are located
-	unordered_map <size_t, vector <void *>> myHash;
-
-	// get all of the pages
-	vector <MyDB_PageReaderWriter> allData;
-	for (int i = 0; i < leftTable->getNumPages (); i++) {
-		MyDB_PageReaderWriter temp = leftTable->getPinned (i);
-		if (temp.getType () == MyDB_PageType :: RegularPage)
-			allData.push_back (leftTable->getPinned (i));
-	}
-	
 	// get the left input record 
 	MyDB_RecordPtr leftInputRec = leftTable->getEmptyRecord ();
 
@@ -74,33 +63,8 @@ void ScanJoin :: run () {
 	}
 
 	// now get the predicate
-	func leftPred = leftInputRec->compileComputation (leftSelectionPredicate);
-
-	// add all of the records to the hash table
-	MyDB_RecordIteratorAltPtr myIter = getIteratorAlt (allData);
-
-	while (myIter->advance ()) {
-
-		// hash the current record
-		myIter->getCurrent (leftInputRec);
+	function <bool ()> leftPred = leftInputRec->compilePredicate (leftSelectionPredicate);
 
-		// see if it is accepted by the preicate
-		if (!leftPred ()->toBool ()) {
-			continue;
-		}
-
-		// compute its hash
-		size_t hashVal = 0;
-		for (auto &f : leftEqualities) {
-			hashVal ^= f ()->hash ();
-		}
-
-		// see if it is in the hash table
-		myHash [hashVal].push_back (myIter->getCurrentPointer ());
-	}
-
-	// and now we iterate through the other table
-	
 	// get the right input record, and get the various functions over it
 	MyDB_RecordPtr rightInputRec = rightTable->getEmptyRecord ();
 	vector <func> rightEqualities;
@@ -109,7 +73,7 @@ void ScanJoin :: run () {
 	}
 
 	// now get the predicate
-	func rightPred = rightInputRec->compileComputation (rightSelectionPredicate);
+	MyDB_ExprKernel rightPred (rightSelectionPredicate, rightInputRec);
 
 	// and get the schema that results from combining the left and right records
 	MyDB_SchemaPtr mySchemaOut = make_shared <MyDB_Schema> ();
@@ -123,7 +87,7 @@ void ScanJoin :: run () {
 	combinedRec->buildFrom (leftInputRec, rightInputRec);
 
 	// now, get the final predicate over it
-	func finalPredicate = combinedRec->compileComputation (finalSelectionPredicate);
+	function <bool ()> finalPredicate = combinedRec->compilePredicate (finalSelectionPredicate);
 
 	// and get the final set of computatoins that will be used to buld the output record
 	vector <func> finalComputations;
@@ -133,55 +97,116 @@ void ScanJoin :: run () {
 
 	// this is the output record
 	MyDB_RecordPtr outputRec = output->getEmptyRecord ();
-	
-	// now, iterate through the right table
-	MyDB_RecordIteratorPtr myIterAgain = rightTable->getIterator (rightInputRec);
-	while (myIterAgain->hasNext ()) {
 
-		myIterAgain->getNext ();
-
-		// see if it is accepted by the preicate
-		if (!rightPred ()->toBool ()) {
-			continue;
+	// the left table is pinned and hashed a chunk at a time, where a chunk is as many
+	// pages as we could reserve frames for, and the right table is scanned once for
+	// each chunk; usually, the whole left table fits, so there is just one chunk.  If
+	// the buffer is tiny (or other operators hold most of it), the chunk can be a single
+	// page, and then the right table is scanned once for every page of the left table,
+	// which is a block nested loops join; SortMergeJoin is the better choice when the
+	// left table is much bigger than the buffer
+	int numLeftPages = leftTable->getNumPages ();
+	MyDB_Reservation frames (leftTable->getBufferMgr (), numLeftPages);
+	int chunkSize = frames.size ();
+	for (int low = 0; low < numLeftPages; low += chunkSize) {
+
+		// this is the hash map we'll use to look up data... the key is the hashed value
+		// of all of the records' join keys, and the value is a list of pointers were all
+		// of the records with that hsah value are located
+		unordered_map <size_t, vector <void *>> myHash;
+
+		// get all of the pages in the chunk
+		vector <MyDB_PageReaderWriter> allData;
+		for (int i = low; i < low + chunkSize && i < numLeftPages; i++) {
+			MyDB_PageReaderWriter temp = leftTable->getPinned (i);
+			if (temp.getType () == MyDB_PageType :: RegularPage)
+				allData.push_back (leftTable->getPinned (i));
 		}
 
-		// hash the current record
-		size_t hashVal = 0;
-		for (auto &f : rightEqualities) {
-			hashVal ^= f ()->hash ();
-		}
+		// add all of the records to the hash table
+		MyDB_RecordIteratorAltPtr myIter = getIteratorAlt (allData);
+
+		while (myIter->advance ()) {
 
-		// get the list of potential matches... first verify that there IS
-		// a match in there
-		if (myHash.count (hashVal) == 0) {
-			continue;
+			// hash the current record; the pages are pinned, so it can be a view
+			myIter->getCurrentView (leftInputRec);
+
+			// see if it is accepted by the preicate
+			if (!leftPred ()) {
+				continue;
+			}
+
+			// compute its hash
+			size_t hashVal = 0;
+			for (auto &f : leftEqualities) {
+				hashVal ^= f ()->hash ();
+			}
+
+			// see if it is in the hash table
+			myHash [hashVal].push_back (myIter->getCurrentPointer ());
 		}
 
-		// if there is a match, then get the list of matches
-		vector <void *> &potentialMatches = myHash [hashVal];
-		
-		// and iterate though the potential matches, checking each of them
-		for (auto &v : potentialMatches) {
+		// now, iterate through the right table a batch at a time, running its predicate over
+		// each batch; this is a one-time scan, so don't let it flush the buffer
+		MyDB_RecordIteratorAltPtr myIterAgain = rightTable->getIteratorAlt (true);
+		MyDB_RecordBatch batch;
+		vector <int> selected (MYDB_BATCH_SIZE);
+		size_t numSelected = 0, next = 0;
+		while (true) {
+
+			// get the next record that the predicate accepted
+			if (next == numSelected) {
+				if (myIterAgain->getBatch (batch) == 0)
+					break;
+				numSelected = rightPred.select (batch.positions.data (), batch.size (), selected.data ());
+				next = 0;
+				continue;
+			}
 
-			// build the combined record
-			leftInputRec->fromBinary (v);
+			// most records do not match, so each is just viewed on its page
+			rightInputRec->viewBinary (batch.get (selected[next++]), batch.page);
 
-			// check to see if it is accepted by the join predicate
-			if (finalPredicate ()->toBool ()) {
+			// hash the current record
+			size_t hashVal = 0;
+			for (auto &f : rightEqualities) {
+				hashVal ^= f ()->hash ();
+			}
 
-				// execute all of the computations
-				int i = 0;
-				for (auto &f : finalComputations) {
-					outputRec->getAtt (i++)->set (f());
-				}
+			// get the list of potential matches... first verify that there IS
+			// a match in there
+			if (myHash.count (hashVal) == 0) {
+				continue;
+			}
 
-				// the record's content has changed because it 
-				// is now a composite of two records whose content
-				// has changed via a read... we have to tell it this,
-				// or else the record's internal buffer may cause it
-				// to write old values
-				outputRec->recordContentHasChanged ();
-				output->append (outputRec);	
+			// if there is a match, then get the list of matches
+			vector <void *> &potentialMatches = myHash [hashVal];
+
+			// writing the output could evict the right record's page, so copy it
+			rightInputRec->materialize ();
+		
+			// and iterate though the potential matches, checking each of them
+			for (auto &v : potentialMatches) {
+
+				// build the combined record; the left pages are pinned
+				leftInputRec->viewBinary (v);
+
+				// check to see if it is accepted by the join predicate
+				if (finalPredicate ()) {
+
+					// execute all of the computations
+					int i = 0;
+					for (auto &f : finalComputations) {
+						outputRec->getAtt (i++)->set (f());
+					}
+
+					// the record's content has changed because it 
+					// is now a composite of two records whose content
+					// has changed via a read... we have to tell it this,
+					// or else the record's internal buffer may cause it
+					// to write old values
+					outputRec->recordContentHasChanged ();
+					output->append (outputRec);	
+				}
 			}
 		}
 	}
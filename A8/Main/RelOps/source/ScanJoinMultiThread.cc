@@ -78,7 +78,7 @@ void ScanJoinMultiThread :: run () {
     }
 
     // now get the predicate
-    func leftPred = leftInputRec->compileComputation (leftSelectionPredicate);
+    function <bool ()> leftPred = leftInputRec->compilePredicate (leftSelectionPredicate);
 
     // add all of the records to the hash table
     MyDB_RecordIteratorAltPtr myIter = getIteratorAlt (allData);
@@ -89,7 +89,7 @@ void ScanJoinMultiThread :: run () {
         myIter->getCurrent (leftInputRec);
 
         // see if it is accepted by the preicate
-        if (!leftPred ()->toBool ()) {
+        if (!leftPred ()) {
             continue;
         }
 
@@ -128,7 +128,7 @@ void ScanJoinMultiThread :: execThread (int low, int high, unordered_map<size_t,
     }
 
     // now get the predicate
-    func rightPred = rightInputRec->compileComputation (rightSelectionPredicate);
+    function <bool ()> rightPred = rightInputRec->compilePredicate (rightSelectionPredicate);
 
     // and get the schema that results from combining the left and right records
     MyDB_SchemaPtr mySchemaOut = make_shared <MyDB_Schema> ();
@@ -142,7 +142,7 @@ void ScanJoinMultiThread :: execThread (int low, int high, unordered_map<size_t,
     combinedRec->buildFrom (leftInputRec, rightInputRec);
 
     // now, get the final predicate over it
-    func finalPredicate = combinedRec->compileComputation (finalSelectionPredicate);
+    function <bool ()> finalPredicate = combinedRec->compilePredicate (finalSelectionPredicate);
 
     // and get the final set of computatoins that will be used to buld the output record
     vector <func> finalComputations;
@@ -155,16 +155,17 @@ void ScanJoinMultiThread :: execThread (int low, int high, unordered_map<size_t,
 
     // now, iterate through the right table
 //    MyDB_RecordIteratorPtr myIterAgain = rightTable->getIterator (rightInputRec);
-    MyDB_RecordIteratorAltPtr myIterAgain = rightTable->getIteratorAlt (low, high);
+    MyDB_RecordIteratorAltPtr myIterAgain = rightTable->getIteratorAlt (low, high, true);
 //    while (myIterAgain->hasNext ()) {
 //
 //        myIterAgain->getNext ();
     while (myIterAgain->advance()) {
 
-        myIterAgain->getCurrent(rightInputRec);
+        // most records do not match, so each is just viewed on its page
+        myIterAgain->getCurrentView (rightInputRec);
 
         // see if it is accepted by the preicate
-        if (!rightPred ()->toBool ()) {
+        if (!rightPred ()) {
             continue;
         }
 
@@ -183,6 +184,9 @@ void ScanJoinMultiThread :: execThread (int low, int high, unordered_map<size_t,
         // if there is a match, then get the list of matches
         vector <void *> &potentialMatches = myHash [hashVal];
 
+        // writing the output could evict the right record's page, so copy it
+        rightInputRec->materialize ();
+
         // and iterate though the potential matches, checking each of them
         for (auto &v : potentialMatches) {
 
@@ -190,7 +194,7 @@ void ScanJoinMultiThread :: execThread (int low, int high, unordered_map<size_t,
             leftInputRec->fromBinary (v);
 
             // check to see if it is accepted by the join predicate
-            if (finalPredicate ()->toBool ()) {
+            if (finalPredicate ()) {
 
                 // execute all of the computations
                 int i = 0;
@@ -8,6 +8,7 @@
 #include "../../Record/headers/MyDB_Record.h"
 #include "../../DatabaseTable/headers/MyDB_PageReaderWriter.h"
 #include "../../DatabaseTable/headers/MyDB_TableReaderWriter.h"
+#include "../../BufferMgr/headers/MyDB_Reservation.h"
 #include "../headers/SortMergeJoin.h"
 #include "../../DatabaseTable/headers/Sorting.h"
 #include <iostream>
@@ -32,7 +33,9 @@ SortMergeJoin::SortMergeJoin(MyDB_TableReaderWriterPtr leftInputIn, MyDB_TableRe
 
 void SortMergeJoin::run() {
 
-    int runSize = int(leftTable->getBufferMgr()->numPages / 2); //?
+    // the runs are sorted in as many frames as we can reserve, up to half of the buffer
+    MyDB_Reservation frames(leftTable->getBufferMgr(), leftTable->getBufferMgr()->getNumPages() / 2);
+    int runSize = int(frames.size());
 
     MyDB_RecordPtr temp = leftTable->getEmptyRecord();
     MyDB_RecordPtr temp2 = leftTable->getEmptyRecord();
@@ -58,7 +61,7 @@ void SortMergeJoin::run() {
     combinedRec->buildFrom(temp, temp_);
 
     // now, get the final predicate over it
-    func finalPredicate = combinedRec->compileComputation(finalSelectionPredicate);
+    function<bool()> finalPredicate = combinedRec->compilePredicate(finalSelectionPredicate);
 
     // and get the final set of computatoins that will be used to buld the output record
     vector<func> finalComputations;
@@ -70,9 +73,9 @@ void SortMergeJoin::run() {
     MyDB_RecordPtr outputRec = output->getEmptyRecord();
 
     // compare funcs
-    func left = combinedRec->compileComputation(" < (" + equalityCheck.first + ", " + equalityCheck.second + ")");
-    func right = combinedRec->compileComputation(" > (" + equalityCheck.first + ", " + equalityCheck.second + ")");
-    func equal = combinedRec->compileComputation(" == (" + equalityCheck.first + ", " + equalityCheck.second + ")");
+    function<bool()> left = combinedRec->compilePredicate(" < (" + equalityCheck.first + ", " + equalityCheck.second + ")");
+    function<bool()> right = combinedRec->compilePredicate(" > (" + equalityCheck.first + ", " + equalityCheck.second + ")");
+    function<bool()> equal = combinedRec->compilePredicate(" == (" + equalityCheck.first + ", " + equalityCheck.second + ")");
 
     //do the merge
     vector<MyDB_PageReaderWriter> leftContainer;
@@ -88,13 +91,13 @@ void SortMergeJoin::run() {
             bool flag = false;
             left_iter->getCurrent(temp);
             right_iter->getCurrent(temp_);
-            if (left()->toBool()) {
+            if (left()) {
                 if (!left_iter->advance())
                     flag = true;
-            } else if (right()->toBool()) {
+            } else if (right()) {
                 if (!right_iter->advance())
                     flag = true;
-            } else if (equal()->toBool()) {
+            } else if (equal()) {
                 // add current LHS, RHS
                 leftPage.clear();
                 rightPage.clear();
@@ -124,7 +127,7 @@ void SortMergeJoin::run() {
                 //find all equalities in right
                 while (true) {
                     right_iter->getCurrent(temp_);  // use temp_ to maintain the equality with temp, instead of temp2_!!!
-                    if (equal()->toBool()) {
+                    if (equal()) {
                         if (!rightPage.append(temp_)) {
                             MyDB_PageReaderWriter newPage(true, *(rightTable->getBufferMgr()));
                             rightPage = newPage;
@@ -156,7 +159,7 @@ void SortMergeJoin::run() {
                     while (myIterRight->advance()) {
                         myIterRight->getCurrent(temp_);
                         // check final predicate
-                        if (finalPredicate()->toBool()) {
+                        if (finalPredicate()) {
                             int i = 0;
                             for (auto &f : finalComputations) {
                                 outputRec->getAtt(i++)->set(f());
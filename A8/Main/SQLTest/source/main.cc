@@ -20,8 +20,8 @@ string toLower (string data) {
 int main (int numArgs, char **args) {
 
 	// make sure we have the correct arguments
-	if (numArgs != 3) {
-		cout << "args: catalog_file directory_for_tables\n";
+	if (numArgs != 3 && !(numArgs == 4 && string (args[3]) == "preload")) {
+		cout << "args: catalog_file directory_for_tables [preload]\n";
 		return 0;
 	}
 
@@ -50,6 +50,12 @@ int main (int numArgs, char **args) {
 		}
 	}
 
+	// remember the pages that are hot when we shut down; if asked to, warm up the buffer
+	// in the background with the pages that were hot the last time that we ran
+	myMgr->setManifest (string (args[2]) + "/bufferManifest");
+	if (numArgs == 4)
+		myMgr->startPreload (allTables);
+
 	// print out the intro notification
 	cout << "\n          Welcome to MyDB v0.1\n\n";
 	cout << "\"Not the worst database in the world\" (tm) \n\n";
@@ -89,6 +95,12 @@ int main (int numArgs, char **args) {
 					return 0;
 				}
 
+				// see if we got a "stats", in which case we dump the buffer manager's statistics
+				if (tokens.size () == 1 && toLower (tokens[0]) == "stats") {
+					cout << myMgr->getStatsJSON () << "\n";
+					break;
+				}
+
 				// see if we got a "load soandso from afile"
 				if (tokens.size () == 4 && toLower(tokens[0]) == "load" && toLower(tokens[2]) == "from") {
 